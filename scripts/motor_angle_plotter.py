@@ -2,18 +2,19 @@ import requests
 import time
 import matplotlib.pyplot as plt
 
-reqUrl = "http://192.168.0.124/motor/get"
+reqUrl = "http://192.168.0.124/history"
 
 headersList = {
     "Accept": "*/*",
     "User-Agent": "Thunder Client (https://www.thunderclient.com)",
-    "X-User-Role": "user",
-    "Motor-Number": "1"
+    "X-User-Role": "user"
 }
 
 payload = ""
 duration = 120  # Set the duration for sending requests (in seconds)
-interval = 0.5  # Set the interval between requests (in seconds)
+interval = 5  # Set the interval between requests (in seconds)
+motor_number = 1  # Motor whose angle is plotted
+cursor = {}  # Record indices to continue from, the "next" member of the last response
 
 timestamps = []
 angles = []
@@ -26,21 +27,23 @@ plt.close('all')
 plt.ion()  # Enable interactive mode for real-time plotting
 
 while time.time() < end_time:
-    response = requests.get(reqUrl, headers=headersList)
+    # One request returns every angle recorded since the previous one
+    response = requests.get(reqUrl, headers=headersList, params=cursor)
     data = response.json()
+    cursor = data.get("next", cursor)
 
-    # Extract angle from the response
-    angle = data.get("motor_angle")
-    if angle is not None:
-        timestamp = time.time() - start_time
-        timestamps.append(timestamp)
-        angles.append(angle)
+    # Extract the angles of the motor from the response
+    for timestamp_ms, motor, angle in data.get("motors", []):
+        if motor == motor_number:
+            timestamps.append(timestamp_ms / 1000.0)
+            angles.append(angle)
 
+    if angles:
         # Plot the moving graph
         plt.clf()  # Clear previous plot
         plt.plot(timestamps, angles)
         plt.grid()
-        plt.xlabel("Time (seconds)")
+        plt.xlabel("Device time (seconds)")
         plt.ylabel("Motor Angle")
         plt.title("Motor Angle vs. Time")
         plt.draw()
@@ -51,7 +54,7 @@ while time.time() < end_time:
 # Plot the final graph
 plt.ioff()  # Disable interactive mode
 plt.plot(timestamps, angles)
-plt.xlabel("Time (seconds)")
+plt.xlabel("Device time (seconds)")
 plt.ylabel("Motor Angle")
 plt.title("Motor Angle vs. Time")
 plt.grid()
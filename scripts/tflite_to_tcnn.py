@@ -0,0 +1,297 @@
+"""Converts an int8 TensorFlow Lite classifier to the TCNN format of the device.
+
+The model must be a single chain of CONV_2D, DEPTHWISE_CONV_2D (depth multiplier 1),
+AVERAGE_POOL_2D, MAX_POOL_2D, MEAN over height and width, and FULLY_CONNECTED
+operators, fully quantized to int8 (for example with the TFLiteConverter and a
+representative dataset). RESHAPE and SQUEEZE are dropped, as are QUANTIZE at the
+input and SOFTMAX / DEQUANTIZE at the output: the device applies the softmax itself.
+
+The layout is described in src/device/main/src/tiny_cnn/tiny_cnn.h. Save the result
+as src/device/main/model/classifier.tcnn to build it into the firmware.
+
+Usage:
+    pip install tflite numpy
+    python tflite_to_tcnn.py model.tflite classifier.tcnn [--pixel-scale S] [--pixel-offset O]
+
+--pixel-scale and --pixel-offset give the float input the model expects for a pixel
+value p in 0-255: p * S + O. The default, 1/255 and 0, is for models trained on
+images in [0, 1]. Use 1 and 0 when the model starts with its own rescaling layer.
+"""
+
+import argparse
+import math
+import struct
+import sys
+
+import numpy as np
+import tflite
+
+MAGIC = b'TCNN'
+VERSION = 1
+MAX_LAYERS = 32
+
+CONV2D = 1
+DEPTHWISE_CONV2D = 2
+AVG_POOL = 3
+MAX_POOL = 4
+GLOBAL_AVG_POOL = 5
+FULLY_CONNECTED = 6
+
+PADDING_VALID = 0
+PADDING_SAME = 1
+
+HEADER_FORMAT = '<4sHHHHHHififff'
+LAYER_FORMAT = '<BBBBB3xHHHHiihhI'
+
+# Operators that do not change the int8 values
+PASS_THROUGH = {
+    tflite.BuiltinOperator.RESHAPE,
+    tflite.BuiltinOperator.SQUEEZE,
+    tflite.BuiltinOperator.QUANTIZE,
+    tflite.BuiltinOperator.DEQUANTIZE,
+    tflite.BuiltinOperator.SOFTMAX,
+}
+
+
+class Converter:
+    def __init__(self, model):
+        self.model = model
+        self.graph = model.Subgraphs(0)
+        # Tensor each dropped operator output stands for
+        self.alias = {}
+
+    def opcode(self, op):
+        code = self.model.OperatorCodes(op.OpcodeIndex())
+        return max(code.BuiltinCode(), code.DeprecatedBuiltinCode())
+
+    def tensor(self, index):
+        return self.graph.Tensors(index)
+
+    def resolve(self, index):
+        while index in self.alias:
+            index = self.alias[index]
+        return index
+
+    def shape(self, index):
+        return [int(v) for v in self.tensor(index).ShapeAsNumpy()]
+
+    def quantization(self, index):
+        quant = self.tensor(index).Quantization()
+        if quant is None or quant.ScaleLength() == 0:
+            sys.exit('tensor %s is not quantized' % self.tensor(index).Name().decode())
+        return quant.ScaleAsNumpy().astype(np.float64), quant.ZeroPointAsNumpy().astype(np.int64)
+
+    def scale_zero_point(self, index):
+        scale, zero_point = self.quantization(index)
+        return float(scale[0]), int(zero_point[0])
+
+    def data(self, index, dtype):
+        tensor = self.tensor(index)
+        raw = self.model.Buffers(tensor.Buffer()).DataAsNumpy()
+        return np.frombuffer(raw.tobytes(), dtype=dtype).reshape(self.shape(index))
+
+    def options(self, op, cls):
+        table = op.BuiltinOptions()
+        options = cls()
+        options.Init(table.Bytes, table.Pos)
+        return options
+
+
+def quantize_multiplier(value):
+    """Q31 multiplier and power of two shift of a positive real, as TensorFlow Lite."""
+    if value == 0.0:
+        return 0, 0
+    mantissa, shift = math.frexp(value)
+    multiplier = int(round(mantissa * (1 << 31)))
+    if multiplier == 1 << 31:
+        multiplier //= 2
+        shift += 1
+    if shift < -31:
+        return 0, 0
+    return multiplier, shift
+
+
+def activation_range(activation, scale, zero_point):
+    def quantize(value):
+        return zero_point + int(round(value / scale))
+
+    low, high = -128, 127
+    if activation == tflite.ActivationFunctionType.RELU:
+        low = max(low, quantize(0.0))
+    elif activation == tflite.ActivationFunctionType.RELU6:
+        low, high = max(low, quantize(0.0)), min(high, quantize(6.0))
+    elif activation == tflite.ActivationFunctionType.RELU_N1_TO_1:
+        low, high = max(low, quantize(-1.0)), min(high, quantize(1.0))
+    elif activation != tflite.ActivationFunctionType.NONE:
+        sys.exit('unsupported fused activation %d' % activation)
+    return low, high
+
+
+def padding(value):
+    return PADDING_SAME if value == tflite.Padding.SAME else PADDING_VALID
+
+
+def parameters(weights, bias, multipliers, shifts):
+    data = weights.astype(np.int8).tobytes()
+    data += b'\0' * (-len(data) % 4)
+    data += np.asarray(bias, dtype='<i4').tobytes()
+    data += np.asarray(multipliers, dtype='<i4').tobytes()
+    data += np.asarray(shifts, dtype='<i4').tobytes()
+    return data
+
+
+def channel_multipliers(converter, op, weight_index, channels):
+    in_scale, _ = converter.scale_zero_point(op.Inputs(0))
+    out_scale, _ = converter.scale_zero_point(op.Outputs(0))
+    weight_scale, _ = converter.quantization(weight_index)
+    weight_scale = np.broadcast_to(weight_scale, (channels,))
+
+    pairs = [quantize_multiplier(in_scale * s / out_scale) for s in weight_scale]
+    return [m for m, _ in pairs], [s for _, s in pairs]
+
+
+def bias_values(converter, op, channels):
+    if op.InputsLength() < 3 or op.Inputs(2) < 0:
+        return np.zeros(channels, dtype=np.int32)
+    return converter.data(op.Inputs(2), np.int32).reshape(channels)
+
+
+def convert_layer(converter, op, code):
+    """TCNN layer record fields and payload of one operator."""
+    out_shape = converter.shape(op.Outputs(0))
+    in_shape = converter.shape(op.Inputs(0))
+    _, in_zero_point = converter.scale_zero_point(op.Inputs(0))
+    out_scale, out_zero_point = converter.scale_zero_point(op.Outputs(0))
+    kernel = (0, 0)
+    stride = 0
+    pad = PADDING_VALID
+    activation = tflite.ActivationFunctionType.NONE
+
+    if code == tflite.BuiltinOperator.CONV_2D:
+        options = converter.options(op, tflite.Conv2DOptions)
+        if options.DilationHFactor() != 1 or options.DilationWFactor() != 1 or options.StrideH() != options.StrideW():
+            sys.exit('CONV_2D needs equal strides and no dilation')
+        weights = converter.data(op.Inputs(1), np.int8)
+        channels = weights.shape[0]
+        kernel = weights.shape[1:3]
+        stride, pad, activation = options.StrideW(), padding(options.Padding()), options.FusedActivationFunction()
+        multipliers, shifts = channel_multipliers(converter, op, op.Inputs(1), channels)
+        layer_type = CONV2D
+        payload = parameters(weights, bias_values(converter, op, channels), multipliers, shifts)
+
+    elif code == tflite.BuiltinOperator.DEPTHWISE_CONV_2D:
+        options = converter.options(op, tflite.DepthwiseConv2DOptions)
+        if options.DilationHFactor() != 1 or options.DilationWFactor() != 1 or options.StrideH() != options.StrideW():
+            sys.exit('DEPTHWISE_CONV_2D needs equal strides and no dilation')
+        weights = converter.data(op.Inputs(1), np.int8)
+        channels = weights.shape[3]
+        if channels != in_shape[3]:
+            sys.exit('DEPTHWISE_CONV_2D needs a depth multiplier of 1')
+        kernel = weights.shape[1:3]
+        stride, pad, activation = options.StrideW(), padding(options.Padding()), options.FusedActivationFunction()
+        multipliers, shifts = channel_multipliers(converter, op, op.Inputs(1), channels)
+        layer_type = DEPTHWISE_CONV2D
+        payload = parameters(weights, bias_values(converter, op, channels), multipliers, shifts)
+
+    elif code in (tflite.BuiltinOperator.AVERAGE_POOL_2D, tflite.BuiltinOperator.MAX_POOL_2D):
+        options = converter.options(op, tflite.Pool2DOptions)
+        if options.StrideH() != options.StrideW():
+            sys.exit('pools need equal strides')
+        if converter.scale_zero_point(op.Inputs(0)) != (out_scale, out_zero_point):
+            sys.exit('pools need the same input and output quantization')
+        kernel = (options.FilterHeight(), options.FilterWidth())
+        stride, pad, activation = options.StrideW(), padding(options.Padding()), options.FusedActivationFunction()
+        layer_type = AVG_POOL if code == tflite.BuiltinOperator.AVERAGE_POOL_2D else MAX_POOL
+        payload = b''
+
+    elif code == tflite.BuiltinOperator.MEAN:
+        axes = sorted(int(a) for a in converter.data(op.Inputs(1), np.int32).flatten())
+        if axes != [1, 2]:
+            sys.exit('MEAN is only supported over height and width')
+        channels = in_shape[3]
+        in_scale, _ = converter.scale_zero_point(op.Inputs(0))
+        multiplier, shift = quantize_multiplier(in_scale / (in_shape[1] * in_shape[2] * out_scale))
+        layer_type = GLOBAL_AVG_POOL
+        payload = parameters(np.zeros(0), np.zeros(channels), [multiplier] * channels, [shift] * channels)
+        out_shape = [1, 1, 1, channels]
+
+    elif code == tflite.BuiltinOperator.FULLY_CONNECTED:
+        options = converter.options(op, tflite.FullyConnectedOptions)
+        weights = converter.data(op.Inputs(1), np.int8)
+        channels = weights.shape[0]
+        activation = options.FusedActivationFunction()
+        multipliers, shifts = channel_multipliers(converter, op, op.Inputs(1), channels)
+        layer_type = FULLY_CONNECTED
+        payload = parameters(weights, bias_values(converter, op, channels), multipliers, shifts)
+        out_shape = [1, 1, 1, channels]
+
+    else:
+        sys.exit('unsupported operator %d' % code)
+
+    low, high = activation_range(activation, out_scale, out_zero_point)
+    record = struct.pack(LAYER_FORMAT, layer_type, kernel[0], kernel[1], stride, pad,
+                         out_shape[1], out_shape[2], out_shape[3], 0,
+                         in_zero_point, out_zero_point, low, high, len(payload))
+    return record + payload
+
+
+def convert(buffer, pixel_scale, pixel_offset):
+    model = tflite.Model.GetRootAsModel(buffer, 0)
+    converter = Converter(model)
+    graph = converter.graph
+
+    layers = []
+    first_input = None
+    last_output = None
+
+    for i in range(graph.OperatorsLength()):
+        op = graph.Operators(i)
+        code = converter.opcode(op)
+
+        if code in PASS_THROUGH:
+            converter.alias[op.Outputs(0)] = op.Inputs(0)
+            continue
+
+        source = converter.resolve(op.Inputs(0))
+        if last_output is not None and source != last_output:
+            sys.exit('the model is not a single chain of operators')
+
+        if first_input is None:
+            first_input = op.Inputs(0)
+        last_output = op.Outputs(0)
+        layers.append(convert_layer(converter, op, code))
+
+    if not layers or len(layers) > MAX_LAYERS:
+        sys.exit('the model has %d layers, 1 to %d are supported' % (len(layers), MAX_LAYERS))
+
+    _, height, width, channels = converter.shape(first_input)
+    classes = int(np.prod(converter.shape(last_output)[1:]))
+    in_scale, in_zero_point = converter.scale_zero_point(first_input)
+    out_scale, out_zero_point = converter.scale_zero_point(last_output)
+
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(layers), height, width, channels, classes,
+                         in_zero_point, in_scale, out_zero_point, out_scale, pixel_scale, pixel_offset)
+    return header + b''.join(layers), (height, width, channels, classes, len(layers))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert an int8 TensorFlow Lite model to TCNN.')
+    parser.add_argument('tflite', help='input .tflite model')
+    parser.add_argument('output', help='output .tcnn model')
+    parser.add_argument('--pixel-scale', type=float, default=1.0 / 255.0)
+    parser.add_argument('--pixel-offset', type=float, default=0.0)
+    args = parser.parse_args()
+
+    with open(args.tflite, 'rb') as file:
+        buffer = file.read()
+
+    data, (height, width, channels, classes, count) = convert(buffer, args.pixel_scale, args.pixel_offset)
+    with open(args.output, 'wb') as file:
+        file.write(data)
+
+    print('%s: %dx%dx%d input, %d classes, %d layers, %d bytes'
+          % (args.output, width, height, channels, classes, count, len(data)))
+
+
+if __name__ == '__main__':
+    main()
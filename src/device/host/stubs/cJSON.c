@@ -0,0 +1,640 @@
+/*******************************************************************************
+ * @file        cJSON.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Implementation of the cJSON stand-in: item tree, parser and printer.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <limits.h>
+
+#include "cJSON.h"
+
+/*************************** Items ********************************************/
+
+static cJSON *new_item(int type)
+{
+    cJSON *item = calloc(1, sizeof(*item));
+    if (item != NULL) {
+        item->type = type;
+    }
+    return item;
+}
+
+cJSON *cJSON_CreateObject(void)
+{
+    return new_item(cJSON_Object);
+}
+
+cJSON *cJSON_CreateArray(void)
+{
+    return new_item(cJSON_Array);
+}
+
+cJSON *cJSON_CreateNumber(double num)
+{
+    cJSON *item = new_item(cJSON_Number);
+    if (item != NULL) {
+        item->valuedouble = num;
+        // Saturated like cJSON
+        item->valueint = num >= INT_MAX ? INT_MAX : num <= (double)INT_MIN ? INT_MIN : (int)num;
+    }
+    return item;
+}
+
+cJSON *cJSON_CreateString(const char *string)
+{
+    cJSON *item = new_item(cJSON_String);
+    if (item != NULL) {
+        item->valuestring = strdup(string);
+        if (item->valuestring == NULL) {
+            free(item);
+            return NULL;
+        }
+    }
+    return item;
+}
+
+cJSON *cJSON_CreateBool(cJSON_bool boolean)
+{
+    return new_item(boolean ? cJSON_True : cJSON_False);
+}
+
+void cJSON_Delete(cJSON *item)
+{
+    while (item != NULL) {
+        cJSON *next = item->next;
+        cJSON_Delete(item->child);
+        free(item->valuestring);
+        free(item->string);
+        free(item);
+        item = next;
+    }
+}
+
+cJSON_bool cJSON_AddItemToArray(cJSON *array, cJSON *item)
+{
+    if (array == NULL || item == NULL) {
+        return 0;
+    }
+
+    // As in cJSON, the first child's prev points to the last one
+    if (array->child == NULL) {
+        array->child = item;
+        item->prev = item;
+    } else {
+        cJSON *last = array->child->prev;
+        last->next = item;
+        item->prev = last;
+        array->child->prev = item;
+    }
+    item->next = NULL;
+    return 1;
+}
+
+cJSON_bool cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
+{
+    if (object == NULL || string == NULL || item == NULL) {
+        return 0;
+    }
+    char *name = strdup(string);
+    if (name == NULL) {
+        return 0;
+    }
+    free(item->string);
+    item->string = name;
+    return cJSON_AddItemToArray(object, item);
+}
+
+// Add a created item, deleting it if it cannot be added
+static cJSON *add_to_object(cJSON *object, const char *name, cJSON *item)
+{
+    if (!cJSON_AddItemToObject(object, name, item)) {
+        cJSON_Delete(item);
+        return NULL;
+    }
+    return item;
+}
+
+cJSON *cJSON_AddObjectToObject(cJSON *object, const char *name)
+{
+    return add_to_object(object, name, cJSON_CreateObject());
+}
+
+cJSON *cJSON_AddArrayToObject(cJSON *object, const char *name)
+{
+    return add_to_object(object, name, cJSON_CreateArray());
+}
+
+cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double number)
+{
+    return add_to_object(object, name, cJSON_CreateNumber(number));
+}
+
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string)
+{
+    return add_to_object(object, name, cJSON_CreateString(string));
+}
+
+cJSON *cJSON_AddBoolToObject(cJSON *object, const char *name, cJSON_bool boolean)
+{
+    return add_to_object(object, name, cJSON_CreateBool(boolean));
+}
+
+int cJSON_GetArraySize(const cJSON *array)
+{
+    int size = 0;
+    for (const cJSON *child = array ? array->child : NULL; child != NULL; child = child->next) {
+        size++;
+    }
+    return size;
+}
+
+cJSON *cJSON_GetArrayItem(const cJSON *array, int index)
+{
+    if (index < 0) {
+        return NULL;
+    }
+    cJSON *child = array ? array->child : NULL;
+    for (; child != NULL && index > 0; index--) {
+        child = child->next;
+    }
+    return child;
+}
+
+// Names are matched case-insensitively, as cJSON_GetObjectItem() does
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string)
+{
+    cJSON *child = object ? object->child : NULL;
+    while (child != NULL && (child->string == NULL || strcasecmp(child->string, string) != 0)) {
+        child = child->next;
+    }
+    return child;
+}
+
+cJSON_bool cJSON_IsBool(const cJSON *item)
+{
+    return item != NULL && (item->type & (cJSON_True | cJSON_False)) != 0;
+}
+
+cJSON_bool cJSON_IsTrue(const cJSON *item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_True;
+}
+
+cJSON_bool cJSON_IsNumber(const cJSON *item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_Number;
+}
+
+cJSON_bool cJSON_IsString(const cJSON *item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_String;
+}
+
+cJSON_bool cJSON_IsArray(const cJSON *item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_Array;
+}
+
+cJSON_bool cJSON_IsObject(const cJSON *item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_Object;
+}
+
+/*************************** Parser *******************************************/
+
+#define PARSE_MAX_DEPTH 1000
+
+typedef struct {
+    const char *p;
+    int depth;
+} parser_t;
+
+static void skip_space(parser_t *parser)
+{
+    while (*parser->p != '\0' && (unsigned char)*parser->p <= ' ') {
+        parser->p++;
+    }
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+static int parse_hex4(const char *p, unsigned *code)
+{
+    *code = 0;
+    for (int i = 0; i < 4; i++) {
+        int v = hex_value(p[i]);
+        if (v < 0) {
+            return 0;
+        }
+        *code = (*code << 4) | (unsigned)v;
+    }
+    return 1;
+}
+
+static size_t put_utf8(char *dst, unsigned code)
+{
+    if (code < 0x80) {
+        dst[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800) {
+        dst[0] = (char)(0xC0 | (code >> 6));
+        dst[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code < 0x10000) {
+        dst[0] = (char)(0xE0 | (code >> 12));
+        dst[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        dst[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    dst[0] = (char)(0xF0 | (code >> 18));
+    dst[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    dst[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    dst[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+// Parse a quoted string, the result is allocated
+static char *parse_string(parser_t *parser)
+{
+    const char *p = parser->p + 1;
+    const char *end = p;
+    while (*end != '"') {
+        if (*end == '\0') {
+            return NULL;
+        }
+        end += (*end == '\\' && end[1] != '\0') ? 2 : 1;
+    }
+
+    // Escapes only make the string shorter
+    char *out = malloc((size_t)(end - p) + 1);
+    if (out == NULL) {
+        return NULL;
+    }
+
+    size_t len = 0;
+    while (p < end) {
+        if (*p != '\\') {
+            out[len++] = *p++;
+            continue;
+        }
+        p++;
+        switch (*p) {
+        case 'b': out[len++] = '\b'; break;
+        case 'f': out[len++] = '\f'; break;
+        case 'n': out[len++] = '\n'; break;
+        case 'r': out[len++] = '\r'; break;
+        case 't': out[len++] = '\t'; break;
+        case '"': case '\\': case '/': out[len++] = *p; break;
+        case 'u': {
+            unsigned code;
+            if (end - p < 5 || !parse_hex4(p + 1, &code)) {
+                free(out);
+                return NULL;
+            }
+            p += 4;
+            // Surrogate pair
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                unsigned low;
+                if (end - p < 7 || p[1] != '\\' || p[2] != 'u' || !parse_hex4(p + 3, &low) ||
+                    low < 0xDC00 || low > 0xDFFF) {
+                    free(out);
+                    return NULL;
+                }
+                code = 0x10000 + (((code & 0x3FF) << 10) | (low & 0x3FF));
+                p += 6;
+            }
+            len += put_utf8(out + len, code);
+            break;
+        }
+        default:
+            free(out);
+            return NULL;
+        }
+        p++;
+    }
+    out[len] = '\0';
+    parser->p = end + 1;
+    return out;
+}
+
+static cJSON *parse_value(parser_t *parser);
+
+// Parse the members of an array or object, the opening bracket is consumed
+static cJSON *parse_children(parser_t *parser, int type, char close)
+{
+    cJSON *item = new_item(type);
+    if (item == NULL || ++parser->depth > PARSE_MAX_DEPTH) {
+        cJSON_Delete(item);
+        return NULL;
+    }
+
+    skip_space(parser);
+    if (*parser->p == close) {
+        parser->p++;
+        parser->depth--;
+        return item;
+    }
+
+    while (1) {
+        char *name = NULL;
+        skip_space(parser);
+        if (type == cJSON_Object) {
+            if (*parser->p != '"' || (name = parse_string(parser)) == NULL) {
+                break;
+            }
+            skip_space(parser);
+            if (*parser->p != ':') {
+                free(name);
+                break;
+            }
+            parser->p++;
+        }
+
+        cJSON *child = parse_value(parser);
+        if (child == NULL) {
+            free(name);
+            break;
+        }
+        child->string = name;
+        cJSON_AddItemToArray(item, child);
+
+        skip_space(parser);
+        if (*parser->p == ',') {
+            parser->p++;
+            continue;
+        }
+        if (*parser->p == close) {
+            parser->p++;
+            parser->depth--;
+            return item;
+        }
+        break;
+    }
+
+    cJSON_Delete(item);
+    return NULL;
+}
+
+static cJSON *parse_number(parser_t *parser)
+{
+    const char *p = parser->p;
+
+    // strtod() accepts more than JSON does, check the grammar first
+    if (*p == '-') {
+        p++;
+    }
+    if (!isdigit((unsigned char)*p)) {
+        return NULL;
+    }
+    if (*p == '0' && isdigit((unsigned char)p[1])) {
+        return NULL;
+    }
+
+    char *end;
+    double number = strtod(parser->p, &end);
+    if (end == parser->p) {
+        return NULL;
+    }
+    parser->p = end;
+    return cJSON_CreateNumber(number);
+}
+
+static cJSON *parse_value(parser_t *parser)
+{
+    skip_space(parser);
+    const char *p = parser->p;
+
+    if (strncmp(p, "null", 4) == 0) {
+        parser->p += 4;
+        return new_item(cJSON_NULL);
+    }
+    if (strncmp(p, "false", 5) == 0) {
+        parser->p += 5;
+        return new_item(cJSON_False);
+    }
+    if (strncmp(p, "true", 4) == 0) {
+        parser->p += 4;
+        cJSON *item = new_item(cJSON_True);
+        if (item != NULL) {
+            item->valueint = 1;
+        }
+        return item;
+    }
+    if (*p == '"') {
+        char *string = parse_string(parser);
+        cJSON *item = string ? new_item(cJSON_String) : NULL;
+        if (item == NULL) {
+            free(string);
+            return NULL;
+        }
+        item->valuestring = string;
+        return item;
+    }
+    if (*p == '[') {
+        parser->p++;
+        return parse_children(parser, cJSON_Array, ']');
+    }
+    if (*p == '{') {
+        parser->p++;
+        return parse_children(parser, cJSON_Object, '}');
+    }
+    return parse_number(parser);
+}
+
+cJSON *cJSON_Parse(const char *value)
+{
+    if (value == NULL) {
+        return NULL;
+    }
+
+    parser_t parser = { .p = value, .depth = 0 };
+    cJSON *item = parse_value(&parser);
+    // Only whitespace may follow the value
+    if (item != NULL) {
+        skip_space(&parser);
+        if (*parser.p != '\0') {
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+    return item;
+}
+
+/*************************** Printer ******************************************/
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+    int ok;
+} printer_t;
+
+static void put(printer_t *out, const char *s, size_t len)
+{
+    if (!out->ok) {
+        return;
+    }
+    if (out->len + len + 1 > out->cap) {
+        size_t cap = out->cap ? out->cap : 256;
+        while (cap < out->len + len + 1) {
+            cap *= 2;
+        }
+        char *buf = realloc(out->buf, cap);
+        if (buf == NULL) {
+            out->ok = 0;
+            return;
+        }
+        out->buf = buf;
+        out->cap = cap;
+    }
+    memcpy(out->buf + out->len, s, len);
+    out->len += len;
+    out->buf[out->len] = '\0';
+}
+
+static void put_str(printer_t *out, const char *s)
+{
+    put(out, s, strlen(s));
+}
+
+static void print_string(printer_t *out, const char *s)
+{
+    put_str(out, "\"");
+    for (const unsigned char *p = (const unsigned char *)(s ? s : ""); *p != '\0'; p++) {
+        char escape[8];
+        switch (*p) {
+        case '"':  put_str(out, "\\\""); break;
+        case '\\': put_str(out, "\\\\"); break;
+        case '\b': put_str(out, "\\b"); break;
+        case '\f': put_str(out, "\\f"); break;
+        case '\n': put_str(out, "\\n"); break;
+        case '\r': put_str(out, "\\r"); break;
+        case '\t': put_str(out, "\\t"); break;
+        default:
+            if (*p < 32) {
+                snprintf(escape, sizeof(escape), "\\u%04x", *p);
+                put_str(out, escape);
+            } else {
+                put(out, (const char *)p, 1);
+            }
+        }
+    }
+    put_str(out, "\"");
+}
+
+// Shortest of 15 or 17 significant digits that reads back the same, as cJSON does
+static void print_number(printer_t *out, const cJSON *item)
+{
+    char number[32];
+    double d = item->valuedouble;
+
+    if (isnan(d) || isinf(d)) {
+        snprintf(number, sizeof(number), "null");
+    } else if (d == (double)item->valueint) {
+        snprintf(number, sizeof(number), "%d", item->valueint);
+    } else {
+        snprintf(number, sizeof(number), "%1.15g", d);
+        if (strtod(number, NULL) != d) {
+            snprintf(number, sizeof(number), "%1.17g", d);
+        }
+    }
+    put_str(out, number);
+}
+
+static void indent(printer_t *out, int depth)
+{
+    for (int i = 0; i < depth; i++) {
+        put_str(out, "\t");
+    }
+}
+
+static void print_value(printer_t *out, const cJSON *item, int depth, int format)
+{
+    switch (item->type & 0xFF) {
+    case cJSON_NULL:   put_str(out, "null"); break;
+    case cJSON_False:  put_str(out, "false"); break;
+    case cJSON_True:   put_str(out, "true"); break;
+    case cJSON_Number: print_number(out, item); break;
+    case cJSON_String: print_string(out, item->valuestring); break;
+    case cJSON_Array:
+        put_str(out, "[");
+        for (const cJSON *child = item->child; child != NULL; child = child->next) {
+            print_value(out, child, depth + 1, format);
+            if (child->next != NULL) {
+                put_str(out, format ? ", " : ",");
+            }
+        }
+        put_str(out, "]");
+        break;
+    case cJSON_Object:
+        put_str(out, format ? "{\n" : "{");
+        for (const cJSON *child = item->child; child != NULL; child = child->next) {
+            if (format) {
+                indent(out, depth + 1);
+            }
+            print_string(out, child->string);
+            put_str(out, format ? ":\t" : ":");
+            print_value(out, child, depth + 1, format);
+            if (child->next != NULL) {
+                put_str(out, ",");
+            }
+            if (format) {
+                put_str(out, "\n");
+            }
+        }
+        if (format) {
+            indent(out, depth);
+        }
+        put_str(out, "}");
+        break;
+    default:
+        out->ok = 0;
+    }
+}
+
+static char *print(const cJSON *item, int format)
+{
+    if (item == NULL) {
+        return NULL;
+    }
+
+    printer_t out = { .ok = 1 };
+    print_value(&out, item, 0, format);
+    if (!out.ok) {
+        free(out.buf);
+        return NULL;
+    }
+    return out.buf;
+}
+
+char *cJSON_Print(const cJSON *item)
+{
+    return print(item, 1);
+}
+
+char *cJSON_PrintUnformatted(const cJSON *item)
+{
+    return print(item, 0);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,404 @@
+/*******************************************************************************
+ * @file        esp_http_server_stub.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       In-memory implementation of the ESP-IDF HTTP server stand-in.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "esp_http_server.h"
+
+struct host_httpd_server {
+    httpd_config_t config;
+    httpd_uri_t handlers[HOST_HTTPD_MAX_HANDLERS];
+    size_t handler_count;
+};
+
+static const char *status_lines[HTTPD_ERR_CODE_MAX] = {
+    [HTTPD_500_INTERNAL_SERVER_ERROR]    = "500 Internal Server Error",
+    [HTTPD_501_METHOD_NOT_IMPLEMENTED]   = "501 Method Not Implemented",
+    [HTTPD_505_VERSION_NOT_SUPPORTED]    = "505 Version Not Supported",
+    [HTTPD_400_BAD_REQUEST]              = "400 Bad Request",
+    [HTTPD_401_UNAUTHORIZED]             = "401 Unauthorized",
+    [HTTPD_403_FORBIDDEN]                = "403 Forbidden",
+    [HTTPD_404_NOT_FOUND]                = "404 Not Found",
+    [HTTPD_405_METHOD_NOT_ALLOWED]       = "405 Method Not Allowed",
+    [HTTPD_408_REQ_TIMEOUT]              = "408 Request Timeout",
+    [HTTPD_411_LENGTH_REQUIRED]          = "411 Length Required",
+    [HTTPD_414_URI_TOO_LONG]             = "414 URI Too Long",
+    [HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE] = "431 Request Header Fields Too Large",
+};
+
+/*************************** Server *******************************************/
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    struct host_httpd_server *server = calloc(1, sizeof(*server));
+    if (server == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    server->config = *config;
+    *handle = server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    if (handle->handler_count >= handle->config.max_uri_handlers ||
+        handle->handler_count >= HOST_HTTPD_MAX_HANDLERS) {
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    handle->handlers[handle->handler_count++] = *uri_handler;
+    return ESP_OK;
+}
+
+esp_err_t host_httpd_dispatch(httpd_handle_t handle, httpd_req_t *r)
+{
+    size_t uri_len = strcspn(r->uri, "?");
+
+    for (size_t i = 0; i < handle->handler_count; i++) {
+        const httpd_uri_t *h = &handle->handlers[i];
+        // WebSocket data frames reach the handler of the GET handshake
+        bool method_match = (int)h->method == r->method || (h->is_websocket && r->method == 0);
+        if (method_match && strlen(h->uri) == uri_len &&
+            strncmp(h->uri, r->uri, uri_len) == 0) {
+            r->handle = handle;
+            r->user_ctx = h->user_ctx;
+            return h->handler(r);
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/*************************** Requests *****************************************/
+
+void host_httpd_req_init(httpd_req_t *r, httpd_method_t method, const char *uri)
+{
+    memset(r, 0, sizeof(*r));
+    r->method = method;
+    snprintf(r->uri, sizeof(r->uri), "%s", uri);
+    snprintf(r->host_status, sizeof(r->host_status), "200 OK");
+    snprintf(r->host_content_type, sizeof(r->host_content_type), "text/html");
+    r->host_fail_after_chunks = -1;
+}
+
+void host_httpd_req_add_header(httpd_req_t *r, const char *name, const char *value)
+{
+    if (r->host_header_count < HOST_HTTPD_MAX_HEADERS) {
+        r->host_headers[r->host_header_count].name = name;
+        r->host_headers[r->host_header_count].value = value;
+        r->host_header_count++;
+    }
+}
+
+void host_httpd_req_set_body(httpd_req_t *r, const char *body, size_t len)
+{
+    r->host_body = body;
+    r->content_len = len;
+    r->host_body_pos = 0;
+}
+
+void host_httpd_req_free(httpd_req_t *r)
+{
+    free(r->host_resp);
+    r->host_resp = NULL;
+    r->host_resp_len = 0;
+    r->host_resp_cap = 0;
+}
+
+static const char *find_header(httpd_req_t *r, const char *field)
+{
+    for (size_t i = 0; i < r->host_header_count; i++) {
+        if (strcasecmp(r->host_headers[i].name, field) == 0) {
+            return r->host_headers[i].value;
+        }
+    }
+    if (strcasecmp(field, "Content-Length") == 0 && r->host_body != NULL) {
+        static __thread char length[24];
+        snprintf(length, sizeof(length), "%zu", r->content_len);
+        return length;
+    }
+    return NULL;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field)
+{
+    const char *value = find_header(r, field);
+    return value ? strlen(value) : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    const char *value = find_header(r, field);
+    if (value == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    snprintf(val, val_size, "%s", value);
+    return strlen(value) < val_size ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t *r)
+{
+    const char *query = strchr(r->uri, '?');
+    return query ? strlen(query + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    const char *query = strchr(r->uri, '?');
+    if (query == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    snprintf(buf, buf_len, "%s", query + 1);
+    return strlen(query + 1) < buf_len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+    size_t key_len = strlen(key);
+    const char *p = qry;
+
+    while (p != NULL && *p != '\0') {
+        const char *end = strchr(p, '&');
+        size_t pair_len = end ? (size_t)(end - p) : strlen(p);
+
+        if (pair_len > key_len && strncmp(p, key, key_len) == 0 && p[key_len] == '=') {
+            size_t value_len = pair_len - key_len - 1;
+            size_t copy_len = value_len < val_size - 1 ? value_len : val_size - 1;
+            memcpy(val, p + key_len + 1, copy_len);
+            val[copy_len] = '\0';
+            return copy_len == value_len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+        }
+        p = end ? end + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    if (r->host_body == NULL) {
+        return 0;
+    }
+    size_t remaining = r->content_len - r->host_body_pos;
+    size_t len = remaining < buf_len ? remaining : buf_len;
+    memcpy(buf, r->host_body + r->host_body_pos, len);
+    r->host_body_pos += len;
+    return (int)len;
+}
+
+/*************************** Responses ****************************************/
+
+static esp_err_t append_response(httpd_req_t *r, const char *buf, size_t len)
+{
+    if (r->host_resp_len + len > r->host_resp_cap) {
+        size_t cap = r->host_resp_cap ? r->host_resp_cap : 256;
+        while (cap < r->host_resp_len + len) {
+            cap *= 2;
+        }
+        char *resp = realloc(r->host_resp, cap);
+        if (resp == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        r->host_resp = resp;
+        r->host_resp_cap = cap;
+    }
+    memcpy(r->host_resp + r->host_resp_len, buf, len);
+    r->host_resp_len += len;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    snprintf(r->host_content_type, sizeof(r->host_content_type), "%s", type);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    snprintf(r->host_status, sizeof(r->host_status), "%s", status);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    (void)r;
+    (void)field;
+    (void)value;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    }
+    esp_err_t err = buf_len > 0 ? append_response(r, buf, (size_t)buf_len) : ESP_OK;
+    r->host_resp_done = true;
+    return err;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (r->host_fail_after_chunks >= 0 && r->host_chunk_count >= (size_t)r->host_fail_after_chunks) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    }
+    r->host_chunk_count++;
+
+    // As on the device, an empty chunk terminates the response
+    if (buf == NULL || buf_len == 0) {
+        r->host_resp_done = true;
+        return ESP_OK;
+    }
+    return append_response(r, buf, (size_t)buf_len);
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send(r, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send_chunk(r, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    if (error < HTTPD_ERR_CODE_MAX && status_lines[error] != NULL) {
+        httpd_resp_set_status(req, status_lines[error]);
+    }
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_sendstr(req, msg);
+}
+
+/*************************** WebSocket ****************************************/
+
+static uint8_t ws_sent[128];
+static size_t ws_sent_len;
+static int ws_sent_fd = -1;
+static size_t ws_sent_count;
+static int ws_closed_fd = -1;
+
+void host_httpd_req_set_ws_frame(httpd_req_t *r, int fd, httpd_ws_type_t type, const uint8_t *payload, size_t len)
+{
+    r->method = 0;
+    r->host_fd = fd;
+    r->host_ws_type = type;
+    r->host_ws_payload = payload;
+    r->host_ws_len = len;
+}
+
+size_t host_httpd_ws_last_sent(int *fd, uint8_t *buf, size_t buf_size, size_t *len)
+{
+    size_t n = ws_sent_len < buf_size ? ws_sent_len : buf_size;
+    memcpy(buf, ws_sent, n);
+    *len = ws_sent_len;
+    *fd = ws_sent_fd;
+    return ws_sent_count;
+}
+
+void host_httpd_ws_set_closed_fd(int fd)
+{
+    ws_closed_fd = fd;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    return r->host_fd;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg)
+{
+    (void)handle;
+    // No server task on the host, run the work right away
+    work(arg);
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len)
+{
+    pkt->type = req->host_ws_type;
+    pkt->final = true;
+    pkt->fragmented = false;
+    pkt->len = req->host_ws_len;
+    if (max_len == 0) {
+        return ESP_OK;
+    }
+    if (pkt->payload == NULL || max_len < req->host_ws_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(pkt->payload, req->host_ws_payload, req->host_ws_len);
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame)
+{
+    (void)hd;
+    if (fd == ws_closed_fd) {
+        return ESP_FAIL;
+    }
+    ws_sent_len = frame->len < sizeof(ws_sent) ? frame->len : sizeof(ws_sent);
+    memcpy(ws_sent, frame->payload, ws_sent_len);
+    ws_sent_fd = fd;
+    ws_sent_count++;
+    return ESP_OK;
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd)
+{
+    (void)hd;
+    if (fd < 0 || fd == ws_closed_fd) {
+        return HTTPD_WS_CLIENT_INVALID;
+    }
+    return HTTPD_WS_CLIENT_WEBSOCKET;
+}
+
+/*************************** Async requests ***********************************/
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out)
+{
+    httpd_req_t *copy = malloc(sizeof(*copy));
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    *copy = *r;
+    copy->host_async_copy = NULL;
+
+    // The copy owns the response from now on
+    r->host_resp = NULL;
+    r->host_resp_len = 0;
+    r->host_resp_cap = 0;
+    r->host_async_copy = copy;
+
+    *out = copy;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r)
+{
+    if (r == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    free(r->host_resp);
+    free(r);
+    return ESP_OK;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
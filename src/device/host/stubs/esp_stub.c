@@ -0,0 +1,697 @@
+/*******************************************************************************
+ * @file        esp_stub.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Implementation of the ESP-IDF system, logging, heap, GPIO, LEDC,
+ *              NVS, camera and image converter stand-ins.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_camera.h"
+#include "esp_heap_caps.h"
+#include "nvs.h"
+#include "img_converters.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*************************** Errors and system ********************************/
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+    default:                    return "UNKNOWN ERROR";
+    }
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return 4 * 1024 * 1024;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return 4 * 1024 * 1024;
+}
+
+static struct timespec timer_start;
+static pthread_once_t timer_start_once = PTHREAD_ONCE_INIT;
+
+static void capture_timer_start(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &timer_start);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec now;
+
+    pthread_once(&timer_start_once, capture_timer_start);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - timer_start.tv_sec) * 1000000 + (now.tv_nsec - timer_start.tv_nsec) / 1000;
+}
+
+struct host_esp_timer {
+    esp_timer_create_args_t args;
+    uint64_t period;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    bool running;
+};
+
+static void *timer_thread(void *arg)
+{
+    struct host_esp_timer *timer = arg;
+    struct timespec next;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (1) {
+        next.tv_nsec += (long)(timer->period % 1000000) * 1000;
+        next.tv_sec += timer->period / 1000000 + next.tv_nsec / 1000000000;
+        next.tv_nsec %= 1000000000;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        pthread_mutex_lock(&timer->lock);
+        bool running = timer->running;
+        pthread_mutex_unlock(&timer->lock);
+        if (!running) {
+            return NULL;
+        }
+        timer->args.callback(timer->args.arg);
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_esp_timer *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->args = *create_args;
+    pthread_mutex_init(&timer->lock, NULL);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    if (timer == NULL || period == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->period = period;
+    timer->running = true;
+    if (pthread_create(&timer->thread, NULL, timer_thread, timer) != 0) {
+        timer->running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (timer == NULL || !timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&timer->lock);
+    timer->running = false;
+    pthread_mutex_unlock(&timer->lock);
+    pthread_join(timer->thread, NULL);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_destroy(&timer->lock);
+    free(timer);
+    return ESP_OK;
+}
+
+/*************************** Logging ******************************************/
+
+static vprintf_like_t log_vprintf = vprintf;
+static esp_log_level_t log_level = ESP_LOG_INFO;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
+{
+    vprintf_like_t previous = log_vprintf;
+    log_vprintf = func;
+    return previous;
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    log_level = level;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)tag;
+    if (level > log_level) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    log_vprintf(format, args);
+    va_end(args);
+}
+
+void esp_log_buffer_hex(const char *tag, const void *buffer, uint16_t buff_len)
+{
+    const uint8_t *bytes = buffer;
+    printf("%s: ", tag);
+    for (uint16_t i = 0; i < buff_len; i++) {
+        printf("%02x ", bytes[i]);
+    }
+    printf("\n");
+}
+
+/*************************** GPIO *********************************************/
+
+static int gpio_levels[HOST_GPIO_COUNT];
+static gpio_isr_t gpio_isr_handlers[HOST_GPIO_COUNT];
+static void *gpio_isr_args[HOST_GPIO_COUNT];
+
+static bool gpio_valid(gpio_num_t gpio_num)
+{
+    return gpio_num >= 0 && gpio_num < HOST_GPIO_COUNT;
+}
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig)
+{
+    return pGPIOConfig->pin_bit_mask >> HOST_GPIO_COUNT ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    if (!gpio_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    gpio_levels[gpio_num] = 0;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    (void)mode;
+    return gpio_valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (!gpio_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    gpio_levels[gpio_num] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    return gpio_valid(gpio_num) ? gpio_levels[gpio_num] : 0;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    if (!gpio_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    gpio_isr_handlers[gpio_num] = isr_handler;
+    gpio_isr_args[gpio_num] = args;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    return gpio_isr_handler_add(gpio_num, NULL, NULL);
+}
+
+void host_gpio_trigger(gpio_num_t gpio_num, int level)
+{
+    if (!gpio_valid(gpio_num)) {
+        return;
+    }
+    gpio_levels[gpio_num] = level ? 1 : 0;
+    if (gpio_isr_handlers[gpio_num] != NULL) {
+        gpio_isr_handlers[gpio_num](gpio_isr_args[gpio_num]);
+    }
+}
+
+/*************************** LEDC *********************************************/
+
+static uint32_t ledc_pending_duty[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+static uint32_t ledc_duty[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf)
+{
+    if (ledc_conf->speed_mode >= LEDC_SPEED_MODE_MAX || ledc_conf->channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ledc_pending_duty[ledc_conf->speed_mode][ledc_conf->channel] = ledc_conf->duty;
+    ledc_duty[ledc_conf->speed_mode][ledc_conf->channel] = ledc_conf->duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf)
+{
+    return timer_conf->speed_mode < LEDC_SPEED_MODE_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ledc_pending_duty[speed_mode][channel] = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ledc_duty[speed_mode][channel] = ledc_pending_duty[speed_mode][channel];
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return 0;
+    }
+    return ledc_duty[speed_mode][channel];
+}
+
+/*************************** Heap *********************************************/
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return realloc(ptr, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    (void)caps;
+    return esp_get_free_heap_size();
+}
+
+/*************************** NVS **********************************************/
+
+#define HOST_NVS_MAX_ENTRIES    16
+#define HOST_NVS_MAX_NAMESPACES 8
+
+typedef struct {
+    char name_space[16];
+    char key[16];
+    void *value;
+    size_t length;
+} host_nvs_entry_t;
+
+static host_nvs_entry_t nvs_entries[HOST_NVS_MAX_ENTRIES];
+static char nvs_namespaces[HOST_NVS_MAX_NAMESPACES][16];
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Handles are the namespace index plus one
+static const char *nvs_namespace_of(nvs_handle_t handle)
+{
+    if (handle == 0 || handle > HOST_NVS_MAX_NAMESPACES || nvs_namespaces[handle - 1][0] == '\0') {
+        return NULL;
+    }
+    return nvs_namespaces[handle - 1];
+}
+
+static host_nvs_entry_t *nvs_find(const char *name_space, const char *key)
+{
+    for (size_t i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (nvs_entries[i].value != NULL && strcmp(nvs_entries[i].name_space, name_space) == 0 &&
+            strcmp(nvs_entries[i].key, key) == 0) {
+            return &nvs_entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    (void)open_mode;
+    if (namespace_name == NULL || strlen(namespace_name) >= sizeof(nvs_namespaces[0])) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    for (size_t i = 0; i < HOST_NVS_MAX_NAMESPACES; i++) {
+        if (nvs_namespaces[i][0] == '\0') {
+            snprintf(nvs_namespaces[i], sizeof(nvs_namespaces[i]), "%s", namespace_name);
+        }
+        if (strcmp(nvs_namespaces[i], namespace_name) == 0) {
+            *out_handle = (nvs_handle_t)(i + 1);
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    const char *name_space = nvs_namespace_of(handle);
+    if (name_space == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = ESP_OK;
+    host_nvs_entry_t *entry = nvs_find(name_space, key);
+    if (entry == NULL) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out_value == NULL) {
+        *length = entry->length;
+    } else if (*length < entry->length) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out_value, entry->value, entry->length);
+        *length = entry->length;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    const char *name_space = nvs_namespace_of(handle);
+    if (name_space == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (key == NULL || strlen(key) >= sizeof(nvs_entries[0].key)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    void *copy = malloc(length > 0 ? length : 1);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, value, length);
+
+    pthread_mutex_lock(&nvs_lock);
+    host_nvs_entry_t *entry = nvs_find(name_space, key);
+    for (size_t i = 0; entry == NULL && i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (nvs_entries[i].value == NULL) {
+            entry = &nvs_entries[i];
+            snprintf(entry->name_space, sizeof(entry->name_space), "%s", name_space);
+            snprintf(entry->key, sizeof(entry->key), "%s", key);
+        }
+    }
+    esp_err_t err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    if (entry != NULL) {
+        free(entry->value);
+        entry->value = copy;
+        entry->length = length;
+        copy = NULL;
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+
+    free(copy);
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    const char *name_space = nvs_namespace_of(handle);
+    if (name_space == NULL) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+    host_nvs_entry_t *entry = nvs_find(name_space, key);
+    if (entry != NULL) {
+        free(entry->value);
+        entry->value = NULL;
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return nvs_namespace_of(handle) != NULL ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+/*************************** Camera *******************************************/
+
+// Images are reference counted so frames handed out survive host_camera_set_frame()
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t width;
+    size_t height;
+    unsigned refs;
+} host_image_t;
+
+typedef struct {
+    camera_fb_t fb;
+    host_image_t *image;
+} host_fb_t;
+
+static pthread_mutex_t camera_lock = PTHREAD_MUTEX_INITIALIZER;
+static host_image_t *camera_image = NULL;
+static camera_config_t camera_config;
+static bool camera_ready = false;
+static size_t decode_width = 0;     // Size jpg2rgb565() assumes for every buffer
+static size_t decode_height = 0;
+
+static void image_unref(host_image_t *image)
+{
+    if (image != NULL && --image->refs == 0) {
+        free(image->data);
+        free(image);
+    }
+}
+
+static int sensor_set_framesize(sensor_t *sensor, framesize_t framesize)
+{
+    if (framesize >= FRAMESIZE_INVALID) {
+        return -1;
+    }
+    sensor->status.framesize = framesize;
+    return 0;
+}
+
+static int sensor_set_quality(sensor_t *sensor, int quality)
+{
+    sensor->status.quality = (uint8_t)quality;
+    return 0;
+}
+
+static int sensor_set_res_raw(sensor_t *sensor, int startX, int startY, int endX, int endY,
+                              int offsetX, int offsetY, int totalX, int totalY,
+                              int outputX, int outputY, bool scale, bool binning)
+{
+    (void)sensor; (void)startX; (void)startY; (void)endX; (void)endY;
+    (void)scale; (void)binning;
+    if (offsetX < 0 || offsetY < 0 || totalX <= 0 || totalY <= 0 ||
+        outputX <= 0 || outputY <= 0 || outputX > totalX || outputY > totalY) {
+        return -1;
+    }
+    return 0;
+}
+
+static sensor_t camera_sensor = {
+    .id = {.PID = OV2640_PID},
+    .set_framesize = sensor_set_framesize,
+    .set_quality = sensor_set_quality,
+    .set_res_raw = sensor_set_res_raw,
+};
+
+esp_err_t esp_camera_init(const camera_config_t *config)
+{
+    camera_config = *config;
+    camera_sensor.status.framesize = config->frame_size;
+    camera_sensor.status.quality = (uint8_t)config->jpeg_quality;
+    camera_ready = true;
+    return ESP_OK;
+}
+
+sensor_t *esp_camera_sensor_get(void)
+{
+    return camera_ready ? &camera_sensor : NULL;
+}
+
+esp_err_t esp_camera_deinit(void)
+{
+    camera_ready = false;
+    return ESP_OK;
+}
+
+void host_camera_set_frame(const uint8_t *buf, size_t len, size_t width, size_t height)
+{
+    host_image_t *image = calloc(1, sizeof(*image));
+    if (image == NULL) {
+        return;
+    }
+    image->data = malloc(len);
+    if (image->data == NULL) {
+        free(image);
+        return;
+    }
+    memcpy(image->data, buf, len);
+    image->len = len;
+    image->width = width;
+    image->height = height;
+    image->refs = 1;
+
+    pthread_mutex_lock(&camera_lock);
+    image_unref(camera_image);
+    camera_image = image;
+    decode_width = width;
+    decode_height = height;
+    pthread_mutex_unlock(&camera_lock);
+}
+
+camera_fb_t *esp_camera_fb_get(void)
+{
+    if (!camera_ready) {
+        return NULL;
+    }
+
+    // Pace captures like a sensor would
+    vTaskDelay(pdMS_TO_TICKS(1000 / HOST_CAMERA_FPS));
+
+    pthread_mutex_lock(&camera_lock);
+    host_image_t *image = camera_image;
+    if (image != NULL) {
+        image->refs++;
+    }
+    pthread_mutex_unlock(&camera_lock);
+
+    if (image == NULL) {
+        return NULL;
+    }
+
+    host_fb_t *frame = calloc(1, sizeof(*frame));
+    if (frame == NULL) {
+        pthread_mutex_lock(&camera_lock);
+        image_unref(image);
+        pthread_mutex_unlock(&camera_lock);
+        return NULL;
+    }
+    frame->image = image;
+    frame->fb.buf = image->data;
+    frame->fb.len = image->len;
+    frame->fb.width = image->width;
+    frame->fb.height = image->height;
+    frame->fb.format = camera_config.pixel_format;
+    gettimeofday(&frame->fb.timestamp, NULL);
+    return &frame->fb;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb)
+{
+    if (fb == NULL) {
+        return;
+    }
+    host_fb_t *frame = (host_fb_t *)fb;
+
+    pthread_mutex_lock(&camera_lock);
+    image_unref(frame->image);
+    pthread_mutex_unlock(&camera_lock);
+    free(frame);
+}
+
+bool jpg2rgb565(const uint8_t *src, size_t src_len, uint8_t *out, jpg_scale_t scale)
+{
+    pthread_mutex_lock(&camera_lock);
+    size_t width = decode_width >> scale;
+    size_t height = decode_height >> scale;
+    pthread_mutex_unlock(&camera_lock);
+
+    if (src == NULL || src_len == 0 || width == 0 || height == 0) {
+        return false;
+    }
+
+    size_t pixels = width * height;
+    for (size_t i = 0; i < pixels; i++) {
+        uint8_t gray = src[(i * src_len) / pixels];
+        uint16_t c = ((gray & 0xF8) << 8) | ((gray & 0xFC) << 3) | (gray >> 3);
+        out[2 * i] = c >> 8;
+        out[2 * i + 1] = c & 0xFF;
+    }
+    return true;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,556 @@
+/*******************************************************************************
+ * @file        freertos_stub.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       pthread backed implementation of the FreeRTOS stand-ins.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t function;
+    void *parameters;
+    const char *name;
+    pthread_mutex_t notify_lock;
+    pthread_cond_t notify_cond;
+    uint32_t notify_value;
+};
+
+struct host_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct host_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+    uint32_t set_generation;    // Bumped on every xEventGroupSetBits()
+    EventBits_t last_set_bits;  // Bits as they were right after the last set
+};
+
+static pthread_mutex_t critical_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread struct host_task *current_task = NULL;
+
+/*************************** Time helpers *************************************/
+
+static struct timespec start_time;
+static pthread_once_t start_time_once = PTHREAD_ONCE_INIT;
+
+static void capture_start_time(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+static uint64_t monotonic_ms(void)
+{
+    struct timespec now;
+
+    pthread_once(&start_time_once, capture_start_time);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - start_time.tv_sec) * 1000 + (now.tv_nsec - start_time.tv_nsec) / 1000000;
+}
+
+static void sleep_ms(uint64_t ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000 };
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+    }
+}
+
+static void init_cond(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// Wait on cond until the tick deadline, returns false on timeout
+static bool wait_until(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, const struct timespec *deadline)
+{
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    uint64_t ms = (uint64_t)ticks * portTICK_PERIOD_MS;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return ts;
+}
+
+void host_enter_critical(void)
+{
+    pthread_mutex_lock(&critical_lock);
+}
+
+void host_exit_critical(void)
+{
+    pthread_mutex_unlock(&critical_lock);
+}
+
+/*************************** Tasks ********************************************/
+
+static void *task_entry(void *arg)
+{
+    struct host_task *task = arg;
+    current_task = task;
+    task->function(task->parameters);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName,
+                                   uint32_t usStackDepth, void *pvParameters,
+                                   UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask,
+                                   BaseType_t xCoreID)
+{
+    (void)usStackDepth;
+    (void)uxPriority;
+    (void)xCoreID;
+
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->function = pvTaskCode;
+    task->parameters = pvParameters;
+    task->name = pcName;
+    pthread_mutex_init(&task->notify_lock, NULL);
+    init_cond(&task->notify_cond);
+
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+
+    if (pxCreatedTask != NULL) {
+        *pxCreatedTask = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char *pcName,
+                       uint32_t usStackDepth, void *pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+    return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters,
+                                   uxPriority, pxCreatedTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t xTask)
+{
+    if (xTask == NULL || xTask == current_task) {
+        pthread_exit(NULL);
+    }
+    pthread_cancel(xTask->thread);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    sleep_ms((uint64_t)xTicksToDelay * portTICK_PERIOD_MS);
+}
+
+void vTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+    TickType_t wake = *pxPreviousWakeTime + xTimeIncrement;
+    TickType_t now = xTaskGetTickCount();
+
+    if ((int32_t)(wake - now) > 0) {
+        vTaskDelay(wake - now);
+    }
+    *pxPreviousWakeTime = wake;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(monotonic_ms() / portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current_task;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+    (void)xTask;
+    return 0;
+}
+
+/*************************** Task notifications *******************************/
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    pthread_mutex_lock(&xTaskToNotify->notify_lock);
+    xTaskToNotify->notify_value++;
+    pthread_cond_broadcast(&xTaskToNotify->notify_cond);
+    pthread_mutex_unlock(&xTaskToNotify->notify_lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    xTaskNotifyGive(xTaskToNotify);
+    if (pxHigherPriorityTaskWoken != NULL) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    struct host_task *task = current_task;
+    struct timespec deadline = deadline_after(xTicksToWait);
+    uint32_t value;
+
+    pthread_mutex_lock(&task->notify_lock);
+    while (task->notify_value == 0) {
+        if (xTicksToWait == 0 || !wait_until(&task->notify_cond, &task->notify_lock, xTicksToWait, &deadline)) {
+            break;
+        }
+    }
+    value = task->notify_value;
+    if (value > 0) {
+        task->notify_value = xClearCountOnExit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->notify_lock);
+    return value;
+}
+
+/*************************** Semaphores ***************************************/
+
+static SemaphoreHandle_t create_semaphore(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    struct host_semaphore *sem = calloc(1, sizeof(*sem));
+    if (sem == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    init_cond(&sem->cond);
+    sem->count = initial_count;
+    sem->max_count = max_count;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return create_semaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return create_semaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    return create_semaphore(uxMaxCount, uxInitialCount);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    struct timespec deadline = deadline_after(xBlockTime);
+    BaseType_t taken = pdTRUE;
+
+    pthread_mutex_lock(&xSemaphore->lock);
+    while (xSemaphore->count == 0) {
+        if (xBlockTime == 0 || !wait_until(&xSemaphore->cond, &xSemaphore->lock, xBlockTime, &deadline)) {
+            taken = xSemaphore->count > 0 ? pdTRUE : pdFALSE;
+            break;
+        }
+    }
+    if (taken && xSemaphore->count > 0) {
+        xSemaphore->count--;
+    } else {
+        taken = pdFALSE;
+    }
+    pthread_mutex_unlock(&xSemaphore->lock);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    BaseType_t given = pdFALSE;
+
+    pthread_mutex_lock(&xSemaphore->lock);
+    if (xSemaphore->count < xSemaphore->max_count) {
+        xSemaphore->count++;
+        given = pdTRUE;
+        pthread_cond_signal(&xSemaphore->cond);
+    }
+    pthread_mutex_unlock(&xSemaphore->lock);
+    return given;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(xSemaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    pthread_mutex_destroy(&xSemaphore->lock);
+    pthread_cond_destroy(&xSemaphore->cond);
+    free(xSemaphore);
+}
+
+/*************************** Queues *******************************************/
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    struct host_queue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->storage = calloc(uxQueueLength, uxItemSize);
+    if (queue->storage == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    init_cond(&queue->cond);
+    queue->length = uxQueueLength;
+    queue->item_size = uxItemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+    struct timespec deadline = deadline_after(xTicksToWait);
+    BaseType_t sent = pdFALSE;
+
+    pthread_mutex_lock(&xQueue->lock);
+    while (xQueue->count == xQueue->length) {
+        if (xTicksToWait == 0 || !wait_until(&xQueue->cond, &xQueue->lock, xTicksToWait, &deadline)) {
+            break;
+        }
+    }
+    if (xQueue->count < xQueue->length) {
+        UBaseType_t tail = (xQueue->head + xQueue->count) % xQueue->length;
+        memcpy(xQueue->storage + tail * xQueue->item_size, pvItemToQueue, xQueue->item_size);
+        xQueue->count++;
+        sent = pdTRUE;
+        pthread_cond_broadcast(&xQueue->cond);
+    }
+    pthread_mutex_unlock(&xQueue->lock);
+    return sent;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+    return xQueueSend(xQueue, pvItemToQueue, xTicksToWait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return xQueueSend(xQueue, pvItemToQueue, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t xQueue, const void *pvItemToQueue)
+{
+    pthread_mutex_lock(&xQueue->lock);
+    xQueue->head = 0;
+    xQueue->count = 1;
+    memcpy(xQueue->storage, pvItemToQueue, xQueue->item_size);
+    pthread_cond_broadcast(&xQueue->cond);
+    pthread_mutex_unlock(&xQueue->lock);
+    return pdPASS;
+}
+
+static BaseType_t queue_read(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait, bool remove)
+{
+    struct timespec deadline = deadline_after(xTicksToWait);
+    BaseType_t received = pdFALSE;
+
+    pthread_mutex_lock(&xQueue->lock);
+    while (xQueue->count == 0) {
+        if (xTicksToWait == 0 || !wait_until(&xQueue->cond, &xQueue->lock, xTicksToWait, &deadline)) {
+            break;
+        }
+    }
+    if (xQueue->count > 0) {
+        memcpy(pvBuffer, xQueue->storage + xQueue->head * xQueue->item_size, xQueue->item_size);
+        if (remove) {
+            xQueue->head = (xQueue->head + 1) % xQueue->length;
+            xQueue->count--;
+            pthread_cond_broadcast(&xQueue->cond);
+        }
+        received = pdTRUE;
+    }
+    pthread_mutex_unlock(&xQueue->lock);
+    return received;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    return queue_read(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    return queue_read(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+    pthread_mutex_lock(&xQueue->lock);
+    xQueue->head = 0;
+    xQueue->count = 0;
+    pthread_cond_broadcast(&xQueue->cond);
+    pthread_mutex_unlock(&xQueue->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+    pthread_mutex_lock(&xQueue->lock);
+    UBaseType_t count = xQueue->count;
+    pthread_mutex_unlock(&xQueue->lock);
+    return count;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+    pthread_mutex_destroy(&xQueue->lock);
+    pthread_cond_destroy(&xQueue->cond);
+    free(xQueue->storage);
+    free(xQueue);
+}
+
+/*************************** Event groups *************************************/
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct host_event_group *group = calloc(1, sizeof(*group));
+    if (group == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&group->lock, NULL);
+    init_cond(&group->cond);
+    return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet)
+{
+    pthread_mutex_lock(&xEventGroup->lock);
+    xEventGroup->bits |= uxBitsToSet;
+    xEventGroup->last_set_bits = xEventGroup->bits;
+    xEventGroup->set_generation++;
+    EventBits_t bits = xEventGroup->bits;
+    pthread_cond_broadcast(&xEventGroup->cond);
+    pthread_mutex_unlock(&xEventGroup->lock);
+    return bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear)
+{
+    pthread_mutex_lock(&xEventGroup->lock);
+    EventBits_t bits = xEventGroup->bits;
+    xEventGroup->bits &= ~uxBitsToClear;
+    pthread_mutex_unlock(&xEventGroup->lock);
+    return bits;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup)
+{
+    pthread_mutex_lock(&xEventGroup->lock);
+    EventBits_t bits = xEventGroup->bits;
+    pthread_mutex_unlock(&xEventGroup->lock);
+    return bits;
+}
+
+static bool bits_match(EventBits_t bits, EventBits_t wanted, BaseType_t all)
+{
+    return all ? (bits & wanted) == wanted : (bits & wanted) != 0;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToWaitFor,
+                                const BaseType_t xClearOnExit, const BaseType_t xWaitForAllBits,
+                                TickType_t xTicksToWait)
+{
+    struct timespec deadline = deadline_after(xTicksToWait);
+
+    pthread_mutex_lock(&xEventGroup->lock);
+    EventBits_t bits = xEventGroup->bits;
+    uint32_t generation = xEventGroup->set_generation;
+
+    while (!bits_match(bits, uxBitsToWaitFor, xWaitForAllBits)) {
+        if (xTicksToWait == 0 || !wait_until(&xEventGroup->cond, &xEventGroup->lock, xTicksToWait, &deadline)) {
+            bits = xEventGroup->bits;
+            break;
+        }
+        // A set followed by a clear still releases the waiter
+        bits = xEventGroup->bits;
+        if (xEventGroup->set_generation != generation) {
+            bits |= xEventGroup->last_set_bits;
+            generation = xEventGroup->set_generation;
+        }
+    }
+
+    if (xClearOnExit && bits_match(bits, uxBitsToWaitFor, xWaitForAllBits)) {
+        xEventGroup->bits &= ~uxBitsToWaitFor;
+    }
+    pthread_mutex_unlock(&xEventGroup->lock);
+    return bits;
+}
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup)
+{
+    pthread_mutex_destroy(&xEventGroup->lock);
+    pthread_cond_destroy(&xEventGroup->cond);
+    free(xEventGroup);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * @file        cJSON.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the cJSON component of ESP-IDF.
+ *              Same types and calls as cJSON for the subset the firmware uses,
+ *              so the HTTP handlers build on a host without cJSON installed.
+ *              Numbers and strings are printed the way cJSON prints them.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_CJSON_H
+#define HOST_CJSON_H
+
+#include <stddef.h>
+
+#define cJSON_Invalid   (0)
+#define cJSON_False     (1 << 0)
+#define cJSON_True      (1 << 1)
+#define cJSON_NULL      (1 << 2)
+#define cJSON_Number    (1 << 3)
+#define cJSON_String    (1 << 4)
+#define cJSON_Array     (1 << 5)
+#define cJSON_Object    (1 << 6)
+
+typedef int cJSON_bool;
+
+typedef struct cJSON {
+    struct cJSON *next;
+    struct cJSON *prev;
+    struct cJSON *child;
+    int type;
+    char *valuestring;
+    int valueint;
+    double valuedouble;
+    char *string;
+} cJSON;
+
+cJSON *cJSON_CreateObject(void);
+cJSON *cJSON_CreateArray(void);
+cJSON *cJSON_CreateNumber(double num);
+cJSON *cJSON_CreateString(const char *string);
+cJSON *cJSON_CreateBool(cJSON_bool boolean);
+void cJSON_Delete(cJSON *item);
+
+cJSON_bool cJSON_AddItemToArray(cJSON *array, cJSON *item);
+cJSON_bool cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item);
+cJSON *cJSON_AddObjectToObject(cJSON *object, const char *name);
+cJSON *cJSON_AddArrayToObject(cJSON *object, const char *name);
+cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double number);
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string);
+cJSON *cJSON_AddBoolToObject(cJSON *object, const char *name, cJSON_bool boolean);
+
+int cJSON_GetArraySize(const cJSON *array);
+cJSON *cJSON_GetArrayItem(const cJSON *array, int index);
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string);
+
+cJSON_bool cJSON_IsBool(const cJSON *item);
+cJSON_bool cJSON_IsTrue(const cJSON *item);
+cJSON_bool cJSON_IsNumber(const cJSON *item);
+cJSON_bool cJSON_IsString(const cJSON *item);
+cJSON_bool cJSON_IsArray(const cJSON *item);
+cJSON_bool cJSON_IsObject(const cJSON *item);
+
+/**
+ * @brief Parses a JSON document, NULL if it is not valid JSON.
+ */
+cJSON *cJSON_Parse(const char *value);
+
+/**
+ * @brief Prints an item with tabs and newlines, the string is freed with free().
+ */
+char *cJSON_Print(const cJSON *item);
+
+/**
+ * @brief Prints an item without whitespace, the string is freed with free().
+ */
+char *cJSON_PrintUnformatted(const cJSON *item);
+
+#endif /* HOST_CJSON_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,22 @@
+/*******************************************************************************
+ * @file        esp_attr.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the ESP-IDF memory placement attributes.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_ATTR
+#define RTC_DATA_ATTR
+
+#endif /* HOST_ESP_ATTR_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * @file        esp_camera.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the esp32-camera driver.
+ *              esp_camera_fb_get() hands out the frame set with host_camera_set_frame()
+ *              at the pace of a sensor running at HOST_CAMERA_FPS.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_ESP_CAMERA_H
+#define HOST_ESP_CAMERA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/time.h>
+#include "esp_err.h"
+#include "driver/ledc.h"
+
+#define HOST_CAMERA_FPS 25
+
+typedef enum {
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_YUV420,
+    PIXFORMAT_GRAYSCALE,
+    PIXFORMAT_JPEG,
+    PIXFORMAT_RGB888,
+    PIXFORMAT_RAW,
+    PIXFORMAT_RGB444,
+    PIXFORMAT_RGB555,
+} pixformat_t;
+
+typedef enum {
+    FRAMESIZE_96X96,
+    FRAMESIZE_QQVGA,
+    FRAMESIZE_QCIF,
+    FRAMESIZE_HQVGA,
+    FRAMESIZE_240X240,
+    FRAMESIZE_QVGA,
+    FRAMESIZE_CIF,
+    FRAMESIZE_HVGA,
+    FRAMESIZE_VGA,
+    FRAMESIZE_SVGA,
+    FRAMESIZE_XGA,
+    FRAMESIZE_HD,
+    FRAMESIZE_SXGA,
+    FRAMESIZE_UXGA,
+    FRAMESIZE_INVALID
+} framesize_t;
+
+typedef enum {
+    CAMERA_GRAB_WHEN_EMPTY,
+    CAMERA_GRAB_LATEST
+} camera_grab_mode_t;
+
+typedef enum {
+    CAMERA_FB_IN_PSRAM,
+    CAMERA_FB_IN_DRAM
+} camera_fb_location_t;
+
+typedef struct {
+    int pin_pwdn;
+    int pin_reset;
+    int pin_xclk;
+    int pin_sscb_sda;
+    int pin_sscb_scl;
+    int pin_d7;
+    int pin_d6;
+    int pin_d5;
+    int pin_d4;
+    int pin_d3;
+    int pin_d2;
+    int pin_d1;
+    int pin_d0;
+    int pin_vsync;
+    int pin_href;
+    int pin_pclk;
+    int xclk_freq_hz;
+    ledc_timer_t ledc_timer;
+    ledc_channel_t ledc_channel;
+    pixformat_t pixel_format;
+    framesize_t frame_size;
+    int jpeg_quality;
+    size_t fb_count;
+    camera_fb_location_t fb_location;
+    camera_grab_mode_t grab_mode;
+} camera_config_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+    struct timeval timestamp;
+} camera_fb_t;
+
+typedef struct {
+    framesize_t framesize;
+    uint8_t quality;
+} camera_status_t;
+
+#define OV2640_PID 0x26
+
+typedef struct {
+    uint8_t MIDH;
+    uint8_t MIDL;
+    uint16_t PID;
+    uint8_t VER;
+} sensor_id_t;
+
+/**
+ * @brief Subset of the sensor control interface used by the firmware.
+ *        The settings are only checked and recorded, frames keep the size
+ *        given to host_camera_set_frame().
+ */
+typedef struct _sensor sensor_t;
+struct _sensor {
+    sensor_id_t id;
+    camera_status_t status;
+    int (*set_framesize)(sensor_t *sensor, framesize_t framesize);
+    int (*set_quality)(sensor_t *sensor, int quality);
+    int (*set_res_raw)(sensor_t *sensor, int startX, int startY, int endX, int endY,
+                       int offsetX, int offsetY, int totalX, int totalY,
+                       int outputX, int outputY, bool scale, bool binning);
+};
+
+esp_err_t esp_camera_init(const camera_config_t *config);
+sensor_t *esp_camera_sensor_get(void);
+esp_err_t esp_camera_deinit(void);
+camera_fb_t *esp_camera_fb_get(void);
+void esp_camera_fb_return(camera_fb_t *fb);
+
+/**
+ * @brief Host only: set the image returned by the following captures.
+ *        The data is copied. Frames already handed out keep the previous image.
+ */
+void host_camera_set_frame(const uint8_t *buf, size_t len, size_t width, size_t height);
+
+#endif /* HOST_ESP_CAMERA_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,250 @@
+/*******************************************************************************
+ * @file        esp_http_server.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the ESP-IDF HTTP server.
+ *              No socket is opened: requests are built in memory with the
+ *              host_httpd_req_* helpers, handed to the registered handler with
+ *              host_httpd_dispatch(), and the response is captured in the request.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_ESP_HTTP_SERVER_H
+#define HOST_ESP_HTTP_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#define HTTPD_MAX_URI_LEN           512
+#define HTTPD_RESP_USE_STRLEN       -1
+
+#define HTTPD_200                   "200 OK"
+#define HTTPD_204                   "204 No Content"
+#define HTTPD_400                   "400 Bad Request"
+#define HTTPD_404                   "404 Not Found"
+#define HTTPD_500                   "500 Internal Server Error"
+#define HOST_HTTPD_MAX_HEADERS      16
+#define HOST_HTTPD_MAX_HANDLERS     32
+
+#define ESP_ERR_HTTPD_BASE              (0xb000)
+#define ESP_ERR_HTTPD_HANDLERS_FULL     (ESP_ERR_HTTPD_BASE + 1)
+#define ESP_ERR_HTTPD_HANDLER_EXISTS    (ESP_ERR_HTTPD_BASE + 2)
+#define ESP_ERR_HTTPD_INVALID_REQ       (ESP_ERR_HTTPD_BASE + 3)
+#define ESP_ERR_HTTPD_RESULT_TRUNC      (ESP_ERR_HTTPD_BASE + 4)
+#define ESP_ERR_HTTPD_RESP_HDR          (ESP_ERR_HTTPD_BASE + 5)
+#define ESP_ERR_HTTPD_RESP_SEND         (ESP_ERR_HTTPD_BASE + 6)
+
+#define HTTPD_SOCK_ERR_TIMEOUT      -3
+
+typedef enum {
+    HTTP_DELETE = 0,
+    HTTP_GET = 1,
+    HTTP_HEAD = 2,
+    HTTP_POST = 3,
+    HTTP_PUT = 4,
+} httpd_method_t;
+
+typedef enum {
+    HTTPD_500_INTERNAL_SERVER_ERROR = 0,
+    HTTPD_501_METHOD_NOT_IMPLEMENTED,
+    HTTPD_505_VERSION_NOT_SUPPORTED,
+    HTTPD_400_BAD_REQUEST,
+    HTTPD_401_UNAUTHORIZED,
+    HTTPD_403_FORBIDDEN,
+    HTTPD_404_NOT_FOUND,
+    HTTPD_405_METHOD_NOT_ALLOWED,
+    HTTPD_408_REQ_TIMEOUT,
+    HTTPD_411_LENGTH_REQUIRED,
+    HTTPD_414_URI_TOO_LONG,
+    HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE,
+    HTTPD_ERR_CODE_MAX
+} httpd_err_code_t;
+
+typedef struct host_httpd_server *httpd_handle_t;
+
+typedef enum {
+    HTTPD_WS_TYPE_CONTINUE = 0x0,
+    HTTPD_WS_TYPE_TEXT     = 0x1,
+    HTTPD_WS_TYPE_BINARY   = 0x2,
+    HTTPD_WS_TYPE_CLOSE    = 0x8,
+    HTTPD_WS_TYPE_PING     = 0x9,
+    HTTPD_WS_TYPE_PONG     = 0xA,
+} httpd_ws_type_t;
+
+typedef enum {
+    HTTPD_WS_CLIENT_INVALID   = 0x0,
+    HTTPD_WS_CLIENT_HTTP      = 0x1,
+    HTTPD_WS_CLIENT_WEBSOCKET = 0x2,
+} httpd_ws_client_info_t;
+
+typedef struct {
+    bool final;
+    bool fragmented;
+    httpd_ws_type_t type;
+    uint8_t *payload;
+    size_t len;
+} httpd_ws_frame_t;
+
+typedef void (*httpd_work_fn_t)(void *arg);
+
+typedef struct {
+    UBaseType_t task_priority;
+    size_t stack_size;
+    BaseType_t core_id;
+    uint16_t server_port;
+    uint16_t ctrl_port;
+    uint16_t max_open_sockets;
+    uint16_t max_uri_handlers;
+    uint16_t max_resp_headers;
+    uint16_t backlog_conn;
+    bool lru_purge_enable;
+    uint16_t recv_wait_timeout;
+    uint16_t send_wait_timeout;
+    void *uri_match_fn;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() {                        \
+        .task_priority      = tskIDLE_PRIORITY + 5,     \
+        .stack_size         = 4096,                     \
+        .core_id            = tskNO_AFFINITY,           \
+        .server_port        = 80,                       \
+        .ctrl_port          = 32768,                    \
+        .max_open_sockets   = 7,                        \
+        .max_uri_handlers   = 8,                        \
+        .max_resp_headers   = 8,                        \
+        .backlog_conn       = 5,                        \
+        .lru_purge_enable   = false,                    \
+        .recv_wait_timeout  = 5,                        \
+        .send_wait_timeout  = 5,                        \
+        .uri_match_fn       = NULL,                     \
+}
+
+typedef struct {
+    const char *name;
+    const char *value;
+} host_httpd_header_t;
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int method;
+    char uri[HTTPD_MAX_URI_LEN + 1];
+    size_t content_len;
+    void *aux;
+    void *user_ctx;
+    void *sess_ctx;
+
+    /* Host build only: request input */
+    host_httpd_header_t host_headers[HOST_HTTPD_MAX_HEADERS];
+    size_t host_header_count;
+    const char *host_body;
+    size_t host_body_pos;
+
+    /* Host build only: captured response */
+    char host_status[32];
+    char host_content_type[96];
+    char *host_resp;
+    size_t host_resp_len;
+    size_t host_resp_cap;
+    size_t host_chunk_count;
+    bool host_resp_done;
+    int host_fail_after_chunks;     /* Make send_chunk fail after n chunks, -1 never */
+    struct httpd_req *host_async_copy; /* Copy made by httpd_req_async_handler_begin */
+
+    /* Host build only: WebSocket data frame delivered to the handler */
+    int host_fd;
+    httpd_ws_type_t host_ws_type;
+    const uint8_t *host_ws_payload;
+    size_t host_ws_len;
+} httpd_req_t;
+
+typedef struct {
+    const char *uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t *r);
+    void *user_ctx;
+    bool is_websocket;
+} httpd_uri_t;
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler);
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg);
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out);
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r);
+
+int httpd_req_to_sockfd(httpd_req_t *r);
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg);
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len);
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame);
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd);
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size);
+size_t httpd_req_get_url_query_len(httpd_req_t *r);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size);
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len);
+
+/**
+ * @brief Host only: prepare a request for the given method and URI (with query).
+ */
+void host_httpd_req_init(httpd_req_t *r, httpd_method_t method, const char *uri);
+
+/**
+ * @brief Host only: add a request header. Name and value are not copied.
+ */
+void host_httpd_req_add_header(httpd_req_t *r, const char *name, const char *value);
+
+/**
+ * @brief Host only: set the request body. The body is not copied.
+ */
+void host_httpd_req_set_body(httpd_req_t *r, const char *body, size_t len);
+
+/**
+ * @brief Host only: free the captured response of a request.
+ */
+void host_httpd_req_free(httpd_req_t *r);
+
+/**
+ * @brief Host only: turn a request into a WebSocket data frame on socket fd.
+ * The payload is not copied. Frames are delivered with method 0, as on the device.
+ */
+void host_httpd_req_set_ws_frame(httpd_req_t *r, int fd, httpd_ws_type_t type, const uint8_t *payload, size_t len);
+
+/**
+ * @brief Host only: copy the last frame sent with httpd_ws_send_frame_async().
+ * @return Number of frames sent so far.
+ */
+size_t host_httpd_ws_last_sent(int *fd, uint8_t *buf, size_t buf_size, size_t *len);
+
+/**
+ * @brief Host only: make httpd_ws_get_fd_info() report fd as closed, -1 for none.
+ */
+void host_httpd_ws_set_closed_fd(int fd);
+
+/**
+ * @brief Host only: run the handler registered on a server for the request.
+ * @return The handler result, or ESP_ERR_NOT_FOUND if no handler matches.
+ */
+esp_err_t host_httpd_dispatch(httpd_handle_t handle, httpd_req_t *r);
+
+#endif /* HOST_ESP_HTTP_SERVER_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
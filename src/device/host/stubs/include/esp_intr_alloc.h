@@ -0,0 +1,22 @@
+/*******************************************************************************
+ * @file        esp_intr_alloc.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the ESP-IDF interrupt allocator.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_ESP_INTR_ALLOC_H
+#define HOST_ESP_INTR_ALLOC_H
+
+#include "esp_err.h"
+
+#define ESP_INTR_FLAG_LEVEL1    (1 << 1)
+#define ESP_INTR_FLAG_IRAM      (1 << 10)
+
+#endif /* HOST_ESP_INTR_ALLOC_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
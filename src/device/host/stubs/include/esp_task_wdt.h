@@ -0,0 +1,21 @@
+/*******************************************************************************
+ * @file        esp_task_wdt.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the ESP-IDF task watchdog.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_ESP_TASK_WDT_H
+#define HOST_ESP_TASK_WDT_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#endif /* HOST_ESP_TASK_WDT_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
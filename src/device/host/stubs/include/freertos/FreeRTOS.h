@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * @file        FreeRTOS.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the FreeRTOS kernel types.
+ *              Tasks, queues, semaphores and event groups are backed by pthreads
+ *              in freertos_stub.c. One tick lasts 1000 / configTICK_RATE_HZ ms,
+ *              as on the device (CONFIG_FREERTOS_HZ).
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ          100
+#define configMINIMAL_STACK_SIZE    2048
+#define configSTACK_DEPTH_TYPE      uint32_t
+#define configASSERT(x)             assert(x)
+
+#define pdFALSE                     ((BaseType_t)0)
+#define pdTRUE                      ((BaseType_t)1)
+#define pdPASS                      pdTRUE
+#define pdFAIL                      pdFALSE
+#define errQUEUE_FULL               ((BaseType_t)0)
+
+#define portMAX_DELAY               ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS          ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define tskIDLE_PRIORITY            ((UBaseType_t)0U)
+#define tskNO_AFFINITY              0x7FFFFFFF
+
+#ifndef BIT0
+#define BIT0    0x00000001
+#define BIT1    0x00000002
+#define BIT2    0x00000004
+#define BIT3    0x00000008
+#define BIT4    0x00000010
+#define BIT5    0x00000020
+#define BIT6    0x00000040
+#define BIT7    0x00000080
+#endif
+
+// Critical sections map onto one process wide recursive lock
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    {0}
+
+void host_enter_critical(void);
+void host_exit_critical(void);
+
+#define portENTER_CRITICAL(mux)         ((void)(mux), host_enter_critical())
+#define portEXIT_CRITICAL(mux)          ((void)(mux), host_exit_critical())
+#define portENTER_CRITICAL_ISR(mux)     ((void)(mux), host_enter_critical())
+#define portEXIT_CRITICAL_ISR(mux)      ((void)(mux), host_exit_critical())
+#define taskENTER_CRITICAL(mux)         ((void)(mux), host_enter_critical())
+#define taskEXIT_CRITICAL(mux)          ((void)(mux), host_exit_critical())
+
+#define portYIELD_FROM_ISR(...)         do { } while (0)
+
+#endif /* HOST_FREERTOS_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
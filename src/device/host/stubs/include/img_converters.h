@@ -0,0 +1,37 @@
+/*******************************************************************************
+ * @file        img_converters.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Host build stand-in for the esp32-camera image converters.
+ *              There is no JPEG decoder on the host: jpg2rgb565() samples the
+ *              compressed bytes into a gray image of the size last given to
+ *              host_camera_set_frame(), so identical frames decode identically
+ *              and different frames differ.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#ifndef HOST_IMG_CONVERTERS_H
+#define HOST_IMG_CONVERTERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_camera.h"
+
+typedef enum {
+    JPG_SCALE_NONE,
+    JPG_SCALE_2X,
+    JPG_SCALE_4X,
+    JPG_SCALE_8X,
+    JPG_SCALE_MAX = JPG_SCALE_8X
+} jpg_scale_t;
+
+// Writes (width >> scale) x (height >> scale) big endian RGB565 pixels to out
+bool jpg2rgb565(const uint8_t *src, size_t src_len, uint8_t *out, jpg_scale_t scale);
+
+#endif /* HOST_IMG_CONVERTERS_H */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
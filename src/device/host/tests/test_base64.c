@@ -0,0 +1,320 @@
+/*******************************************************************************
+ * @file        test_base64.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Equivalence test and benchmark of the base64 encoder and decoder:
+ *
+ *                test_base64 [<jpeg directory>]
+ *
+ *              base64_encode() and the chunked base64_encode_update()/final()
+ *              must give the output of the scalar encoder the firmware used
+ *              before the 12-byte block path, on random data of every length
+ *              from 0 to BASE64_TEST_MAX_LEN and on the JPEG files of the
+ *              directory. base64_decode() must give the input back. The
+ *              throughput of the old and the new encoder is printed.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include "base64/base64_utils.h"
+
+// Random inputs are checked at every length up to this one
+#define BASE64_TEST_MAX_LEN 2048
+
+// JPEG files read from the directory at most
+#define BASE64_TEST_MAX_FILES 64
+
+// Bytes encoded per benchmark run
+#define BASE64_BENCH_BYTES (64u << 20)
+
+static int failures = 0;
+
+// Encoder of the firmware before the block path, the reference output
+static const char reference_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static size_t reference_encode(const unsigned char *src, size_t src_len, char *dst)
+{
+    size_t i, j;
+
+    for (i = 0, j = 0; i < src_len; i += 3, j += 4) {
+        uint32_t octet_a = i < src_len ? src[i] : 0;
+        uint32_t octet_b = i + 1 < src_len ? src[i + 1] : 0;
+        uint32_t octet_c = i + 2 < src_len ? src[i + 2] : 0;
+
+        dst[j] = reference_table[(octet_a >> 2) & 0x3F];
+        dst[j + 1] = reference_table[((octet_a & 0x3) << 4) | ((octet_b >> 4) & 0xF)];
+        dst[j + 2] = i + 1 < src_len ? reference_table[((octet_b & 0xF) << 2) | ((octet_c >> 6) & 0x3F)] : '=';
+        dst[j + 3] = i + 2 < src_len ? reference_table[octet_c & 0x3F] : '=';
+    }
+
+    return j;
+}
+
+// Encode with base64_encode_update() in random chunks, returns the length written
+static size_t chunked_encode(const unsigned char *src, size_t src_len, char *dst)
+{
+    Base64EncodeCtx_t ctx;
+    size_t len = 0;
+
+    base64_encode_init(&ctx);
+    for (size_t offset = 0; offset < src_len;) {
+        size_t chunk = 1 + (size_t)rand() % 100;
+        if (chunk > src_len - offset) {
+            chunk = src_len - offset;
+        }
+        len += base64_encode_update(&ctx, src + offset, chunk, dst + len);
+        offset += chunk;
+    }
+    len += base64_encode_final(&ctx, dst + len);
+
+    return len;
+}
+
+// Check every entry point on one input, name identifies it in the report
+static void check_input(const char *name, const unsigned char *src, size_t src_len)
+{
+    size_t encoded_len = (src_len + 2) / 3 * 4;
+    char *expected = malloc(encoded_len + 1);
+    char *encoded = malloc(encoded_len + 1);
+    unsigned char *decoded = malloc(src_len + 1);
+
+    reference_encode(src, src_len, expected);
+
+    size_t len = encoded_len;
+    if (base64_encode(src, src_len, encoded, &len) != 0 || len != encoded_len ||
+        memcmp(encoded, expected, encoded_len) != 0) {
+        fprintf(stderr, "%s: base64_encode() differs from the reference\n", name);
+        failures++;
+    }
+
+    memset(encoded, 0, encoded_len);
+    if (chunked_encode(src, src_len, encoded) != encoded_len ||
+        memcmp(encoded, expected, encoded_len) != 0) {
+        fprintf(stderr, "%s: base64_encode_update() differs from the reference\n", name);
+        failures++;
+    }
+
+    len = src_len;
+    if (base64_decode(expected, encoded_len, decoded, &len) != 0 || len != src_len ||
+        memcmp(decoded, src, src_len) != 0) {
+        fprintf(stderr, "%s: base64_decode() does not give the input back\n", name);
+        failures++;
+    }
+
+    free(expected);
+    free(encoded);
+    free(decoded);
+}
+
+static void check_random(void)
+{
+    unsigned char *src = malloc(BASE64_TEST_MAX_LEN);
+    char name[32];
+
+    for (size_t len = 0; len <= BASE64_TEST_MAX_LEN; len++) {
+        for (size_t i = 0; i < len; i++) {
+            src[i] = (unsigned char)rand();
+        }
+        snprintf(name, sizeof(name), "random %zu", len);
+        check_input(name, src, len);
+    }
+
+    free(src);
+}
+
+static void check_decode_errors(void)
+{
+    unsigned char out[16];
+    const char *invalid[] = { "QUJD=", "QU*D", "QUJDRA=", "Q===", "QQ=A", "=QUJ", "QUJ\x80" };
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        size_t len = sizeof(out);
+        if (base64_decode(invalid[i], strlen(invalid[i]), out, &len) == 0) {
+            fprintf(stderr, "base64_decode() accepted \"%s\"\n", invalid[i]);
+            failures++;
+        }
+    }
+
+    // Too small a destination reports the length needed
+    size_t len = 2;
+    if (base64_decode("QUJD", 4, out, &len) != -1 || len != 3) {
+        fprintf(stderr, "base64_decode() did not report the length needed\n");
+        failures++;
+    }
+}
+
+static unsigned char *read_file(const char *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = size > 0 ? malloc((size_t)size) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    *len = data != NULL ? (size_t)size : 0;
+    return data;
+}
+
+// Check the JPEG files of a directory, returns the largest one for the benchmark
+static unsigned char *check_jpegs(const char *dir_path, size_t *largest_len)
+{
+    unsigned char *largest = NULL;
+    *largest_len = 0;
+
+    DIR *dir = opendir(dir_path);
+    if (dir == NULL) {
+        fprintf(stderr, "%s: cannot open the directory\n", dir_path);
+        failures++;
+        return NULL;
+    }
+
+    size_t files = 0;
+    struct dirent *entry;
+    while (files < BASE64_TEST_MAX_FILES && (entry = readdir(dir)) != NULL) {
+        const char *ext = strrchr(entry->d_name, '.');
+        if (ext == NULL || (strcmp(ext, ".jpg") != 0 && strcmp(ext, ".jpeg") != 0)) {
+            continue;
+        }
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+        size_t len;
+        unsigned char *data = read_file(path, &len);
+        if (data == NULL) {
+            continue;
+        }
+
+        check_input(entry->d_name, data, len);
+        files++;
+
+        if (len > *largest_len) {
+            free(largest);
+            largest = data;
+            *largest_len = len;
+        } else {
+            free(data);
+        }
+    }
+    closedir(dir);
+
+    if (files == 0) {
+        fprintf(stderr, "%s: no JPEG file\n", dir_path);
+        failures++;
+    }
+    printf("%zu JPEG files checked\n", files);
+    return largest;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Print the encoding throughput of the reference and of the current encoder
+static void benchmark(const unsigned char *src, size_t src_len)
+{
+    size_t encoded_len = (src_len + 2) / 3 * 4;
+    char *dst = malloc(encoded_len);
+    unsigned char *decoded = malloc(src_len);
+    size_t runs = BASE64_BENCH_BYTES / src_len + 1;
+    double mb = (double)runs * src_len / (1 << 20);
+    volatile char sink = 0;
+
+    double start = now_s();
+    for (size_t r = 0; r < runs; r++) {
+        reference_encode(src, src_len, dst);
+        sink ^= dst[r % encoded_len];
+    }
+    double reference_s = now_s() - start;
+
+    start = now_s();
+    for (size_t r = 0; r < runs; r++) {
+        size_t len = encoded_len;
+        base64_encode(src, src_len, dst, &len);
+        sink ^= dst[r % encoded_len];
+    }
+    double encode_s = now_s() - start;
+
+    // Chunked as /image64 does it
+    start = now_s();
+    for (size_t r = 0; r < runs; r++) {
+        Base64EncodeCtx_t ctx;
+        size_t len = 0;
+        base64_encode_init(&ctx);
+        for (size_t offset = 0; offset < src_len; offset += BASE64_CHUNK_SIZE) {
+            size_t chunk = src_len - offset < BASE64_CHUNK_SIZE ? src_len - offset : BASE64_CHUNK_SIZE;
+            len += base64_encode_update(&ctx, src + offset, chunk, dst + len);
+        }
+        base64_encode_final(&ctx, dst + len);
+        sink ^= dst[r % encoded_len];
+    }
+    double update_s = now_s() - start;
+
+    start = now_s();
+    for (size_t r = 0; r < runs; r++) {
+        size_t len = src_len;
+        base64_decode(dst, encoded_len, decoded, &len);
+        sink ^= (char)decoded[r % src_len];
+    }
+    double decode_s = now_s() - start;
+    (void)sink;
+
+    printf("%zu byte input, %.0f MB per run\n", src_len, mb);
+    printf("  reference encoder  %8.1f MB/s\n", mb / reference_s);
+    printf("  base64_encode      %8.1f MB/s  (%.2fx)\n", mb / encode_s, reference_s / encode_s);
+    printf("  base64_encode_update %6.1f MB/s  (%.2fx)\n", mb / update_s, reference_s / update_s);
+    printf("  base64_decode      %8.1f MB/s\n", mb / decode_s);
+
+    free(dst);
+    free(decoded);
+}
+
+int main(int argc, char **argv)
+{
+    srand(1);
+
+    check_random();
+    check_decode_errors();
+
+    size_t bench_len = 0;
+    unsigned char *bench = argc > 1 ? check_jpegs(argv[1], &bench_len) : NULL;
+    if (bench == NULL) {
+        // No image, benchmark on a VGA sized random frame
+        bench_len = 48 * 1024;
+        bench = malloc(bench_len);
+        for (size_t i = 0; i < bench_len; i++) {
+            bench[i] = (unsigned char)rand();
+        }
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        free(bench);
+        return 1;
+    }
+    printf("base64: all checks passed\n");
+
+    benchmark(bench, bench_len);
+    free(bench);
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,247 @@
+/*******************************************************************************
+ * @file        test_http_handlers.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Regression test of the HTTP request handlers.
+ *              The handlers are registered on the esp_http_server stand-in and
+ *              requests are dispatched to them in memory. The JSON replies are
+ *              parsed back and checked field by field.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "http_handlers/http_handlers.h"
+
+// Defined in main.c on the device
+UserRole authenticatedUserRole;
+
+static int failures = 0;
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static httpd_handle_t server;
+
+// Dispatch a request with the given role header (NULL for none) and body
+static esp_err_t request(httpd_req_t *req, httpd_method_t method, const char *uri,
+                         const char *role, const char *body)
+{
+    host_httpd_req_init(req, method, uri);
+    if (role != NULL) {
+        host_httpd_req_add_header(req, "X-User-Role", role);
+    }
+    if (body != NULL) {
+        host_httpd_req_set_body(req, body, strlen(body));
+    }
+    return host_httpd_dispatch(server, req);
+}
+
+// Parse the captured reply, NULL if it is not JSON
+static cJSON *reply_json(httpd_req_t *req)
+{
+    char *text = malloc(req->host_resp_len + 1);
+    memcpy(text, req->host_resp, req->host_resp_len);
+    text[req->host_resp_len] = '\0';
+    cJSON *json = cJSON_Parse(text);
+    free(text);
+    return json;
+}
+
+static void register_handler(const char *uri, httpd_method_t method, esp_err_t (*handler)(httpd_req_t *))
+{
+    httpd_uri_t handler_uri = { .uri = uri, .method = method, .handler = handler };
+    CHECK(httpd_register_uri_handler(server, &handler_uri) == ESP_OK);
+}
+
+static void test_state(void)
+{
+    httpd_req_t req;
+
+    CHECK(request(&req, HTTP_GET, "/state", NULL, NULL) == ESP_OK);
+    CHECK(strcmp(req.host_status, "401 Unauthorized") == 0);
+    host_httpd_req_free(&req);
+
+    CHECK(request(&req, HTTP_GET, "/state", "user", NULL) == ESP_OK);
+    CHECK(strcmp(req.host_status, "200 OK") == 0);
+    CHECK(strcmp(req.host_content_type, "application/json") == 0);
+    cJSON *json = reply_json(&req);
+    CHECK(json != NULL);
+    cJSON *sensors = cJSON_GetObjectItem(json, "sensors");
+    CHECK(cJSON_IsNumber(cJSON_GetObjectItem(sensors, "pir")));
+    CHECK(cJSON_IsNumber(cJSON_GetObjectItem(sensors, "smoke")));
+    cJSON *motors = cJSON_GetObjectItem(json, "motors");
+    CHECK(cJSON_IsBool(cJSON_GetObjectItem(cJSON_GetObjectItem(motors, "1"), "active")));
+    cJSON_Delete(json);
+    host_httpd_req_free(&req);
+}
+
+static void test_status(void)
+{
+    httpd_req_t req;
+
+    CHECK(request(&req, HTTP_GET, "/status", "user", NULL) == ESP_OK);
+    cJSON *json = reply_json(&req);
+    CHECK(json != NULL);
+    cJSON *status = cJSON_GetObjectItem(json, "status");
+    CHECK(status != NULL && status->valuestring != NULL && strcmp(status->valuestring, "online") == 0);
+    cJSON *frame_control = cJSON_GetObjectItem(json, "frame_control");
+    CHECK(cJSON_IsNumber(cJSON_GetObjectItem(frame_control, "target_ms")));
+    CHECK(cJSON_GetObjectItem(frame_control, "target_ms")->valueint == FRAME_CONTROL_TARGET_MS);
+    cJSON_Delete(json);
+    host_httpd_req_free(&req);
+}
+
+static void test_patrol(void)
+{
+    httpd_req_t req;
+
+    // Only admins may change the presets
+    request(&req, HTTP_POST, "/patrol", "user", "{\"presets\":[]}");
+    CHECK(strcmp(req.host_status, "401 Unauthorized") == 0);
+    host_httpd_req_free(&req);
+
+    request(&req, HTTP_POST, "/patrol", "admin", "{\"presets\":[{\"pan\":10}");
+    CHECK(strcmp(req.host_status, "400 Bad Request") == 0);
+    host_httpd_req_free(&req);
+
+    request(&req, HTTP_POST, "/patrol", "admin", "{\"presets\":[{\"pan\":200,\"tilt\":0,\"dwell_ms\":0}]}");
+    CHECK(strcmp(req.host_status, "400 Bad Request") == 0);
+    host_httpd_req_free(&req);
+
+    request(&req, HTTP_POST, "/patrol", "admin",
+            "{\"presets\":[{\"pan\":45.5,\"tilt\":90,\"dwell_ms\":1500,\"capture\":true},"
+            "{\"pan\":120,\"tilt\":30,\"dwell_ms\":500}]}");
+    CHECK(strcmp(req.host_status, "200 OK") == 0);
+    host_httpd_req_free(&req);
+
+    // The list reads back as it was set
+    request(&req, HTTP_GET, "/patrol", "user", NULL);
+    cJSON *json = reply_json(&req);
+    cJSON *list = cJSON_GetObjectItem(json, "presets");
+    CHECK(cJSON_GetArraySize(list) == 2);
+    cJSON *first = cJSON_GetArrayItem(list, 0);
+    CHECK(cJSON_IsNumber(cJSON_GetObjectItem(first, "pan")) && cJSON_GetObjectItem(first, "pan")->valuedouble == 45.5);
+    CHECK(cJSON_IsNumber(cJSON_GetObjectItem(first, "dwell_ms")) && cJSON_GetObjectItem(first, "dwell_ms")->valueint == 1500);
+    CHECK(cJSON_IsTrue(cJSON_GetObjectItem(first, "capture")));
+    CHECK(!cJSON_IsTrue(cJSON_GetObjectItem(cJSON_GetArrayItem(list, 1), "capture")));
+    cJSON_Delete(json);
+    host_httpd_req_free(&req);
+}
+
+static void test_image_roi(void)
+{
+    httpd_req_t req;
+
+    // Rejected before the camera is touched
+    const char *bad[] = {
+        "/image?roi=1,2",
+        "/image?roi=0,0,100,x",
+        "/image?roi=1500,0,200,100",
+        "/image?roi=0,0,1600,1200&scale=1",
+        "/image?roi=0,0,400,300&scale=9",
+        "/image?roi=0,0,64,64&scale=2",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        request(&req, HTTP_GET, bad[i], "user", NULL);
+        if (strcmp(req.host_status, "400 Bad Request") != 0) {
+            fprintf(stderr, "%s: %s\n", bad[i], req.host_status);
+            failures++;
+        }
+        host_httpd_req_free(&req);
+    }
+}
+
+// Fetch /history with the given query, returns the parsed reply
+static cJSON *history(const char *uri)
+{
+    httpd_req_t req;
+    CHECK(request(&req, HTTP_GET, uri, "user", NULL) == ESP_OK);
+    CHECK(strcmp(req.host_status, "200 OK") == 0);
+    cJSON *json = reply_json(&req);
+    CHECK(json != NULL);
+    host_httpd_req_free(&req);
+    return json;
+}
+
+static void test_history(void)
+{
+    char uri[64];
+    uint32_t head = history_head(&sensorHistory);
+
+    // Records in the same millisecond all come back, once
+    for (int i = 0; i < 3; i++) {
+        history_push(&sensorHistory, HISTORY_PIR, 0, (uint16_t)(i & 1));
+    }
+    history_push(&motorHistory, HISTORY_MOTOR, 1, 900);
+
+    cJSON *json = history("/history");
+    CHECK(cJSON_GetArraySize(cJSON_GetObjectItem(json, "sensors")) == (int)(head + 3));
+    CHECK(cJSON_GetArraySize(cJSON_GetObjectItem(json, "motors")) == 1);
+    cJSON *next = cJSON_GetObjectItem(json, "next");
+    CHECK(cJSON_IsNumber(cJSON_GetObjectItem(next, "sensors")));
+    int sensors = cJSON_GetObjectItem(next, "sensors")->valueint;
+    int motors = cJSON_GetObjectItem(next, "motors")->valueint;
+    CHECK(sensors == (int)(head + 3) && motors == 1);
+    cJSON_Delete(json);
+
+    history_push(&sensorHistory, HISTORY_SMOKE, 0, 1);
+    history_push(&sensorHistory, HISTORY_SMOKE, 0, 0);
+    snprintf(uri, sizeof(uri), "/history?sensors=%d&motors=%d", sensors, motors);
+    json = history(uri);
+    cJSON *list = cJSON_GetObjectItem(json, "sensors");
+    CHECK(cJSON_GetArraySize(list) == 2);
+    CHECK(cJSON_GetArraySize(cJSON_GetObjectItem(json, "motors")) == 0);
+    cJSON *entry = cJSON_GetArrayItem(list, 0);
+    CHECK(strcmp(cJSON_GetArrayItem(entry, 1)->valuestring, "smoke") == 0);
+    CHECK(cJSON_GetArrayItem(entry, 2)->valueint == 1);
+    CHECK(cJSON_GetObjectItem(cJSON_GetObjectItem(json, "next"), "sensors")->valueint == sensors + 2);
+    cJSON_Delete(json);
+
+    // A cursor from before a reboot starts over
+    json = history("/history?sensors=100000&motors=100000");
+    CHECK(cJSON_GetArraySize(cJSON_GetObjectItem(json, "sensors")) == (int)(head + 5));
+    CHECK(cJSON_GetArraySize(cJSON_GetObjectItem(json, "motors")) == 1);
+    cJSON_Delete(json);
+}
+
+int main(void)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_uri_handlers = 16;
+    CHECK(httpd_start(&server, &config) == ESP_OK);
+    CHECK(init_patrol() == ESP_OK);
+
+    register_handler("/state", HTTP_GET, state_httpd_handler);
+    register_handler("/status", HTTP_GET, status_httpd_handler);
+    register_handler("/patrol", HTTP_GET, patrol_get_httpd_handler);
+    register_handler("/patrol", HTTP_POST, patrol_set_httpd_handler);
+    register_handler("/image", HTTP_GET, image_httpd_handler);
+    register_handler("/history", HTTP_GET, history_httpd_handler);
+
+    test_state();
+    test_status();
+    test_patrol();
+    test_image_roi();
+    test_history();
+
+    httpd_stop(server);
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("http handlers: all checks passed\n");
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,215 @@
+/*******************************************************************************
+ * @file        test_jpeg_dc.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Regression test of the 1/8 scale DC decoder:
+ *
+ *                test_jpeg_dc <jpeg directory>
+ *
+ *              A person detection JPEG must decode to the luma libjpeg gives
+ *              at scale 1/8 (its 1x1 IDCT is the block DC), recorded below as
+ *              a hash of the image. Malformed Huffman tables and truncated
+ *              frames must be rejected without writing outside the decoder.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jpeg_dc/jpeg_dc.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+// Luma of the reference frame from libjpeg, scale 1/8, JCS_GRAYSCALE, JDCT_ISLOW
+#define REFERENCE_FILE "image_20230620223716.jpg"
+#define REFERENCE_WIDTH 80
+#define REFERENCE_HEIGHT 60
+#define REFERENCE_SUM 613003u
+#define REFERENCE_FNV 0x06c1bf84u
+
+// Bytes checked after the decoder for stray writes
+#define GUARD_SIZE (64 * 1024)
+#define GUARD_BYTE 0xA5
+
+static unsigned char *read_file(const char *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = size > 0 ? malloc((size_t)size) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    *len = data != NULL ? (size_t)size : 0;
+    return data;
+}
+
+// Decoder followed by a guard area, so writes past it are seen without ASan
+static JpegDcDecoder_t *guarded_decoder(void)
+{
+    unsigned char *block = malloc(sizeof(JpegDcDecoder_t) + GUARD_SIZE);
+    memset(block + sizeof(JpegDcDecoder_t), GUARD_BYTE, GUARD_SIZE);
+    return (JpegDcDecoder_t *)block;
+}
+
+static bool guard_intact(const JpegDcDecoder_t *decoder)
+{
+    const unsigned char *guard = (const unsigned char *)decoder + sizeof(JpegDcDecoder_t);
+    for (size_t i = 0; i < GUARD_SIZE; i++) {
+        if (guard[i] != GUARD_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A stream with a single DHT segment of the given code counts, every symbol 0
+static size_t dht_stream(uint8_t *out, const uint8_t counts[16])
+{
+    size_t total = 0;
+    for (int i = 0; i < 16; i++) {
+        total += counts[i];
+    }
+
+    size_t segment_len = 2 + 1 + 16 + total;
+    size_t len = 0;
+    out[len++] = 0xFF;
+    out[len++] = 0xD8;
+    out[len++] = 0xFF;
+    out[len++] = 0xC4;
+    out[len++] = (uint8_t)(segment_len >> 8);
+    out[len++] = (uint8_t)segment_len;
+    out[len++] = 0x00;              // DC table 0
+    memcpy(out + len, counts, 16);
+    len += 16;
+    memset(out + len, 0, total);
+    len += total;
+    out[len++] = 0xFF;
+    out[len++] = 0xD9;
+    return len;
+}
+
+static void check_malformed_dht(void)
+{
+    static uint8_t stream[512];
+    uint8_t luma[16];
+    JpegDcImage_t image = { .luma = luma, .capacity = sizeof(luma) };
+    JpegDcDecoder_t *decoder = guarded_decoder();
+
+    // 200 one bit codes, only two exist
+    uint8_t one_bit[16] = { 200 };
+    // Two one bit codes leave no room for a two bit one
+    uint8_t two_bit[16] = { 2, 1 };
+    // One code of each length up to 8 leaves two 9 bit codes, not three
+    uint8_t nine_bit[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 3 };
+
+    const uint8_t *invalid[] = { one_bit, two_bit, nine_bit };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        size_t len = dht_stream(stream, invalid[i]);
+        if (jpeg_dc_decode(decoder, stream, len, &image) != ESP_ERR_INVALID_ARG) {
+            fprintf(stderr, "malformed DHT %zu was accepted\n", i);
+            failures++;
+        }
+        CHECK(guard_intact(decoder));
+    }
+
+    // A complete code, no frame follows so the stream itself is still invalid
+    uint8_t complete[16] = { 0, 2, 2 };
+    size_t len = dht_stream(stream, complete);
+    CHECK(jpeg_dc_decode(decoder, stream, len, &image) == ESP_ERR_INVALID_ARG);
+    CHECK(decoder->dc[0].defined);
+    CHECK(guard_intact(decoder));
+
+    free(decoder);
+}
+
+static void check_reference(const char *dir_path)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir_path, REFERENCE_FILE);
+    size_t len;
+    unsigned char *jpg = read_file(path, &len);
+    if (jpg == NULL) {
+        fprintf(stderr, "%s: cannot read the file\n", path);
+        failures++;
+        return;
+    }
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    CHECK(jpeg_dc_get_size(jpg, len, &width, &height) == ESP_OK);
+    CHECK(width == REFERENCE_WIDTH && height == REFERENCE_HEIGHT);
+
+    static uint8_t luma[REFERENCE_WIDTH * REFERENCE_HEIGHT];
+    static uint8_t saturation[REFERENCE_WIDTH * REFERENCE_HEIGHT];
+    JpegDcDecoder_t *decoder = guarded_decoder();
+
+    // Too small buffers are reported, not written past
+    JpegDcImage_t image = { .luma = luma, .saturation = saturation, .capacity = sizeof(luma) - 1 };
+    CHECK(jpeg_dc_decode(decoder, jpg, len, &image) == ESP_ERR_INVALID_SIZE);
+
+    image.capacity = sizeof(luma);
+    CHECK(jpeg_dc_decode(decoder, jpg, len, &image) == ESP_OK);
+    CHECK(image.width == REFERENCE_WIDTH && image.height == REFERENCE_HEIGHT);
+
+    uint32_t sum = 0;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(luma); i++) {
+        sum += luma[i];
+        hash = (hash ^ luma[i]) * 16777619u;
+    }
+    if (sum != REFERENCE_SUM || hash != REFERENCE_FNV) {
+        fprintf(stderr, "%s: luma sum %u hash %08x, libjpeg gives %u %08x\n", REFERENCE_FILE,
+                (unsigned)sum, (unsigned)hash, REFERENCE_SUM, REFERENCE_FNV);
+        failures++;
+    }
+
+    // Every truncation is rejected or decodes, never overruns
+    for (size_t cut = 2; cut < len; cut += 97) {
+        esp_err_t err = jpeg_dc_decode(decoder, jpg, cut, &image);
+        CHECK(err == ESP_OK || err == ESP_ERR_INVALID_ARG);
+    }
+    CHECK(guard_intact(decoder));
+
+    free(decoder);
+    free(jpg);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <jpeg directory>\n", argv[0]);
+        return 1;
+    }
+
+    check_malformed_dht();
+    check_reference(argv[1]);
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("jpeg_dc: all checks passed\n");
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,204 @@
+/*******************************************************************************
+ * @file        test_log_codec.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Regression test of the binary log records.
+ *              Catalog formats are encoded through a va_list, as esp_log_write()
+ *              passes them to the log sink, and the decoded text must be what
+ *              vsnprintf() prints from the same arguments. Lines outside the
+ *              catalog, and lines whose record does not fit a log sink slot,
+ *              must be left to the text path with their arguments untouched.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "log_codec/log_codec.h"
+#include "log_sink/log_sink.h"
+#include "log_catalog.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+// ESP_LOGx() formats, as LOG_FORMAT() builds them with and without colors
+#define PLAIN_LINE(letter, format) #letter " (%u) %s: " format "\n"
+#define COLOR_LINE(color, letter, format) "\033[0;" #color "m" #letter " (%u) %s: " format "\033[0m\n"
+
+// Catalog format with integer, unsigned long and %.2f arguments
+#define DUTY_FORMAT "Actual motor duty cycle for speed mode %d and channel %d: %lu Angle: %.2f Duty: %lu"
+
+static bool in_catalog(const char *format)
+{
+    for (int i = 0; i < LOG_CATALOG_FORMAT_COUNT; i++) {
+        if (strcmp(log_catalog_formats[i], format) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Encodes a line into a log sink slot the way log_sink does, and prints text_fmt
+// from the arguments left for the text path
+static size_t encode_line(uint8_t slot[LOG_SINK_LINE_MAX], char *expected, size_t max,
+                          const char *fmt, const char *text_fmt, va_list args)
+{
+    size_t len = log_codec_encode(slot, LOG_SINK_LINE_MAX, fmt, args);
+    vsnprintf(expected, max, text_fmt, args);
+    return len;
+}
+
+/*
+ * Compares the decoded record of a line with vsnprintf() of text_fmt.
+ * Returns the record length, 0 when the line is left to the text path.
+ */
+static size_t check_line(const char *fmt, const char *text_fmt, ...)
+{
+    uint8_t slot[LOG_SINK_LINE_MAX];
+    char expected[512];
+    char decoded[512];
+    va_list args;
+
+    va_start(args, text_fmt);
+    size_t len = encode_line(slot, expected, sizeof(expected), fmt, text_fmt, args);
+    va_end(args);
+
+    if (len == 0) {
+        return 0;
+    }
+    CHECK(slot[0] == LOG_CODEC_MARKER);
+
+    size_t consumed = log_codec_decode(slot, len, decoded, sizeof(decoded));
+    if (consumed != len || strcmp(decoded, expected) != 0) {
+        fprintf(stderr, "decoded %zu of %zu bytes as \"%s\", vsnprintf gives \"%s\"\n", consumed, len,
+                decoded, expected);
+        failures++;
+    }
+
+    // A cut record is incomplete, not misread
+    CHECK(log_codec_decode(slot, len - 1, decoded, sizeof(decoded)) == 0);
+    return len;
+}
+
+// Line whose decoded text must be the start of what vsnprintf() prints
+static size_t check_cut_line(const char *fmt, ...)
+{
+    uint8_t slot[LOG_SINK_LINE_MAX];
+    char expected[512];
+    char decoded[512];
+    va_list args;
+
+    va_start(args, fmt);
+    size_t len = encode_line(slot, expected, sizeof(expected), fmt, fmt, args);
+    va_end(args);
+
+    if (len > 0) {
+        CHECK(log_codec_decode(slot, len, decoded, sizeof(decoded)) == len);
+        size_t text = strlen(decoded) - 1;
+        CHECK(text < strlen(expected) && strncmp(decoded, expected, text) == 0);
+        CHECK(decoded[text] == '\n');
+    }
+    return len;
+}
+
+static void check_catalog_lines(void)
+{
+    const char *const formats[] = {
+        "Camera capture failed",
+        "Classification failed: %s",
+        "Invalid LDR state: %d",
+        DUTY_FORMAT,
+    };
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        if (!in_catalog(formats[i])) {
+            fprintf(stderr, "\"%s\" is no longer in the log catalog\n", formats[i]);
+            failures++;
+        }
+    }
+
+    // Plain and colored, the decoded text has no colors
+    CHECK(check_line(PLAIN_LINE(E, "Camera capture failed"), PLAIN_LINE(E, "Camera capture failed"),
+                     1234u, "Camera") > 0);
+    CHECK(check_line(COLOR_LINE(31, E, "Camera capture failed"), PLAIN_LINE(E, "Camera capture failed"),
+                     4000000000u, "Camera") > 0);
+
+    CHECK(check_line(COLOR_LINE(33, W, "Classification failed: %s"), PLAIN_LINE(W, "Classification failed: %s"),
+                     77u, "Classifier Log", "ESP_ERR_NO_MEM") > 0);
+    CHECK(check_line(PLAIN_LINE(W, "Classification failed: %s"), PLAIN_LINE(W, "Classification failed: %s"),
+                     78u, "Classifier Log", "") > 0);
+
+    CHECK(check_line(COLOR_LINE(31, E, "Invalid LDR state: %d"), PLAIN_LINE(E, "Invalid LDR state: %d"),
+                     5u, "GPIO Log", -7) > 0);
+    CHECK(check_line(PLAIN_LINE(E, "Invalid LDR state: %d"), PLAIN_LINE(E, "Invalid LDR state: %d"),
+                     6u, "GPIO Log", INT32_MIN) > 0);
+
+    CHECK(check_line(COLOR_LINE(32, I, DUTY_FORMAT), PLAIN_LINE(I, DUTY_FORMAT),
+                     99u, "Motor Log", 0, 1, 409lu, 90.125, 410lu) > 0);
+    CHECK(check_line(PLAIN_LINE(I, DUTY_FORMAT), PLAIN_LINE(I, DUTY_FORMAT),
+                     100u, "Motor Log", 1, 0, 0lu, -0.004, 4095lu) > 0);
+}
+
+static void check_text_fallback(void)
+{
+    char text[600];
+
+    // Not in the catalog, or not an ESP_LOGx() line
+    CHECK(check_line(PLAIN_LINE(I, "Not a catalog format %d"), PLAIN_LINE(I, "Not a catalog format %d"),
+                     1u, "Camera", 3) == 0);
+    CHECK(check_line("free text %d\n", "free text %d\n", 3) == 0);
+    // Tag outside the catalog
+    CHECK(check_line(PLAIN_LINE(E, "Camera capture failed"), PLAIN_LINE(E, "Camera capture failed"),
+                     1u, "Unknown tag") == 0);
+
+    // The first string fills the slot, the second no longer fits
+    memset(text, 'a', 300);
+    text[300] = '\0';
+    const char *two_strings = PLAIN_LINE(E, "%s enable bluedroid failed: %s\n");
+    CHECK(in_catalog("%s enable bluedroid failed: %s\n"));
+    CHECK(check_line(two_strings, two_strings, 1u, "Bluetooth Log", text, "ESP_FAIL") == 0);
+    CHECK(check_line(two_strings, two_strings, 1u, "Bluetooth Log", "BT", "ESP_FAIL") > 0);
+
+    // The longest integer arguments still fit, the text of the double would not
+    CHECK(check_line(PLAIN_LINE(I, DUTY_FORMAT), PLAIN_LINE(I, DUTY_FORMAT),
+                     UINT32_MAX, "Motor Log", INT32_MIN, INT32_MIN, ULONG_MAX, 1e300, ULONG_MAX) > 0);
+}
+
+// A trailing string longer than the slot is cut, as the text line would be
+static void check_long_string(void)
+{
+    char text[300];
+    memset(text, 'b', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    const char *fmt = PLAIN_LINE(W, "Classification failed: %s");
+    CHECK(check_cut_line(fmt, 12u, "Classifier Log", text) == LOG_SINK_LINE_MAX);
+}
+
+int main(void)
+{
+    init_log_codec();
+
+    check_catalog_lines();
+    check_text_fallback();
+    check_long_string();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("log codec: all checks passed\n");
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,170 @@
+/*******************************************************************************
+ * @file        test_motor_duty.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Regression test of the motor duty tables.
+ *              Every entry of the tables built by calibrate_motor() is compared
+ *              with the float calculate_duty() formula, for the configured
+ *              motors and for calibrations with non-zero offsets. The 0 and
+ *              SERVO_MAX_ANGLE endpoints are checked on the LEDC stand-in.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "motor_control/motor_control.h"
+
+// Defined in motor_control.c, built by initialize_motors()
+extern Motor motor1;
+extern Motor motor2;
+
+static int failures = 0;
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+// calculate_duty() with the pulse widths of a calibrated motor
+static uint32_t calibrated_duty(float angle, int16_t min_offset_us, int16_t max_offset_us)
+{
+    float min_us = SERVO_WIDTH_MIN_US + min_offset_us;
+    float max_us = SERVO_WIDTH_MAX_US + max_offset_us;
+    float width_us = min_us + ((max_us - min_us) * angle) / SERVO_MAX_ANGLE;
+    return (uint32_t)(width_us * (1 << PWM_RESOLUTION) / PWM_PERIOD_US + 0.5f);
+}
+
+// Exact duty of a pulse width in microseconds, rounded to nearest
+static uint32_t width_duty(int32_t width_us)
+{
+    return (uint32_t)(((int64_t)width_us * (1 << PWM_RESOLUTION) + PWM_PERIOD_US / 2) / PWM_PERIOD_US);
+}
+
+// Compare all the entries of a motor table with the float formula
+static void check_table(const char *name, const Motor *motor)
+{
+    int mismatches = 0;
+
+    for (int i = 0; i < MOTOR_DUTY_TABLE_SIZE; i++) {
+        uint32_t expected = calibrated_duty(i / 10.0f, motor->min_offset_us, motor->max_offset_us);
+        uint32_t duty = motor_duty(motor, (uint16_t)i);
+        if (duty != expected) {
+            fprintf(stderr, "%s: %d tenths: duty %u, formula %u\n", name, i,
+                    (unsigned)duty, (unsigned)expected);
+            mismatches++;
+        }
+    }
+    failures += mismatches;
+
+    // The endpoints are exact
+    CHECK(motor_duty(motor, 0) == width_duty(SERVO_WIDTH_MIN_US + motor->min_offset_us));
+    CHECK(motor_duty(motor, MOTOR_DUTY_TABLE_SIZE - 1) == width_duty(SERVO_WIDTH_MAX_US + motor->max_offset_us));
+    // Out of range angles read the SERVO_MAX_ANGLE entry
+    CHECK(motor_duty(motor, MOTOR_DUTY_TABLE_SIZE) == motor_duty(motor, MOTOR_DUTY_TABLE_SIZE - 1));
+
+    // Duties never decrease with the angle
+    for (int i = 1; i < MOTOR_DUTY_TABLE_SIZE; i++) {
+        if (motor_duty(motor, (uint16_t)i) < motor_duty(motor, (uint16_t)(i - 1))) {
+            fprintf(stderr, "%s: duty decreases at %d tenths\n", name, i);
+            failures++;
+            break;
+        }
+    }
+
+    printf("%s: %d entries checked, %d mismatches\n", name, MOTOR_DUTY_TABLE_SIZE, mismatches);
+}
+
+// The duty written to the LEDC channel of a motor moved to an angle
+static uint32_t moved_duty(const Motor *motor, float angle)
+{
+    CHECK(move_motor(motor, angle) == ESP_OK);
+    return ledc_get_duty(motor->speed_mode, (ledc_channel_t)motor->channel);
+}
+
+static void check_endpoints(const char *name, const Motor *motor)
+{
+    uint32_t min_duty = width_duty(SERVO_WIDTH_MIN_US + motor->min_offset_us);
+    uint32_t max_duty = width_duty(SERVO_WIDTH_MAX_US + motor->max_offset_us);
+
+    if (moved_duty(motor, 0.0f) != min_duty || moved_duty(motor, 0.04f) != min_duty ||
+        moved_duty(motor, SERVO_MAX_ANGLE) != max_duty || moved_duty(motor, 179.96f) != max_duty ||
+        moved_duty(motor, SERVO_MAX_ANGLE + 20.0f) != max_duty) {
+        fprintf(stderr, "%s: endpoint duties are not %u and %u\n", name, (unsigned)min_duty, (unsigned)max_duty);
+        failures++;
+    }
+    CHECK(move_motor(motor, -1.0f) == ESP_ERR_INVALID_ARG);
+}
+
+static void check_configured_motors(void)
+{
+    initialize_motors();
+
+    // Without offsets the tables are calculate_duty() itself
+    CHECK(motor1.min_offset_us == MOTOR_1_MIN_OFFSET_US && motor1.max_offset_us == MOTOR_1_MAX_OFFSET_US);
+    CHECK(motor2.min_offset_us == MOTOR_2_MIN_OFFSET_US && motor2.max_offset_us == MOTOR_2_MAX_OFFSET_US);
+    if (MOTOR_1_MIN_OFFSET_US == 0 && MOTOR_1_MAX_OFFSET_US == 0) {
+        for (int i = 0; i < MOTOR_DUTY_TABLE_SIZE; i++) {
+            CHECK(calibrated_duty(i / 10.0f, 0, 0) == calculate_duty(i / 10.0f));
+        }
+    }
+
+    check_table("motor 1", &motor1);
+    check_table("motor 2", &motor2);
+    check_endpoints("motor 1", &motor1);
+    check_endpoints("motor 2", &motor2);
+}
+
+static void check_calibrations(void)
+{
+    static uint16_t table[MOTOR_DUTY_TABLE_SIZE];
+    static uint16_t saved[MOTOR_DUTY_TABLE_SIZE];
+    const int16_t offsets[][2] = {
+        { 30, -45 },
+        { -100, 150 },
+        { 17, 23 },
+        { -499, 0 },
+        { 0, 17000 },
+    };
+    char name[48];
+
+    Motor motor = create_motor(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2);
+    CHECK(calibrate_motor(&motor, 0, 0) == ESP_ERR_INVALID_STATE);
+    motor.duty_table = table;
+
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        snprintf(name, sizeof(name), "offsets %+d/%+d us", offsets[i][0], offsets[i][1]);
+        CHECK(calibrate_motor(&motor, offsets[i][0], offsets[i][1]) == ESP_OK);
+        check_table(name, &motor);
+        check_endpoints(name, &motor);
+    }
+
+    // Rejected calibrations leave the table as it was
+    memcpy(saved, table, sizeof(saved));
+    CHECK(calibrate_motor(&motor, -500, 0) == ESP_ERR_INVALID_ARG);
+    CHECK(calibrate_motor(&motor, 0, PWM_PERIOD_US - SERVO_WIDTH_MAX_US) == ESP_ERR_INVALID_ARG);
+    CHECK(calibrate_motor(&motor, 1000, -1000) == ESP_ERR_INVALID_ARG);
+    CHECK(memcmp(saved, table, sizeof(saved)) == 0);
+    CHECK(motor.min_offset_us == 0 && motor.max_offset_us == 17000);
+}
+
+int main(void)
+{
+    check_configured_motors();
+    check_calibrations();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("motor duty: all checks passed\n");
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
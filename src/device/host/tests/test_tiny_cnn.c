@@ -0,0 +1,517 @@
+/*******************************************************************************
+ * @file        test_tiny_cnn.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Regression test of the int8 inference engine.
+ *              A TCNN model is built in memory with fixed pseudo random int8
+ *              weights: a stride 2 SAME convolution, a SAME depthwise
+ *              convolution, SAME average and max pools, a global average and
+ *              a fully connected layer. Every layer output is compared with a
+ *              plain reference computation that visits each kernel tap with
+ *              TensorFlow padding and requantizes as TensorFlow Lite does.
+ *              Requantization ties and tiny_cnn_load() errors are checked
+ *              against fixed expectations.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tiny_cnn/tiny_cnn.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+// Largest model and tensor built by the test
+#define MODEL_MAX_BYTES 4096
+#define TENSOR_MAX 256
+
+/******************************** Model builder *******************************/
+
+typedef struct {
+    uint32_t words[MODEL_MAX_BYTES / 4];     // 4 byte aligned storage
+    size_t size;
+} ModelBuffer_t;
+
+// One layer with its parameters, kept for the reference computation
+typedef struct {
+    TinyCnnLayer_t record;
+    int8_t weights[TENSOR_MAX * 4];
+    size_t weightCount;
+    int32_t bias[TENSOR_MAX];
+    int32_t multiplier[TENSOR_MAX];
+    int32_t shift[TENSOR_MAX];
+} TestLayer_t;
+
+static void append(ModelBuffer_t *model, const void *data, size_t len)
+{
+    memcpy((uint8_t *)model->words + model->size, data, len);
+    model->size += len;
+}
+
+static void append_layer(ModelBuffer_t *model, const TestLayer_t *layer)
+{
+    static const uint8_t zeros[4] = { 0 };
+    append(model, &layer->record, sizeof(layer->record));
+
+    if (layer->record.type == TINY_CNN_AVG_POOL || layer->record.type == TINY_CNN_MAX_POOL) {
+        return;
+    }
+    append(model, layer->weights, layer->weightCount);
+    append(model, zeros, (4 - layer->weightCount % 4) % 4);
+    append(model, layer->bias, layer->record.outputChannels * sizeof(int32_t));
+    append(model, layer->multiplier, layer->record.outputChannels * sizeof(int32_t));
+    append(model, layer->shift, layer->record.outputChannels * sizeof(int32_t));
+}
+
+static TinyCnnHeader_t make_header(uint16_t layers, uint16_t height, uint16_t width, uint16_t channels,
+                                   uint16_t classes)
+{
+    TinyCnnHeader_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TINY_CNN_MAGIC, 4);
+    header.version = TINY_CNN_VERSION;
+    header.layerCount = layers;
+    header.inputHeight = height;
+    header.inputWidth = width;
+    header.inputChannels = channels;
+    header.classes = classes;
+    header.inputScale = 1.0f;
+    header.outputScale = 1.0f;
+    header.pixelScale = 1.0f;
+    return header;
+}
+
+static uint32_t random_state = 12345;
+
+static int random_int(int min, int max)
+{
+    random_state = random_state * 1103515245u + 12345u;
+    return min + (int)((random_state >> 8) % (uint32_t)(max - min + 1));
+}
+
+/****************************** Reference engine ******************************/
+
+typedef struct {
+    int height;
+    int width;
+    int channels;
+    int8_t data[TENSOR_MAX];
+} Tensor_t;
+
+// gemmlowp SaturatingRoundingDoublingHighMul, as written in TensorFlow Lite
+static int32_t reference_high_mul(int32_t a, int32_t b)
+{
+    if (a == INT32_MIN && b == INT32_MIN) {
+        return INT32_MAX;
+    }
+    int64_t ab = (int64_t)a * b;
+    int64_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+    return (int32_t)((ab + nudge) / ((int64_t)1 << 31));
+}
+
+// gemmlowp RoundingDivideByPOT
+static int32_t reference_divide_pot(int32_t x, int exponent)
+{
+    int32_t mask = (int32_t)((1u << exponent) - 1);
+    int32_t remainder = x & mask;
+    int32_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+    return (x >> exponent) + (remainder > threshold ? 1 : 0);
+}
+
+// TensorFlow Lite MultiplyByQuantizedMultiplier
+static int32_t reference_requantize(int32_t x, int32_t multiplier, int32_t shift)
+{
+    int left = shift > 0 ? shift : 0;
+    int right = shift > 0 ? 0 : -shift;
+    return reference_divide_pot(reference_high_mul(x * (1 << left), multiplier), right);
+}
+
+static int8_t reference_finish(int32_t acc, const TestLayer_t *layer, int channel)
+{
+    const TinyCnnLayer_t *record = &layer->record;
+    int32_t value = reference_requantize(acc + layer->bias[channel], layer->multiplier[channel],
+                                         layer->shift[channel]) + record->outputZeroPoint;
+    if (value < record->activationMin) {
+        value = record->activationMin;
+    }
+    if (value > record->activationMax) {
+        value = record->activationMax;
+    }
+    return (int8_t)value;
+}
+
+// TensorFlow padding before the first value
+static int reference_padding(int size, int output, int kernel, int stride, uint8_t padding)
+{
+    if (padding != TINY_CNN_PADDING_SAME) {
+        return 0;
+    }
+    int total = (output - 1) * stride + kernel - size;
+    return total > 0 ? total / 2 : 0;
+}
+
+static int8_t at(const Tensor_t *t, int y, int x, int c)
+{
+    return t->data[(y * t->width + x) * t->channels + c];
+}
+
+// Convolutions, pools and the fully connected layer, every tap visited one by one
+static void reference_layer(const TestLayer_t *layer, const Tensor_t *in, Tensor_t *out)
+{
+    const TinyCnnLayer_t *r = &layer->record;
+    out->height = r->outputHeight;
+    out->width = r->outputWidth;
+    out->channels = r->outputChannels;
+
+    if (r->type == TINY_CNN_FULLY_CONNECTED) {
+        int inputs = in->height * in->width * in->channels;
+        for (int oc = 0; oc < out->channels; oc++) {
+            int32_t acc = 0;
+            for (int i = 0; i < inputs; i++) {
+                acc += (in->data[i] - r->inputZeroPoint) * layer->weights[oc * inputs + i];
+            }
+            out->data[oc] = reference_finish(acc, layer, oc);
+        }
+        return;
+    }
+
+    if (r->type == TINY_CNN_GLOBAL_AVG_POOL) {
+        for (int c = 0; c < in->channels; c++) {
+            int32_t acc = 0;
+            for (int y = 0; y < in->height; y++) {
+                for (int x = 0; x < in->width; x++) {
+                    acc += at(in, y, x, c) - r->inputZeroPoint;
+                }
+            }
+            out->data[c] = reference_finish(acc, layer, c);
+        }
+        return;
+    }
+
+    int padTop = reference_padding(in->height, out->height, r->kernelHeight, r->stride, r->padding);
+    int padLeft = reference_padding(in->width, out->width, r->kernelWidth, r->stride, r->padding);
+
+    for (int oy = 0; oy < out->height; oy++) {
+        for (int ox = 0; ox < out->width; ox++) {
+            for (int oc = 0; oc < out->channels; oc++) {
+                int32_t acc = 0;
+                int32_t count = 0;
+                int32_t largest = -128;
+
+                for (int ky = 0; ky < r->kernelHeight; ky++) {
+                    for (int kx = 0; kx < r->kernelWidth; kx++) {
+                        int y = oy * r->stride - padTop + ky;
+                        int x = ox * r->stride - padLeft + kx;
+                        if (y < 0 || y >= in->height || x < 0 || x >= in->width) {
+                            continue;   // Padding holds the input zero point, or is left out of pools
+                        }
+                        if (r->type == TINY_CNN_CONV2D) {
+                            for (int ic = 0; ic < in->channels; ic++) {
+                                int8_t w = layer->weights[((oc * r->kernelHeight + ky) * r->kernelWidth + kx) * in->channels + ic];
+                                acc += (at(in, y, x, ic) - r->inputZeroPoint) * w;
+                            }
+                        } else if (r->type == TINY_CNN_DEPTHWISE_CONV2D) {
+                            int8_t w = layer->weights[(ky * r->kernelWidth + kx) * in->channels + oc];
+                            acc += (at(in, y, x, oc) - r->inputZeroPoint) * w;
+                        } else {
+                            int8_t value = at(in, y, x, oc);
+                            acc += value;
+                            largest = value > largest ? value : largest;
+                            count++;
+                        }
+                    }
+                }
+
+                int8_t *dst = &out->data[(oy * out->width + ox) * out->channels + oc];
+                if (r->type == TINY_CNN_CONV2D || r->type == TINY_CNN_DEPTHWISE_CONV2D) {
+                    *dst = reference_finish(acc, layer, oc);
+                    continue;
+                }
+
+                // TensorFlow Lite int8 pools: rounded mean, or max, then the clamp
+                int32_t value = r->type == TINY_CNN_MAX_POOL ? largest :
+                                acc > 0 ? (acc + count / 2) / count : (acc - count / 2) / count;
+                value = value < r->activationMin ? r->activationMin : value;
+                value = value > r->activationMax ? r->activationMax : value;
+                *dst = (int8_t)value;
+            }
+        }
+    }
+}
+
+/*********************************** Tests ************************************/
+
+static void init_layer(TestLayer_t *layer, uint8_t type, int kernel, int stride, uint8_t padding,
+                       int outH, int outW, int outC, int32_t inZp, int32_t outZp)
+{
+    memset(layer, 0, sizeof(*layer));
+    layer->record.type = type;
+    layer->record.kernelHeight = (uint8_t)kernel;
+    layer->record.kernelWidth = (uint8_t)kernel;
+    layer->record.stride = (uint8_t)stride;
+    layer->record.padding = padding;
+    layer->record.outputHeight = (uint16_t)outH;
+    layer->record.outputWidth = (uint16_t)outW;
+    layer->record.outputChannels = (uint16_t)outC;
+    layer->record.inputZeroPoint = inZp;
+    layer->record.outputZeroPoint = outZp;
+    layer->record.activationMin = -128;
+    layer->record.activationMax = 127;
+}
+
+// Weights in [-limit, limit], multipliers in [0.5, 1) Q31 with the given shift
+static void init_parameters(TestLayer_t *layer, size_t weights, int limit, int32_t shift)
+{
+    layer->weightCount = weights;
+    for (size_t i = 0; i < weights; i++) {
+        layer->weights[i] = (int8_t)random_int(-limit, limit);
+    }
+    for (int c = 0; c < layer->record.outputChannels; c++) {
+        layer->bias[c] = random_int(-2000, 2000);
+        layer->multiplier[c] = (int32_t)((1u << 30) + (uint32_t)random_int(0, (1 << 30) - 1));
+        layer->shift[c] = shift;
+    }
+    layer->record.payloadSize = (uint32_t)((weights + 3) / 4 * 4 + 3 * sizeof(int32_t) * layer->record.outputChannels);
+}
+
+#define NETWORK_LAYERS 6
+
+static TestLayer_t network[NETWORK_LAYERS];
+
+/*
+ * 7x6x2 input
+ *   conv 3x3 stride 2 SAME, 3 out, ReLU   -> 4x3x3  (1 row padded on top, none on the left)
+ *   depthwise 3x3 stride 1 SAME           -> 4x3x3
+ *   average pool 3x3 stride 2 SAME        -> 2x2x3  (1 column padded on the left)
+ *   max pool 2x2 stride 1 SAME            -> 2x2x3  (padded on the bottom and right)
+ *   global average                        -> 1x1x3
+ *   fully connected, 4 classes            -> 1x1x4
+ */
+static void build_network(void)
+{
+    init_layer(&network[0], TINY_CNN_CONV2D, 3, 2, TINY_CNN_PADDING_SAME, 4, 3, 3, -3, -10);
+    init_parameters(&network[0], 3 * 3 * 3 * 2, 40, -7);
+    network[0].record.activationMin = -10;
+
+    init_layer(&network[1], TINY_CNN_DEPTHWISE_CONV2D, 3, 1, TINY_CNN_PADDING_SAME, 4, 3, 3, -10, 5);
+    init_parameters(&network[1], 3 * 3 * 3, 60, -7);
+
+    init_layer(&network[2], TINY_CNN_AVG_POOL, 3, 2, TINY_CNN_PADDING_SAME, 2, 2, 3, 5, 5);
+    init_layer(&network[3], TINY_CNN_MAX_POOL, 2, 1, TINY_CNN_PADDING_SAME, 2, 2, 3, 5, 5);
+    network[3].record.activationMax = 100;
+
+    // The 1 / 4 of the mean is in the multiplier
+    init_layer(&network[4], TINY_CNN_GLOBAL_AVG_POOL, 0, 0, TINY_CNN_PADDING_VALID, 1, 1, 3, 5, -2);
+    init_parameters(&network[4], 0, 0, -2);
+    init_layer(&network[5], TINY_CNN_FULLY_CONNECTED, 0, 0, TINY_CNN_PADDING_VALID, 1, 1, 4, -2, 1);
+    init_parameters(&network[5], 4 * 3, 100, -5);
+}
+
+// Model with the first layers of the network, its output is the last of them
+static void write_network(ModelBuffer_t *model, int layers)
+{
+    const TinyCnnLayer_t *last = &network[layers - 1].record;
+    TinyCnnHeader_t header = make_header((uint16_t)layers, 7, 6, 2,
+                                         (uint16_t)(last->outputHeight * last->outputWidth * last->outputChannels));
+    model->size = 0;
+    append(model, &header, sizeof(header));
+    for (int i = 0; i < layers; i++) {
+        append_layer(model, &network[i]);
+    }
+}
+
+static void check_network(void)
+{
+    static ModelBuffer_t buffer;
+    static int8_t arena[2 * TENSOR_MAX];
+    Tensor_t tensors[NETWORK_LAYERS + 1];
+
+    build_network();
+
+    tensors[0].height = 7;
+    tensors[0].width = 6;
+    tensors[0].channels = 2;
+    for (int i = 0; i < 7 * 6 * 2; i++) {
+        tensors[0].data[i] = (int8_t)random_int(-128, 127);
+    }
+    for (int i = 0; i < NETWORK_LAYERS; i++) {
+        reference_layer(&network[i], &tensors[i], &tensors[i + 1]);
+    }
+
+    // Every prefix of the network, so each layer output is compared whole
+    for (int layers = 1; layers <= NETWORK_LAYERS; layers++) {
+        TinyCnnModel_t model;
+        write_network(&buffer, layers);
+        if (tiny_cnn_load(&model, (const uint8_t *)buffer.words, buffer.size) != ESP_OK) {
+            fprintf(stderr, "network of %d layers does not load\n", layers);
+            failures++;
+            continue;
+        }
+        CHECK(tiny_cnn_arena_size(&model) <= sizeof(arena));
+
+        memcpy(tiny_cnn_input(&model, arena), tensors[0].data, 7 * 6 * 2);
+        const int8_t *output = tiny_cnn_run(&model, arena);
+
+        const Tensor_t *expected = &tensors[layers];
+        int count = expected->height * expected->width * expected->channels;
+        int mismatches = 0;
+        for (int i = 0; i < count; i++) {
+            if (output[i] != expected->data[i]) {
+                if (mismatches++ < 4) {
+                    fprintf(stderr, "layer %d, value %d: %d, reference %d\n", layers - 1, i,
+                            output[i], expected->data[i]);
+                }
+            }
+        }
+        failures += mismatches;
+        printf("layer %d (type %u): %d values, %d mismatches\n", layers - 1, network[layers - 1].record.type,
+               count, mismatches);
+    }
+
+    // The values must not be all clamped, or the comparison says little
+    int distinct = 0;
+    for (int i = 1; i < 4 * 3 * 3; i++) {
+        distinct += tensors[1].data[i] != tensors[1].data[0];
+    }
+    CHECK(distinct > 0);
+}
+
+/*
+ * A fully connected layer on a single zero input, so each output channel is
+ * requantize(bias) + zero point. The expectations are worked out by hand from
+ * the TensorFlow Lite definitions, ties included.
+ */
+static void check_requantize(void)
+{
+    static ModelBuffer_t buffer;
+    static int8_t arena[64];
+    static const struct {
+        int32_t acc;
+        int32_t multiplier;
+        int32_t shift;
+        int8_t expected;
+    } cases[] = {
+        { 3, 1 << 30, 0, 2 },           // 1.5 rounds up
+        { -3, 1 << 30, 0, -1 },         // -1.5 rounds up in the doubling high multiply
+        { 5, INT32_MAX, -1, 3 },        // 2.5 rounds away from zero in the shift
+        { -5, INT32_MAX, -1, -3 },      // -2.5 rounds away from zero in the shift
+        { 5, 1 << 30, -1, 2 },          // 1.25 rounded twice, 2.5 then 1.5
+        { 7, 1 << 30, -2, 1 },          // 0.875
+        { 3, 1 << 30, 2, 6 },           // Left shift
+        { 1000, 1 << 30, 0, 127 },      // Clamped by the activation
+        { -1000, 1 << 30, 0, -128 },
+    };
+    const int count = sizeof(cases) / sizeof(cases[0]);
+
+    TestLayer_t layer;
+    init_layer(&layer, TINY_CNN_FULLY_CONNECTED, 0, 0, TINY_CNN_PADDING_VALID, 1, 1, count, 0, 0);
+    layer.weightCount = (size_t)count;
+    for (int c = 0; c < count; c++) {
+        layer.weights[c] = 1;
+        layer.bias[c] = cases[c].acc;
+        layer.multiplier[c] = cases[c].multiplier;
+        layer.shift[c] = cases[c].shift;
+    }
+    layer.record.payloadSize = (uint32_t)((count + 3) / 4 * 4 + 3 * sizeof(int32_t) * count);
+
+    TinyCnnHeader_t header = make_header(1, 1, 1, 1, (uint16_t)count);
+    append(&buffer, &header, sizeof(header));
+    append_layer(&buffer, &layer);
+
+    TinyCnnModel_t model;
+    CHECK(tiny_cnn_load(&model, (const uint8_t *)buffer.words, buffer.size) == ESP_OK);
+    tiny_cnn_input(&model, arena)[0] = 0;
+    const int8_t *output = tiny_cnn_run(&model, arena);
+
+    for (int c = 0; c < count; c++) {
+        int8_t reference = reference_finish(0, &layer, c);   // The bias is the accumulator
+        if (output[c] != cases[c].expected || reference != cases[c].expected) {
+            fprintf(stderr, "requantize(%d, %d, %d): %d, reference %d, expected %d\n", (int)cases[c].acc,
+                    (int)cases[c].multiplier, (int)cases[c].shift, output[c], reference, cases[c].expected);
+            failures++;
+        }
+    }
+}
+
+static void check_load_errors(void)
+{
+    static ModelBuffer_t buffer;
+    static ModelBuffer_t broken;
+    TinyCnnModel_t model;
+    const uint8_t *data = (const uint8_t *)broken.words;
+
+    write_network(&buffer, NETWORK_LAYERS);
+    CHECK(tiny_cnn_load(&model, (const uint8_t *)buffer.words, buffer.size) == ESP_OK);
+    CHECK(model.macs > 0);
+
+    // Every truncation of the model is rejected
+    for (size_t size = 0; size < buffer.size; size++) {
+        if (tiny_cnn_load(&model, (const uint8_t *)buffer.words, size) != ESP_ERR_INVALID_ARG) {
+            fprintf(stderr, "model truncated to %zu of %zu bytes was accepted\n", size, buffer.size);
+            failures++;
+            break;
+        }
+    }
+
+    // Misaligned data
+    memcpy((uint8_t *)broken.words + 1, buffer.words, buffer.size);
+    CHECK(tiny_cnn_load(&model, data + 1, buffer.size) == ESP_ERR_INVALID_ARG);
+
+    TinyCnnHeader_t *header = (TinyCnnHeader_t *)broken.words;
+    TinyCnnLayer_t *first = (TinyCnnLayer_t *)(data + sizeof(TinyCnnHeader_t));
+
+#define RESET() memcpy(broken.words, buffer.words, buffer.size)
+    RESET();
+    header->magic[0] = 'X';
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_INVALID_ARG);
+    RESET();
+    header->version = TINY_CNN_VERSION + 1;
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_NOT_SUPPORTED);
+    RESET();
+    header->layerCount = TINY_CNN_MAX_LAYERS + 1;
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_NOT_SUPPORTED);
+    RESET();
+    header->classes = 5;
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_INVALID_ARG);
+    RESET();
+    first->payloadSize += 4;
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_INVALID_ARG);
+    RESET();
+    first->outputHeight = 3;    // SAME with stride 2 gives 4 rows
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_INVALID_ARG);
+    RESET();
+    first->type = 9;
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_NOT_SUPPORTED);
+    RESET();
+    first->activationMin = 20;
+    first->activationMax = 10;
+    CHECK(tiny_cnn_load(&model, data, buffer.size) == ESP_ERR_INVALID_ARG);
+#undef RESET
+}
+
+int main(void)
+{
+    check_network();
+    check_requantize();
+    check_load_errors();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("tiny cnn: all checks passed\n");
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
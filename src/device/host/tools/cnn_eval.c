@@ -0,0 +1,269 @@
+/*******************************************************************************
+ * @file        cnn_eval.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Runs the classifier of the device over JPEG images with a TCNN
+ *              model and reports its scores, its throughput and, for labelled
+ *              images, its accuracy, precision and recall:
+ *
+ *                cnn_eval [-s <denominator>] [-t <threshold>] <model.tcnn> <image.jpg>...
+ *
+ *              Images are decoded by libjpeg at 1/denominator scale (4 by default,
+ *              as CLASSIFIER_DECODE_SCALE on the device) and go through the same
+ *              RGB565 input preparation, engine and scoring as the firmware. A file
+ *              is a positive when its name contains "person", "smoker" or "smoking"
+ *              and a negative when it contains "notsmoking", other files are not
+ *              counted. The threshold is in per mille, 500 by default. One CSV line
+ *              is printed per image, then a summary.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <jpeglib.h>
+#include "classifier/classifier.h"
+#include "tiny_cnn/tiny_cnn.h"
+
+typedef enum
+{
+    LABEL_NONE,
+    LABEL_NEGATIVE,
+    LABEL_POSITIVE
+} Label_t;
+
+static Label_t file_label(const char *path)
+{
+    const char *name = strrchr(path, '/');
+    name = name != NULL ? name + 1 : path;
+
+    if (strstr(name, "notsmoking") != NULL)
+    {
+        return LABEL_NEGATIVE;
+    }
+    if (strstr(name, "person") != NULL || strstr(name, "smoker") != NULL || strstr(name, "smoking") != NULL)
+    {
+        return LABEL_POSITIVE;
+    }
+    return LABEL_NONE;
+}
+
+// Whole file in a 4 byte aligned buffer, as tiny_cnn_load() needs
+static uint8_t *read_file(const char *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    uint8_t *data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        size = ftell(file);
+    }
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = aligned_alloc(4, ((size_t)size + 3) & ~(size_t)3);
+        if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size)
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+
+    *len = (size_t)size;
+    return data;
+}
+
+// Decodes a JPEG file to big endian RGB565, as jpg2rgb565() does on the device
+static uint8_t *decode_rgb565(const char *path, unsigned denominator, uint16_t *width, uint16_t *height)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    struct jpeg_decompress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&cinfo);
+    jpeg_stdio_src(&cinfo, file);
+
+    uint8_t *out = NULL;
+    if (jpeg_read_header(&cinfo, TRUE) == JPEG_HEADER_OK)
+    {
+        cinfo.scale_num = 1;
+        cinfo.scale_denom = denominator;
+        cinfo.out_color_space = JCS_RGB;
+        jpeg_start_decompress(&cinfo);
+
+        size_t stride = (size_t)cinfo.output_width * cinfo.output_components;
+        uint8_t *row = malloc(stride);
+        out = malloc((size_t)cinfo.output_width * cinfo.output_height * 2);
+        uint8_t *px = out;
+
+        while (row != NULL && out != NULL && cinfo.output_scanline < cinfo.output_height)
+        {
+            jpeg_read_scanlines(&cinfo, &row, 1);
+            for (size_t x = 0; x < cinfo.output_width; x++)
+            {
+                const uint8_t *rgb = row + x * cinfo.output_components;
+                uint16_t c = ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+                *px++ = c >> 8;
+                *px++ = c & 0xFF;
+            }
+        }
+
+        *width = (uint16_t)cinfo.output_width;
+        *height = (uint16_t)cinfo.output_height;
+        jpeg_finish_decompress(&cinfo);
+        free(row);
+    }
+
+    jpeg_destroy_decompress(&cinfo);
+    fclose(file);
+    return out;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static double ratio(uint32_t num, uint32_t den)
+{
+    return den ? (double)num / den : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned denominator = 4;
+    unsigned threshold = 500;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:t:")) != -1)
+    {
+        if (opt == 's')
+        {
+            denominator = (unsigned)strtoul(optarg, NULL, 10);
+        }
+        else if (opt == 't')
+        {
+            threshold = (unsigned)strtoul(optarg, NULL, 10);
+        }
+        else
+        {
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind >= argc || (denominator != 1 && denominator != 2 && denominator != 4 && denominator != 8))
+    {
+        fprintf(stderr, "usage: %s [-s 1|2|4|8] [-t <threshold>] <model.tcnn> <image.jpg>...\n", argv[0]);
+        return 2;
+    }
+
+    size_t modelLen;
+    uint8_t *modelData = read_file(argv[optind], &modelLen);
+    TinyCnnModel_t model;
+    esp_err_t err = modelData != NULL ? tiny_cnn_load(&model, modelData, modelLen) : ESP_ERR_NOT_FOUND;
+    if (err != ESP_OK)
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], esp_err_to_name(err));
+        return 1;
+    }
+
+    int8_t *arena = aligned_alloc(4, tiny_cnn_arena_size(&model));
+    if (arena == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    uint32_t frames = 0;
+    uint32_t errors = 0;
+    uint32_t truePositives = 0;
+    uint32_t falsePositives = 0;
+    uint32_t trueNegatives = 0;
+    uint32_t falseNegatives = 0;
+    uint64_t prepareNs = 0;
+    uint64_t inferenceNs = 0;
+
+    printf("file,label,score,top_class,prepare_us,inference_us\n");
+
+    for (int i = optind + 1; i < argc; i++)
+    {
+        uint16_t width = 0;
+        uint16_t height = 0;
+        uint8_t *rgb565 = decode_rgb565(argv[i], denominator, &width, &height);
+        if (rgb565 == NULL || width == 0 || height == 0)
+        {
+            fprintf(stderr, "%s: cannot decode\n", argv[i]);
+            free(rgb565);
+            errors++;
+            continue;
+        }
+
+        uint64_t startNs = now_ns();
+        classifier_prepare_input(&model, rgb565, width, height, tiny_cnn_input(&model, arena));
+        uint64_t preparedNs = now_ns();
+        const int8_t *output = tiny_cnn_run(&model, arena);
+        uint64_t doneNs = now_ns();
+        free(rgb565);
+
+        uint8_t topClass;
+        uint16_t score = classifier_score(&model, output, &topClass);
+
+        frames++;
+        prepareNs += preparedNs - startNs;
+        inferenceNs += doneNs - preparedNs;
+
+        Label_t label = file_label(argv[i]);
+        bool detected = score >= threshold;
+        if (label == LABEL_POSITIVE)
+        {
+            detected ? truePositives++ : falseNegatives++;
+        }
+        else if (label == LABEL_NEGATIVE)
+        {
+            detected ? falsePositives++ : trueNegatives++;
+        }
+
+        printf("%s,%d,%u,%u,%.1f,%.1f\n", argv[i], label == LABEL_NONE ? -1 : label == LABEL_POSITIVE,
+               score, topClass, (preparedNs - startNs) / 1000.0, (doneNs - preparedNs) / 1000.0);
+    }
+
+    const TinyCnnHeader_t *header = model.header;
+    printf("# model %ux%ux%u, %u layers, %u classes, %u MACs, arena %zu bytes\n",
+           header->inputWidth, header->inputHeight, header->inputChannels, header->layerCount,
+           header->classes, model.macs, tiny_cnn_arena_size(&model));
+    printf("# frames %u, errors %u, threshold %u, scale 1/%u\n", frames, errors, threshold, denominator);
+    if (frames > 0)
+    {
+        double inferenceUs = inferenceNs / 1000.0 / frames;
+        printf("# per frame: prepare %.1f us, inference %.1f us, %.1f MMAC/s\n",
+               prepareNs / 1000.0 / frames, inferenceUs, inferenceUs > 0 ? model.macs / inferenceUs : 0.0);
+    }
+    uint32_t labelled = truePositives + falsePositives + trueNegatives + falseNegatives;
+    printf("# tp %u, fp %u, tn %u, fn %u, accuracy %.3f, precision %.3f, recall %.3f\n",
+           truePositives, falsePositives, trueNegatives, falseNegatives,
+           ratio(truePositives + trueNegatives, labelled),
+           ratio(truePositives, truePositives + falsePositives), ratio(truePositives, truePositives + falseNegatives));
+
+    free(arena);
+    free(modelData);
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
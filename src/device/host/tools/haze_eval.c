@@ -0,0 +1,239 @@
+/*******************************************************************************
+ * @file        haze_eval.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Runs the haze detector of the device over JPEG images and reports
+ *              its features, its timing and, for labelled images, its precision
+ *              and recall:
+ *
+ *                haze_eval [-s] [-t <threshold>] <image.jpg>...
+ *
+ *              A file is a positive when its name contains "smoking" or "smoke"
+ *              and a negative when it contains "notsmoking", other files are not
+ *              counted. Each image is checked on its own, against the reference
+ *              background, unless -s is given: the images are then a sequence of
+ *              frames of one camera and the background and temporal features
+ *              carry over. One CSV line is printed per image, then a summary.
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "haze/haze_detector.h"
+#include "jpeg_dc/jpeg_dc.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAZE_EVAL_CYCLES() __rdtsc()
+#else
+#define HAZE_EVAL_CYCLES() 0
+#endif
+
+typedef enum
+{
+    LABEL_NONE,
+    LABEL_NEGATIVE,
+    LABEL_POSITIVE
+} Label_t;
+
+static Label_t file_label(const char *path)
+{
+    const char *name = strrchr(path, '/');
+    name = name != NULL ? name + 1 : path;
+
+    if (strstr(name, "notsmoking") != NULL)
+    {
+        return LABEL_NEGATIVE;
+    }
+    if (strstr(name, "smoking") != NULL || strstr(name, "smoke") != NULL)
+    {
+        return LABEL_POSITIVE;
+    }
+    return LABEL_NONE;
+}
+
+static uint8_t *read_file(const char *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    uint8_t *data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        size = ftell(file);
+    }
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = malloc((size_t)size);
+        if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size)
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+
+    *len = (size_t)size;
+    return data;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static double ratio(uint32_t num, uint32_t den)
+{
+    return den ? (double)num / den : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    bool sequence = false;
+    unsigned threshold = HAZE_SCORE_THRESHOLD;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "st:")) != -1)
+    {
+        if (opt == 's')
+        {
+            sequence = true;
+        }
+        else if (opt == 't')
+        {
+            threshold = (unsigned)strtoul(optarg, NULL, 10);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-s] [-t <threshold>] <image.jpg>...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static JpegDcDecoder_t decoder;
+    HazeDetector_t detector = {0};
+    uint8_t *luma = NULL;
+    uint8_t *saturation = NULL;
+    size_t capacity = 0;
+
+    uint32_t frames = 0;
+    uint32_t errors = 0;
+    uint32_t truePositives = 0;
+    uint32_t falsePositives = 0;
+    uint32_t trueNegatives = 0;
+    uint32_t falseNegatives = 0;
+    uint64_t decodeNs = 0;
+    uint64_t kernelNs = 0;
+    uint64_t decodeCycles = 0;
+    uint64_t kernelCycles = 0;
+
+    printf("file,label,width,height,contrast_loss,gray_growth,temporal,score,decode_us,kernel_us\n");
+
+    for (int i = optind; i < argc; i++)
+    {
+        size_t len;
+        uint8_t *jpg = read_file(argv[i], &len);
+        uint16_t width;
+        uint16_t height;
+        esp_err_t err = jpg != NULL ? jpeg_dc_get_size(jpg, len, &width, &height) : ESP_ERR_NOT_FOUND;
+
+        if (err == ESP_OK && (size_t)width * height > capacity)
+        {
+            capacity = (size_t)width * height;
+            luma = realloc(luma, capacity);
+            saturation = realloc(saturation, capacity);
+            if (luma == NULL || saturation == NULL)
+            {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+        }
+
+        JpegDcImage_t image = {.luma = luma, .saturation = saturation, .capacity = capacity};
+        uint64_t startNs = now_ns();
+        uint64_t startCycles = HAZE_EVAL_CYCLES();
+        if (err == ESP_OK)
+        {
+            err = jpeg_dc_decode(&decoder, jpg, len, &image);
+        }
+        uint64_t decodedNs = now_ns();
+        uint64_t decodedCycles = HAZE_EVAL_CYCLES();
+
+        HazeFeatures_t features = {0};
+        if (err == ESP_OK)
+        {
+            if (!sequence && detector.background != NULL)
+            {
+                haze_detector_reset(&detector);
+            }
+            err = haze_detector_update(&detector, image.luma, image.saturation, image.width, image.height, &features);
+        }
+        uint64_t doneNs = now_ns();
+        uint64_t doneCycles = HAZE_EVAL_CYCLES();
+        free(jpg);
+
+        if (err != ESP_OK)
+        {
+            fprintf(stderr, "%s: %s\n", argv[i], esp_err_to_name(err));
+            errors++;
+            continue;
+        }
+
+        frames++;
+        decodeNs += decodedNs - startNs;
+        kernelNs += doneNs - decodedNs;
+        decodeCycles += decodedCycles - startCycles;
+        kernelCycles += doneCycles - decodedCycles;
+
+        Label_t label = file_label(argv[i]);
+        bool detected = features.score >= threshold;
+        if (label == LABEL_POSITIVE)
+        {
+            detected ? truePositives++ : falseNegatives++;
+        }
+        else if (label == LABEL_NEGATIVE)
+        {
+            detected ? falsePositives++ : trueNegatives++;
+        }
+
+        printf("%s,%d,%u,%u,%u,%u,%u,%u,%.1f,%.1f\n", argv[i],
+               label == LABEL_NONE ? -1 : label == LABEL_POSITIVE,
+               image.width, image.height, features.contrastLoss, features.grayGrowth,
+               features.temporal, features.score,
+               (decodedNs - startNs) / 1000.0, (doneNs - decodedNs) / 1000.0);
+    }
+
+    printf("# frames %u, errors %u, threshold %u%s\n", frames, errors, threshold, sequence ? ", sequence" : "");
+    if (frames > 0)
+    {
+        printf("# per frame: decode %.1f us, kernel %.1f us", decodeNs / 1000.0 / frames, kernelNs / 1000.0 / frames);
+        if (decodeCycles != 0)
+        {
+            printf(", decode %llu cycles, kernel %llu cycles",
+                   (unsigned long long)(decodeCycles / frames), (unsigned long long)(kernelCycles / frames));
+        }
+        printf("\n");
+    }
+    printf("# tp %u, fp %u, tn %u, fn %u, precision %.3f, recall %.3f\n",
+           truePositives, falsePositives, trueNegatives, falseNegatives,
+           ratio(truePositives, truePositives + falsePositives), ratio(truePositives, truePositives + falseNegatives));
+
+    haze_detector_free(&detector);
+    free(luma);
+    free(saturation);
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
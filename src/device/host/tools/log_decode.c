@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * @file        log_decode.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Turns the output of a device built with ENABLE_BINARY_LOG back
+ *              into text. Reads the serial or SPP stream on stdin, decodes the
+ *              log_codec records and passes everything else through:
+ *
+ *                log_decode < /dev/rfcomm0
+ *
+ * @note        Only used by the Linux host build in src/device/host.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include "log_codec/log_codec.h"
+
+int main(void)
+{
+    uint8_t record[LOG_CODEC_RECORD_MAX];
+    char text[1024];
+    int c;
+
+    while ((c = getchar()) != EOF)
+    {
+        // The BLE notification buffer is padded with zeros
+        if (c == 0)
+        {
+            continue;
+        }
+        if (c != LOG_CODEC_MARKER)
+        {
+            putchar(c);
+            continue;
+        }
+
+        int len = getchar();
+        if (len == EOF)
+        {
+            break;
+        }
+        record[0] = LOG_CODEC_MARKER;
+        record[1] = (uint8_t)len;
+        if (fread(&record[2], 1, (size_t)len, stdin) != (size_t)len)
+        {
+            break;
+        }
+
+        if (log_codec_decode(record, LOG_CODEC_HEADER_SIZE + (size_t)len, text, sizeof(text)) > 0)
+        {
+            fputs(text, stdout);
+        }
+        else
+        {
+            fprintf(stdout, "<invalid log record of %d bytes>\n", len);
+        }
+        fflush(stdout);
+    }
+    return 0;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
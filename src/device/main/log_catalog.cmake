@@ -0,0 +1,68 @@
+# Generates log_catalog.h, the table of log tags and format strings used by the
+# binary log encoding (src/log_codec). The firmware and the host decoder both
+# include it, so a record written by one is read back by the other with the
+# same ids:
+#
+#   generate_log_catalog(<source dir> <output file>)
+#
+# Tags are the `const char *X_TAG = "...";` definitions of logging_utils.c.
+# Formats are the literals passed to ESP_LOGx() on a single line, sorted so
+# the ids do not depend on the order the files are scanned in. Calls whose
+# format spans several lines or uses macros such as PRIu32 are left out, they
+# are still logged as text.
+function(generate_log_catalog SRC_DIR OUT_FILE)
+    file(READ "${SRC_DIR}/logging/logging_utils.c" LOGGING_SOURCE)
+    string(REGEX MATCHALL "const char \\*[A-Z_]+ = \"[^\"]*\"" TAG_DEFINITIONS "${LOGGING_SOURCE}")
+
+    set(TAGS "")
+    foreach(TAG_DEFINITION ${TAG_DEFINITIONS})
+        string(REGEX REPLACE "^const char \\*[A-Z_]+ = \"([^\"]*)\"$" "\\1" TAG "${TAG_DEFINITION}")
+        list(APPEND TAGS "${TAG}")
+    endforeach()
+
+    file(GLOB_RECURSE SOURCES "${SRC_DIR}/*.c")
+    list(SORT SOURCES)
+
+    set(FORMATS "")
+    foreach(SOURCE ${SOURCES})
+        file(READ "${SOURCE}" CONTENTS)
+        # Keep ';' and brackets out of the CMake lists, the C escapes stand for the same bytes
+        string(REPLACE ";" "\\073" CONTENTS "${CONTENTS}")
+        string(REPLACE "[" "\\133" CONTENTS "${CONTENTS}")
+        string(REPLACE "]" "\\135" CONTENTS "${CONTENTS}")
+        string(REGEX MATCHALL "ESP_LOG[EWIDV]\\([ ]*[A-Z_]+[ ]*,[ ]*\"[^\"\n]*\"[ ]*[,)]" CALLS "${CONTENTS}")
+        foreach(CALL ${CALLS})
+            string(REGEX REPLACE "^ESP_LOG[EWIDV]\\([ ]*[A-Z_]+[ ]*,[ ]*\"([^\"\n]*)\"[ ]*[,)]$" "\\1" FORMAT "${CALL}")
+            list(APPEND FORMATS "${FORMAT}")
+        endforeach()
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${SOURCE}")
+    endforeach()
+    list(REMOVE_DUPLICATES FORMATS)
+    list(SORT FORMATS)
+
+    list(LENGTH TAGS TAG_COUNT)
+    list(LENGTH FORMATS FORMAT_COUNT)
+
+    set(HEADER "/* Generated by log_catalog.cmake, do not edit */\n")
+    string(APPEND HEADER "#ifndef LOG_CATALOG_H\n#define LOG_CATALOG_H\n\n")
+    string(APPEND HEADER "#define LOG_CATALOG_TAG_COUNT ${TAG_COUNT}\n")
+    string(APPEND HEADER "#define LOG_CATALOG_FORMAT_COUNT ${FORMAT_COUNT}\n\n")
+    string(APPEND HEADER "static const char *const log_catalog_tags[LOG_CATALOG_TAG_COUNT] = {\n")
+    foreach(TAG ${TAGS})
+        string(APPEND HEADER "    \"${TAG}\",\n")
+    endforeach()
+    string(APPEND HEADER "};\n\n")
+    string(APPEND HEADER "static const char *const log_catalog_formats[LOG_CATALOG_FORMAT_COUNT] = {\n")
+    foreach(FORMAT ${FORMATS})
+        string(APPEND HEADER "    \"${FORMAT}\",\n")
+    endforeach()
+    string(APPEND HEADER "};\n\n#endif /* LOG_CATALOG_H */\n")
+
+    # Rewrite only on change so the sources including it are not rebuilt for nothing
+    if (EXISTS "${OUT_FILE}")
+        file(READ "${OUT_FILE}" PREVIOUS)
+    endif()
+    if (NOT "${PREVIOUS}" STREQUAL "${HEADER}")
+        file(WRITE "${OUT_FILE}" "${HEADER}")
+    endif()
+endfunction()
@@ -7,36 +7,266 @@
  *
  *******************************************************************************/
 
+#include <stdatomic.h>
 #include "../base64/base64_utils.h"
 
 // Base64 encoding table
 static const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+// Marks characters outside the base64 alphabet in the decoding table
+#define BASE64_INVALID 0x80
+
+// Two output characters for every 12-bit input value, stored in output order
+static uint16_t base64_pair_table[4096];
+
+// 6-bit value of every input character, BASE64_INVALID if not in the alphabet
+static uint8_t base64_decode_table[256];
+
+// Published with release order once the tables are written, read with acquire
+// order so a task on the other core never sees the flag before the tables
+static atomic_bool base64_tables_ready = false;
+
+// Build the lookup tables on first use. Concurrent first calls only write
+// identical values, so no locking is needed.
+static void base64_init_tables(void)
+{
+    if (atomic_load_explicit(&base64_tables_ready, memory_order_acquire)) {
+        return;
+    }
+
+    for (size_t i = 0; i < 4096; i++) {
+        char pair[2] = { base64_table[i >> 6], base64_table[i & 0x3F] };
+        memcpy(&base64_pair_table[i], pair, sizeof(pair));
+    }
+
+    memset(base64_decode_table, BASE64_INVALID, sizeof(base64_decode_table));
+    for (size_t i = 0; i < 64; i++) {
+        base64_decode_table[(unsigned char)base64_table[i]] = (uint8_t)i;
+    }
+
+    atomic_store_explicit(&base64_tables_ready, true, memory_order_release);
+}
+
+// Load 4 bytes as a big-endian word, whatever the alignment and host order
+static inline uint32_t base64_load_be32(const unsigned char *src)
+{
+    uint32_t word;
+    memcpy(&word, src, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+}
+
+// Encode whole 12-byte blocks as 8 character pairs, returns the bytes consumed
+static size_t base64_encode_blocks(const unsigned char *src, size_t src_len, char *dst)
+{
+    size_t blocks = src_len / 12;
+
+    for (size_t b = 0; b < blocks; b++, src += 12, dst += 16) {
+        uint32_t w0 = base64_load_be32(src);
+        uint32_t w1 = base64_load_be32(src + 4);
+        uint32_t w2 = base64_load_be32(src + 8);
+
+        uint16_t pairs[8] = {
+            base64_pair_table[w0 >> 20],
+            base64_pair_table[(w0 >> 8) & 0xFFF],
+            base64_pair_table[((w0 & 0xFF) << 4) | (w1 >> 28)],
+            base64_pair_table[(w1 >> 16) & 0xFFF],
+            base64_pair_table[(w1 >> 4) & 0xFFF],
+            base64_pair_table[((w1 & 0xF) << 8) | (w2 >> 24)],
+            base64_pair_table[(w2 >> 12) & 0xFFF],
+            base64_pair_table[w2 & 0xFFF],
+        };
+        memcpy(dst, pairs, sizeof(pairs));
+    }
+
+    return blocks * 12;
+}
+
+// Encode a trailing group of 1 or 2 bytes with padding
+static void base64_encode_tail(const unsigned char *src, size_t src_len, char *dst)
+{
+    uint32_t octet_a = src[0];
+    uint32_t octet_b = src_len > 1 ? src[1] : 0;
+
+    dst[0] = base64_table[(octet_a >> 2) & 0x3F];
+    dst[1] = base64_table[((octet_a & 0x3) << 4) | ((octet_b >> 4) & 0xF)];
+    dst[2] = src_len > 1 ? base64_table[(octet_b & 0xF) << 2] : '=';
+    dst[3] = '=';
+}
+
+// Encode whole 3-byte groups, returns the number of characters written
+static size_t base64_encode_groups(const unsigned char *src, size_t groups, char *dst)
+{
+    // Fast path on 12-byte blocks, the remaining groups go through the scalar loop
+    size_t done = base64_encode_blocks(src, groups * 3, dst);
+    src += done;
+    dst += done / 3 * 4;
+
+    for (size_t g = done / 3; g < groups; g++, src += 3, dst += 4) {
+        uint32_t triple = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | src[2];
+
+        dst[0] = base64_table[(triple >> 18) & 0x3F];
+        dst[1] = base64_table[(triple >> 12) & 0x3F];
+        dst[2] = base64_table[(triple >> 6) & 0x3F];
+        dst[3] = base64_table[triple & 0x3F];
+    }
+
+    return groups * 4;
+}
+
 // Function to perform base64 encoding
 int base64_encode(const unsigned char *src, size_t src_len, char *dst, size_t *dst_len)
 {
-    size_t i, j;
     size_t encoded_len = (src_len + 2) / 3 * 4;
 
+    base64_init_tables();
+
     if (*dst_len < encoded_len) {
         *dst_len = encoded_len;
         return -1; // Destination buffer too small
     }
 
-    for (i = 0, j = 0; i < src_len; i += 3, j += 4) {
-        uint32_t octet_a = i < src_len ? src[i] : 0;
-        uint32_t octet_b = i + 1 < src_len ? src[i + 1] : 0;
-        uint32_t octet_c = i + 2 < src_len ? src[i + 2] : 0;
+    size_t groups = src_len / 3;
+    size_t j = base64_encode_groups(src, groups, dst);
 
-        dst[j] = base64_table[(octet_a >> 2) & 0x3F];
-        dst[j + 1] = base64_table[((octet_a & 0x3) << 4) | ((octet_b >> 4) & 0xF)];
-        dst[j + 2] = i + 1 < src_len ? base64_table[((octet_b & 0xF) << 2) | ((octet_c >> 6) & 0x3F)] : '=';
-        dst[j + 3] = i + 2 < src_len ? base64_table[octet_c & 0x3F] : '=';
+    if (src_len % 3) {
+        base64_encode_tail(src + groups * 3, src_len % 3, dst + j);
     }
 
     *dst_len = encoded_len;
     return 0;
 }
 
+void base64_encode_init(Base64EncodeCtx_t *ctx)
+{
+    base64_init_tables();
+    ctx->carry_len = 0;
+}
+
+size_t base64_encode_update(Base64EncodeCtx_t *ctx, const unsigned char *src, size_t src_len, char *dst)
+{
+    size_t written = 0;
+
+    // Complete the group left over from the previous chunk
+    if (ctx->carry_len > 0) {
+        unsigned char group[3];
+        size_t needed = 3 - ctx->carry_len;
+
+        if (src_len < needed) {
+            memcpy(ctx->carry + ctx->carry_len, src, src_len);
+            ctx->carry_len += src_len;
+            return 0;
+        }
+
+        memcpy(group, ctx->carry, ctx->carry_len);
+        memcpy(group + ctx->carry_len, src, needed);
+        written = base64_encode_groups(group, 1, dst);
+        src += needed;
+        src_len -= needed;
+        ctx->carry_len = 0;
+    }
+
+    size_t groups = src_len / 3;
+    written += base64_encode_groups(src, groups, dst + written);
+
+    // Keep the 0 to 2 remaining bytes for the next chunk
+    ctx->carry_len = src_len - groups * 3;
+    memcpy(ctx->carry, src + groups * 3, ctx->carry_len);
+
+    return written;
+}
+
+size_t base64_encode_final(Base64EncodeCtx_t *ctx, char *dst)
+{
+    if (ctx->carry_len == 0) {
+        return 0;
+    }
+
+    base64_encode_tail(ctx->carry, ctx->carry_len, dst);
+    ctx->carry_len = 0;
+    return 4;
+}
+
+// Decode 4 characters without padding into 3 bytes, returns false on invalid input
+static inline bool base64_decode_quad(const char *src, unsigned char *dst)
+{
+    uint8_t a = base64_decode_table[(unsigned char)src[0]];
+    uint8_t b = base64_decode_table[(unsigned char)src[1]];
+    uint8_t c = base64_decode_table[(unsigned char)src[2]];
+    uint8_t d = base64_decode_table[(unsigned char)src[3]];
+
+    if ((a | b | c | d) & BASE64_INVALID) {
+        return false;
+    }
+
+    uint32_t triple = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | d;
+    dst[0] = (unsigned char)(triple >> 16);
+    dst[1] = (unsigned char)(triple >> 8);
+    dst[2] = (unsigned char)triple;
+    return true;
+}
+
+// Function to perform base64 decoding
+int base64_decode(const char *src, size_t src_len, unsigned char *dst, size_t *dst_len)
+{
+    base64_init_tables();
+
+    if (src_len % 4 != 0) {
+        return -2; // Not a whole number of 4-character groups
+    }
+
+    size_t padding = 0;
+    if (src_len > 0 && src[src_len - 1] == '=') {
+        padding = (src[src_len - 2] == '=') ? 2 : 1;
+    }
+
+    size_t decoded_len = src_len / 4 * 3 - padding;
+    if (*dst_len < decoded_len) {
+        *dst_len = decoded_len;
+        return -1; // Destination buffer too small
+    }
+
+    // The last group may hold padding, keep it out of the block loop
+    size_t body_len = src_len > 0 ? src_len - 4 : 0;
+    size_t i = 0, j = 0;
+
+    // Fast path on 16-character blocks, 12 bytes out
+    for (; i + 16 <= body_len; i += 16, j += 12) {
+        bool valid = base64_decode_quad(src + i, dst + j);
+        valid &= base64_decode_quad(src + i + 4, dst + j + 3);
+        valid &= base64_decode_quad(src + i + 8, dst + j + 6);
+        valid &= base64_decode_quad(src + i + 12, dst + j + 9);
+        if (!valid) {
+            return -2; // Invalid character
+        }
+    }
+
+    for (; i < body_len; i += 4, j += 3) {
+        if (!base64_decode_quad(src + i, dst + j)) {
+            return -2; // Invalid character
+        }
+    }
+
+    if (src_len > 0) {
+        // Last group, with padding replaced by zero bits
+        char last[4];
+        memcpy(last, src + i, sizeof(last));
+        for (size_t p = 0; p < padding; p++) {
+            last[3 - p] = 'A';
+        }
+
+        unsigned char bytes[3];
+        if (!base64_decode_quad(last, bytes)) {
+            return -2; // Invalid character
+        }
+        memcpy(dst + j, bytes, 3 - padding);
+    }
+
+    *dst_len = decoded_len;
+    return 0;
+}
+
 /********************************* END OF FILE ********************************/
 /******************************************************************************/
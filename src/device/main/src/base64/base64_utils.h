@@ -1,7 +1,10 @@
 /*******************************************************************************
  * @file        base64_utils.h
  * @brief       Header file for base64 encoding utility functions
- * @details     Provides a function for base64 encoding of data
+ * @details     Provides functions for base64 encoding of data, either in one call
+ *              or incrementally chunk by chunk, and base64 decoding.
+ *              Whole 12-byte blocks are encoded with 32-bit word loads and a
+ *              4096-entry table giving two output characters per lookup
  * @author      Leonardo Acha Boiano
  * @date        7 Jun 2023
  * 
@@ -12,9 +15,29 @@
 #ifndef BASE64_UTILS_H
 #define BASE64_UTILS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
+// Input bytes per chunk for streaming callers, a multiple of 3 so that no
+// bytes are carried over between chunks
+#define BASE64_CHUNK_SIZE 768
+
+// Worst case output length of base64_encode_update() for src_len input bytes
+#define BASE64_ENCODE_UPDATE_MAX(src_len) (((src_len) + 2) / 3 * 4)
+
+// Output length of base64_encode_final()
+#define BASE64_ENCODE_FINAL_MAX 4
+
+/**
+ * @brief   State of an incremental base64 encoding.
+ */
+typedef struct
+{
+    unsigned char carry[2];     /*< Input bytes not yet forming a full 3-byte group */
+    size_t carry_len;           /*< Number of valid bytes in carry (0 to 2)         */
+} Base64EncodeCtx_t;
+
 /**
  * @brief   Base64 encodes a given source data.
  *
@@ -28,6 +51,54 @@
  */
 int base64_encode(const unsigned char *src, size_t src_len, char *dst, size_t *dst_len);
 
+/**
+ * @brief   Starts an incremental base64 encoding.
+ *
+ * @param   ctx         Pointer to the encoding context.
+ */
+void base64_encode_init(Base64EncodeCtx_t *ctx);
+
+/**
+ * @brief   Encodes the next chunk of an incremental base64 encoding.
+ *          Bytes that do not complete a 3-byte group are kept in the context
+ *          and encoded with the next chunk or by base64_encode_final().
+ *
+ * @param   ctx         Pointer to the encoding context.
+ * @param   src         Pointer to the chunk of source data.
+ * @param   src_len     Length of the chunk.
+ * @param   dst         Pointer to the destination buffer, at least
+ *                      BASE64_ENCODE_UPDATE_MAX(src_len) bytes long.
+ *
+ * @return  Number of characters written to dst.
+ */
+size_t base64_encode_update(Base64EncodeCtx_t *ctx, const unsigned char *src, size_t src_len, char *dst);
+
+/**
+ * @brief   Finishes an incremental base64 encoding, flushing the carried bytes
+ *          with padding.
+ *
+ * @param   ctx         Pointer to the encoding context.
+ * @param   dst         Pointer to the destination buffer, at least
+ *                      BASE64_ENCODE_FINAL_MAX bytes long.
+ *
+ * @return  Number of characters written to dst (0 or 4).
+ */
+size_t base64_encode_final(Base64EncodeCtx_t *ctx, char *dst);
+
+/**
+ * @brief   Base64 decodes a given source string.
+ *
+ * @param   src         Pointer to the encoded data, a multiple of 4 characters.
+ * @param   src_len     Length of the encoded data.
+ * @param   dst         Pointer to the destination buffer for the decoded data.
+ * @param   dst_len     Pointer to a variable storing the length of the destination buffer.
+ *                      After decoding, this variable will be updated with the actual decoded length.
+ *
+ * @return  0 on success, -1 if the destination buffer is too small,
+ *          -2 if the source is not valid base64.
+ */
+int base64_decode(const char *src, size_t src_len, unsigned char *dst, size_t *dst_len);
+
 #endif  // BASE64_UTILS_H
 
 /********************************* END OF FILE ********************************/
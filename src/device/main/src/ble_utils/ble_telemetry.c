@@ -0,0 +1,225 @@
+/*******************************************************************************
+ * @file        ble_telemetry.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../ble_utils/ble_telemetry.h"
+
+#if ENABLE_BLE
+
+extern Motor motor1;
+extern Motor motor2;
+extern TaskHandle_t bleNotificationTask;
+
+// cbc8c280-156f-423c-aade-a47cdcd09402
+static const ble_uuid128_t telemetry_svc_uuid =
+    BLE_UUID128_INIT(0x02, 0x94, 0xd0, 0xdc, 0x7c, 0xa4, 0xde, 0xaa, 0x3c, 0x42, 0x6f, 0x15, 0x80, 0xc2, 0xc8, 0xcb);
+
+// 36b75d52-0293-4c9b-af9f-76e37d97f93c
+static const ble_uuid128_t telemetry_sensors_uuid =
+    BLE_UUID128_INIT(0x3c, 0xf9, 0x97, 0x7d, 0xe3, 0x76, 0x9f, 0xaf, 0x9b, 0x4c, 0x93, 0x02, 0x52, 0x5d, 0xb7, 0x36);
+
+// 259941b0-b3d2-4371-b7f7-f7b9b52ee359
+static const ble_uuid128_t telemetry_motors_uuid =
+    BLE_UUID128_INIT(0x59, 0xe3, 0x2e, 0xb5, 0xb9, 0xf7, 0xf7, 0xb7, 0x71, 0x43, 0xd2, 0xb3, 0xb0, 0x41, 0x99, 0x25);
+
+// 3e6ac7f9-0469-4b7d-bdfc-c0415af2faa7
+static const ble_uuid128_t telemetry_system_uuid =
+    BLE_UUID128_INIT(0xa7, 0xfa, 0xf2, 0x5a, 0x41, 0xc0, 0xfc, 0xbd, 0x7d, 0x4b, 0x69, 0x04, 0xf9, 0xc7, 0x6a, 0x3e);
+
+// 01012b4e-0e44-4db1-9dcf-ac980dbbd6d5
+static const ble_uuid128_t telemetry_classifier_uuid =
+    BLE_UUID128_INIT(0xd5, 0xd6, 0xbb, 0x0d, 0x98, 0xac, 0xcf, 0x9d, 0xb1, 0x4d, 0x44, 0x0e, 0x4e, 0x2b, 0x01, 0x01);
+
+static uint16_t sensorsHandle;
+static uint16_t motorsHandle;
+static uint16_t systemHandle;
+static uint16_t classifierHandle;
+
+// BleTelemetryChr_t flags of the characteristics to notify
+static atomic_uint pending;
+
+static void put_u16(uint8_t *out, uint16_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t *out, uint32_t value)
+{
+    put_u16(out, (uint16_t)value);
+    put_u16(out + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t angle_tenths(float angle)
+{
+    return (uint16_t)(angle * 10.0f + 0.5f);
+}
+
+static void read_sensors(uint8_t out[BLE_TELEMETRY_SENSORS_LEN])
+{
+    out[0] = (getSmokeSensorState() ? 1 << 0 : 0) |
+             (getPirState() ? 1 << 1 : 0) |
+             (getLdrState() ? 1 << 2 : 0) |
+             (getLedState() ? 1 << 3 : 0);
+}
+
+static void read_motors(uint8_t out[BLE_TELEMETRY_MOTORS_LEN])
+{
+    MotorState state1;
+    MotorState state2;
+    get_motor_state(&motor1, &state1);
+    get_motor_state(&motor2, &state2);
+
+    put_u16(&out[0], angle_tenths(state1.angle));
+    put_u16(&out[2], angle_tenths(state2.angle));
+    put_u16(&out[4], angle_tenths(state1.target));
+    put_u16(&out[6], angle_tenths(state2.target));
+    out[8] = (state1.is_active ? 1 << 0 : 0) | (state2.is_active ? 1 << 1 : 0);
+}
+
+static void read_system(uint8_t out[BLE_TELEMETRY_SYSTEM_LEN])
+{
+    put_u32(&out[0], (uint32_t)(esp_timer_get_time() / 1000000));
+    put_u32(&out[4], esp_get_free_heap_size());
+}
+
+static void read_classifier(uint8_t out[BLE_TELEMETRY_CLASSIFIER_LEN])
+{
+    ClassifierStatus_t status;
+    classifier_get_status(&status);
+
+    put_u16(&out[0], status.score);
+    out[2] = status.topClass;
+    out[3] = status.ready;
+}
+
+// Reads and notifications both build the value here, nothing is cached
+static int telemetry_chr_access(uint16_t conn_handle, uint16_t attr_handle,
+                                struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    uint8_t value[BLE_TELEMETRY_MOTORS_LEN];
+    size_t len;
+
+    if (ctxt->op != BLE_GATT_ACCESS_OP_READ_CHR)
+    {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    switch ((BleTelemetryChr_t)(uintptr_t)arg)
+    {
+        case BLE_TELEMETRY_SENSORS:
+            read_sensors(value);
+            len = BLE_TELEMETRY_SENSORS_LEN;
+            break;
+        case BLE_TELEMETRY_MOTORS:
+            read_motors(value);
+            len = BLE_TELEMETRY_MOTORS_LEN;
+            break;
+        case BLE_TELEMETRY_SYSTEM:
+            read_system(value);
+            len = BLE_TELEMETRY_SYSTEM_LEN;
+            break;
+        case BLE_TELEMETRY_CLASSIFIER:
+            read_classifier(value);
+            len = BLE_TELEMETRY_CLASSIFIER_LEN;
+            break;
+        default:
+            return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    return os_mbuf_append(ctxt->om, value, len) == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+static const struct ble_gatt_svc_def telemetry_svcs[] = {
+    {
+        .type = BLE_GATT_SVC_TYPE_PRIMARY,
+        .uuid = &telemetry_svc_uuid.u,
+        .characteristics = (struct ble_gatt_chr_def[]){
+            {
+                .uuid = &telemetry_sensors_uuid.u,
+                .access_cb = telemetry_chr_access,
+                .arg = (void *)BLE_TELEMETRY_SENSORS,
+                .val_handle = &sensorsHandle,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+            },
+            {
+                .uuid = &telemetry_motors_uuid.u,
+                .access_cb = telemetry_chr_access,
+                .arg = (void *)BLE_TELEMETRY_MOTORS,
+                .val_handle = &motorsHandle,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+            },
+            {
+                .uuid = &telemetry_system_uuid.u,
+                .access_cb = telemetry_chr_access,
+                .arg = (void *)BLE_TELEMETRY_SYSTEM,
+                .val_handle = &systemHandle,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+            },
+            {
+                .uuid = &telemetry_classifier_uuid.u,
+                .access_cb = telemetry_chr_access,
+                .arg = (void *)BLE_TELEMETRY_CLASSIFIER,
+                .val_handle = &classifierHandle,
+                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+            },
+            {
+                0, /* No more characteristics in this service */
+            }},
+    },
+    {
+        0, /* No more services */
+    },
+};
+
+int ble_telemetry_init(void)
+{
+    int rc = ble_gatts_count_cfg(telemetry_svcs);
+    if (rc != 0)
+    {
+        return rc;
+    }
+    return ble_gatts_add_svcs(telemetry_svcs);
+}
+
+void ble_telemetry_changed(uint32_t chrs)
+{
+    atomic_fetch_or_explicit(&pending, chrs, memory_order_relaxed);
+    if (bleNotificationTask != NULL)
+    {
+        xTaskNotifyGive(bleNotificationTask);
+    }
+}
+
+void ble_telemetry_send(void)
+{
+    uint32_t chrs = atomic_exchange_explicit(&pending, 0, memory_order_relaxed);
+
+    // NimBLE notifies every subscribed client, reading the value through telemetry_chr_access()
+    if (chrs & BLE_TELEMETRY_SENSORS)
+    {
+        ble_gatts_chr_updated(sensorsHandle);
+    }
+    if (chrs & BLE_TELEMETRY_MOTORS)
+    {
+        ble_gatts_chr_updated(motorsHandle);
+    }
+    if (chrs & BLE_TELEMETRY_SYSTEM)
+    {
+        ble_gatts_chr_updated(systemHandle);
+    }
+    if (chrs & BLE_TELEMETRY_CLASSIFIER)
+    {
+        ble_gatts_chr_updated(classifierHandle);
+    }
+}
+
+#endif /* ENABLE_BLE */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
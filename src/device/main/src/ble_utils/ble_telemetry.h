@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * @file        ble_telemetry.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       BLE GATT service exposing the device state as fixed layout binary
+ *              characteristics, readable and notified on change.
+ *
+ *              Service cbc8c280-156f-423c-aade-a47cdcd09402, little endian values:
+ *                Sensors 36b75d52-0293-4c9b-af9f-76e37d97f93c, 1 byte:
+ *                  bit 0 smoke, bit 1 PIR, bit 2 LDR, bit 3 LEDs
+ *                Motors  259941b0-b3d2-4371-b7f7-f7b9b52ee359, 9 bytes:
+ *                  uint16 angle 1, uint16 angle 2, uint16 target 1, uint16 target 2
+ *                  (tenths of a degree), uint8 active flags (bit 0 motor 1, bit 1 motor 2)
+ *                System  3e6ac7f9-0469-4b7d-bdfc-c0415af2faa7, 8 bytes:
+ *                  uint32 uptime in seconds, uint32 free heap in bytes
+ *                Classifier 01012b4e-0e44-4db1-9dcf-ac980dbbd6d5, 4 bytes:
+ *                  uint16 score per mille, uint8 top class, uint8 model loaded
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef BLE_TELEMETRY_H_
+#define BLE_TELEMETRY_H_
+
+#include "settings.h"
+
+#if ENABLE_BLE
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "host/ble_hs.h"
+#include "host/ble_uuid.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../gpio_state/gpio_state.h"
+#include "../motor_control/motor_control.h"
+#include "../classifier/classifier.h"
+
+// The system characteristic is notified this often, the others on change
+#define BLE_TELEMETRY_SYSTEM_PERIOD pdMS_TO_TICKS(10000)
+
+#define BLE_TELEMETRY_SENSORS_LEN 1
+#define BLE_TELEMETRY_MOTORS_LEN 9
+#define BLE_TELEMETRY_SYSTEM_LEN 8
+#define BLE_TELEMETRY_CLASSIFIER_LEN 4
+
+/**
+ * @brief Characteristics of the telemetry service, used as change flags.
+ */
+typedef enum
+{
+    BLE_TELEMETRY_SENSORS = 1 << 0,
+    BLE_TELEMETRY_MOTORS = 1 << 1,
+    BLE_TELEMETRY_SYSTEM = 1 << 2,
+    BLE_TELEMETRY_CLASSIFIER = 1 << 3
+} BleTelemetryChr_t;
+
+/**
+ * @brief Registers the telemetry service. Called by gatt_svr_init().
+ *
+ * @return 0 on success, a NimBLE error code otherwise.
+ */
+int ble_telemetry_init(void);
+
+/**
+ * @brief Marks characteristics as changed and wakes the BLE notification task.
+ * Never blocks, may be called from any task.
+ *
+ * @param chrs BleTelemetryChr_t flags of the changed characteristics.
+ */
+void ble_telemetry_changed(uint32_t chrs);
+
+/**
+ * @brief Notifies the subscribed clients of the characteristics marked as changed.
+ * Called by the BLE notification task.
+ */
+void ble_telemetry_send(void);
+
+#endif /* ENABLE_BLE */
+
+#endif /* BLE_TELEMETRY_H_ */
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -7,9 +7,10 @@
  *              Based on https://github.com/Zeni241/ESP32-NimbleBLE-For-Dummies.git.
  *
  *******************************************************************************/
-#if ENABLE_BLE
 #include "../ble_utils/ble_utils.h"
 
+#if ENABLE_BLE
+
 esp_err_t ret;
 static uint8_t own_addr_type;
 uint16_t notification_handle;
@@ -17,6 +18,10 @@ uint16_t conn_handle;
 bool notify_state; // When client subscribe to notifications, the value is set to 1.Check this value before sending notifictions.
 char notification[MAX_NOTIFICATION_LEN];
 
+static size_t notificationLen;                // Bytes of notification not sent yet
+static SemaphoreHandle_t notificationMutex;   // Protects notification and notificationLen
+static char notificationOut[MAX_NOTIFICATION_LEN];   // Copy being sent by sendNotification()
+
 //**************************Define UUIDs***************************************/
 // 860480f2-d1b2-428a-ab2c-cd0d9087a84f
 static const ble_uuid128_t gatt_svr_svc_uuid =
@@ -54,17 +59,51 @@ static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
     },
 };
 
+// Wake the notification task, it sends the pending data after BLE_NOTIFY_COALESCE
+static void notification_changed(void)
+{
+    if (bleNotificationTask != NULL)
+    {
+        xTaskNotifyGive(bleNotificationTask);
+    }
+}
+
 void ble_printf(const char *format, ...)
 {
-    // Clear the notification buffer
-    memset(notification, 0, MAX_NOTIFICATION_LEN);
+    xSemaphoreTake(notificationMutex, portMAX_DELAY);
+
+    // Append to what has not been sent yet, the end is cut when the buffer is full
+    size_t room = MAX_NOTIFICATION_LEN - notificationLen;
+    if (room > 1)
+    {
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(&notification[notificationLen], room, format, args);
+        va_end(args);
+        if (len > 0)
+        {
+            notificationLen += (size_t)len < room ? (size_t)len : room - 1;
+        }
+    }
 
-    va_list args;
-    va_start(args, format);
-    vsnprintf(notification, MAX_NOTIFICATION_LEN, format, args);
-    va_end(args);
+    xSemaphoreGive(notificationMutex);
+    notification_changed();
 }
 
+void ble_write(const uint8_t *data, size_t len)
+{
+    xSemaphoreTake(notificationMutex, portMAX_DELAY);
+
+    if (len > MAX_NOTIFICATION_LEN - notificationLen)
+    {
+        len = MAX_NOTIFICATION_LEN - notificationLen;
+    }
+    memcpy(&notification[notificationLen], data, len);
+    notificationLen += len;
+
+    xSemaphoreGive(notificationMutex);
+    notification_changed();
+}
 
 static int gatt_svr_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                                struct ble_gatt_access_ctxt *ctxt,
@@ -97,25 +136,45 @@ int x=strcmp(characteristic_received_value,stp);
   }
 }
 
-void sendNotification() //!Use this function to send notification once (after setting value of variable "notification")
+void sendNotification()
 {
-  int rc;
-  struct os_mbuf *om;
-
-  if (notify_state) // This value is checked so that we don't send notifications if user has not subscribed to our notification handle.
+  // Take the pending data, the writers can append again while it is sent
+  xSemaphoreTake(notificationMutex, portMAX_DELAY);
+  size_t len = notificationLen;
+  memcpy(notificationOut, notification, len);
+  notificationLen = 0;
+  xSemaphoreGive(notificationMutex);
+
+  // Nothing is logged here, the log is one of the sources of the notifications
+  if (!notify_state || len == 0) // This value is checked so that we don't send notifications if user has not subscribed to our notification handle.
   {
-    om = ble_hs_mbuf_from_flat(notification, sizeof(notification)); // Value of variable "notification" will be sent as notification.
+    return;
+  }
 
-    rc = ble_gattc_notify_custom(conn_handle, notification_handle, om);
+  // A notification carries at most ATT_MTU - 3 bytes, send the rest in more of them
+  uint16_t mtu = ble_att_mtu(conn_handle);
+  size_t fragment = mtu > BLE_ATT_NOTIFY_HEADER_SIZE ? mtu - BLE_ATT_NOTIFY_HEADER_SIZE : BLE_ATT_MTU_DFLT - BLE_ATT_NOTIFY_HEADER_SIZE;
 
+  uint8_t retries = 0;
+  for (size_t sent = 0; sent < len;)
+  {
+    size_t n = len - sent < fragment ? len - sent : fragment;
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(&notificationOut[sent], n);
+    int rc = om != NULL ? ble_gatts_notify_custom(conn_handle, notification_handle, om) : BLE_HS_ENOMEM;
+
+    if (rc == BLE_HS_ENOMEM && retries++ < BLE_NOTIFY_RETRIES)
+    {
+      // The host is out of buffers until the controller sends the previous fragments
+      vTaskDelay(BLE_NOTIFY_RETRY_DELAY);
+      continue;
+    }
     if (rc != 0)
     {
-      ESP_LOGI(BLE_TAG,"\n error notifying; rc\n");
+      // Disconnected, unsubscribed or still out of buffers, drop the rest
+      return;
     }
-  }
-  else
-  {
-    ESP_LOGI(BLE_TAG,"user not subscribed to notifications.\n");
+    sent += n;
+    retries = 0;
   }
 }
 
@@ -128,6 +187,9 @@ void startBLE() //! Call this function to start BLE
 
   ESP_ERROR_CHECK(ret);
 
+  notificationMutex = xSemaphoreCreateMutex();
+  assert(notificationMutex != NULL);
+
   ESP_ERROR_CHECK(nimble_port_init());
 
   /* Initialize the NimBLE host configuration. */
@@ -256,7 +318,8 @@ int gatt_svr_init(void)
     return rc;
   }
 
-  return 0;
+  // Binary sensor, motor and system characteristics
+  return ble_telemetry_init();
 }
 
 static void
@@ -393,6 +456,7 @@ bleprph_gap_event(struct ble_gap_event *event, void *arg)
     MODLOG_DFLT(INFO, "disconnect; reason=%d ", event->disconnect.reason);
     bleprph_print_conn_desc(&event->disconnect.conn);
     MODLOG_DFLT(INFO, "\n");
+    notify_state = false;
 
     /* Connection terminated; resume advertising. */
     bleprph_advertise();
@@ -500,4 +564,4 @@ void bleprph_host_task(void *param)
 #endif /* ENABLE_BLE */
 
 /********************************* END OF FILE ********************************/
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
\ No newline at end of file
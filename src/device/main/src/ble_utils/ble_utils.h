@@ -24,17 +24,36 @@
 #include "services/gap/ble_svc_gap.h"
 #include "services/gatt/ble_svc_gatt.h"
 #include <stdarg.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 #include "../ble_utils/bleprph.h"
+#include "../ble_utils/ble_telemetry.h"
 #include "../logging/logging_utils.h"
 
 #define MAX_NOTIFICATION_LEN 1024
 
+// The notification task waits this long after a change for more data to send along
+#define BLE_NOTIFY_COALESCE pdMS_TO_TICKS(20)
+
+// Wait before retrying a fragment the host had no buffer for, at most BLE_NOTIFY_RETRIES times
+#define BLE_NOTIFY_RETRY_DELAY pdMS_TO_TICKS(10)
+#define BLE_NOTIFY_RETRIES 10
+
+// ATT opcode and attribute handle in front of the value of a notification
+#define BLE_ATT_NOTIFY_HEADER_SIZE 3
+
 extern uint16_t notification_handle;
 extern uint16_t conn_handle;
 extern bool notify_state;
 extern char notification[MAX_NOTIFICATION_LEN];
 
+/**
+ * @brief Handle of the BLE notification task, defined in task_utils.c.
+ */
+extern TaskHandle_t bleNotificationTask;
+
 /**
  * @brief Start the BLE operation and advertise the device.
  */
@@ -50,12 +69,24 @@ void stopBLE();
  *
  * This function works similarly to printf. It accepts a format string and a variable number of arguments,
  * formats them, and sends the formatted message as a BLE notification.
+ * The message is appended to the data not sent yet and the notification task is woken. Messages
+ * written within BLE_NOTIFY_COALESCE of each other go out together.
  *
  * @param format The format string for the message.
  * @param ... The variable arguments to be formatted.
  */
 void ble_printf(const char *format, ...);
 
+/**
+ * @brief Append raw bytes to the notification, like ble_printf().
+ *
+ * Used by the log sink, whose batches may hold binary log records.
+ *
+ * @param data Bytes to send, cut to MAX_NOTIFICATION_LEN.
+ * @param len Number of bytes.
+ */
+void ble_write(const uint8_t *data, size_t len);
+
 /**
  * @brief Initialize the BLE storage configuration.
  */
@@ -135,16 +166,15 @@ static void bleprph_on_sync(void);
 void gatt_svr_register_cb(struct ble_gatt_register_ctxt *ctxt, void *arg);
 
 /**
- * @brief Sends a notification to the connected client if subscribed.
+ * @brief Sends the data written with ble_printf() or ble_write() since the last call.
  *
  * This function sends a notification to the connected client if the client has subscribed
  * to the notification handle. It checks the `notify_state` variable to ensure that the client
  * has subscribed before attempting to send the notification. If the client is not subscribed,
- * the function will do nothing.
+ * the pending data is discarded.
  *
- * The notification data to be sent is assumed to be already set in the global variable "notification".
- * Ensure that the "notification" buffer is properly formatted and contains the data to be sent
- * before calling this function.
+ * Only the bytes actually written are sent, split into notifications of the negotiated
+ * ATT MTU minus 3 bytes. Called by the BLE notification task.
  *
  * @note Make sure to set the value of "notify_state" appropriately when handling client subscriptions.
  *       Otherwise, notifications will not be sent even if "notification" contains valid data.
@@ -22,14 +22,134 @@ static long data_num = 0;
 static const esp_spp_sec_t sec_mask = ESP_SPP_SEC_AUTHENTICATE;
 static const esp_spp_role_t role_slave = ESP_SPP_ROLE_SLAVE;
 
-void bt_printf(const char *format, ...)
+// Transmit queue, written by any task and sent from the SPP callback
+static uint8_t txQueue[BT_TX_QUEUE_SIZE];
+static uint32_t txReserved;     // Bytes ever reserved by the writers
+static uint32_t txHead;         // Bytes ever queued, up to txReserved once no writer is copying
+static uint32_t txTail;         // Bytes ever acknowledged
+static uint32_t txInFlight;     // Bytes of the write not acknowledged yet, 0 when idle
+static uint32_t txCopying;      // Writers copying into their reserved space
+static bool txCongested;
+static BtTxStats_t txStats;
+static portMUX_TYPE txLock = portMUX_INITIALIZER_UNLOCKED;   // Protects the queue state
+
+// Start the next write if the link is free, called by the writers and the SPP callback
+static void bt_tx_send_next(void)
+{
+    uint32_t handle;
+    uint32_t start = 0;
+    uint32_t len = 0;
+
+    portENTER_CRITICAL(&txLock);
+    handle = connection_handle;
+    if (handle != 0 && txInFlight == 0 && !txCongested && txHead != txTail) {
+        // A single write ends at the end of the buffer, the rest goes in the next one
+        start = txTail & (BT_TX_QUEUE_SIZE - 1);
+        len = txHead - txTail;
+        if (len > BT_TX_QUEUE_SIZE - start) {
+            len = BT_TX_QUEUE_SIZE - start;
+        }
+        if (len > BT_TX_WRITE_MAX) {
+            len = BT_TX_WRITE_MAX;
+        }
+        txInFlight = len;
+        txStats.writes++;
+    }
+    portEXIT_CRITICAL(&txLock);
+
+    // The stack copies the data, the bytes stay queued until ESP_SPP_WRITE_EVT
+    if (len > 0 && esp_spp_write(handle, len, &txQueue[start]) != ESP_OK) {
+        portENTER_CRITICAL(&txLock);
+        txInFlight = 0;
+        portEXIT_CRITICAL(&txLock);
+    }
+}
+
+// Acknowledge a write reported by ESP_SPP_WRITE_EVT. The stack may acknowledge
+// a write in parts, the next write starts once all of it is acknowledged. A
+// failed write is dropped rather than retried, so the queue keeps moving
+static void bt_tx_write_done(bool success, uint32_t len, bool congested)
+{
+    bool idle;
+
+    portENTER_CRITICAL(&txLock);
+    if (!success || len > txInFlight) {
+        len = txInFlight;
+    }
+    txTail += len;
+    txInFlight -= len;
+    if (success) {
+        txStats.sent += len;
+    } else {
+        txStats.dropped += len;
+    }
+    if (congested && !txCongested) {
+        txStats.congestions++;
+    }
+    txCongested = congested;
+    idle = txInFlight == 0;
+    portEXIT_CRITICAL(&txLock);
+
+    if (idle) {
+        bt_tx_send_next();
+    }
+}
+
+// Forget everything queued for a connection that went away. Data still being
+// copied by a writer is queued for the next connection
+static void bt_tx_reset(void)
 {
-    // Check if the connection handle is valid
-    if (connection_handle == NULL) {
-        printf("Bluetooth connection handle is not valid. Cannot send data.\n");
+    portENTER_CRITICAL(&txLock);
+    txTail = txHead;
+    txInFlight = 0;
+    txCongested = false;
+    portEXIT_CRITICAL(&txLock);
+}
+
+void bt_write(const uint8_t *data, size_t len)
+{
+    // Silently skip the data until a device connects, the log sink calls this for every batch
+    if (connection_handle == 0 || len == 0) {
         return;
     }
 
+    // Reserve the space under the lock and copy outside of it. The data is
+    // queued when the last writer copying finishes, so a write never makes
+    // the space of a slower writer visible to the sender
+    portENTER_CRITICAL(&txLock);
+    if (len > BT_TX_QUEUE_SIZE - (txReserved - txTail)) {
+        txStats.dropped += len;
+        portEXIT_CRITICAL(&txLock);
+        return;
+    }
+    uint32_t start = txReserved & (BT_TX_QUEUE_SIZE - 1);
+    txReserved += len;
+    txCopying++;
+    portEXIT_CRITICAL(&txLock);
+
+    size_t first = len < BT_TX_QUEUE_SIZE - start ? len : BT_TX_QUEUE_SIZE - start;
+    memcpy(&txQueue[start], data, first);
+    memcpy(txQueue, data + first, len - first);
+
+    portENTER_CRITICAL(&txLock);
+    if (--txCopying == 0) {
+        txHead = txReserved;
+    }
+    portEXIT_CRITICAL(&txLock);
+
+    bt_tx_send_next();
+}
+
+void bt_get_tx_stats(BtTxStats_t *stats)
+{
+    portENTER_CRITICAL(&txLock);
+    *stats = txStats;
+    stats->queued = txHead - txTail;
+    portEXIT_CRITICAL(&txLock);
+}
+
+void bt_printf(const char *format, ...)
+{
     // Create a buffer to hold the formatted string
     char buffer[BT_TX_BUFFER_SIZE];
 
@@ -42,8 +162,8 @@ void bt_printf(const char *format, ...)
     // Print the formatted string to the console for debugging (optional)
     //printf("Formatted string: %s", buffer);
 
-    // Send the formatted string through Bluetooth
-    esp_spp_write(connection_handle, strlen(buffer), (uint8_t *)buffer);
+    // Queue the formatted string, it is sent through Bluetooth as the link allows
+    bt_write((const uint8_t *)buffer, strlen(buffer));
 }
 
 static char *bda2str(uint8_t * bda, char *str, size_t size)
@@ -95,6 +215,10 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
     case ESP_SPP_CLOSE_EVT:
         ESP_LOGI(BT_TAG, "ESP_SPP_CLOSE_EVT status:%d handle:%"PRIu32" close_by_remote:%d", param->close.status,
                  param->close.handle, param->close.async);
+        if (param->close.handle == connection_handle) {
+            connection_handle = 0;
+            bt_tx_reset();
+        }
         break;
         /*********************************************************************************************************/
     case ESP_SPP_START_EVT:
@@ -140,17 +264,25 @@ static void esp_spp_cb(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
         break;
         /*********************************************************************************************************/
     case ESP_SPP_CONG_EVT:
-        ESP_LOGI(BT_TAG, "ESP_SPP_CONG_EVT");
+        // Not logged, the log itself goes out through this link. See bt_get_tx_stats()
+        portENTER_CRITICAL(&txLock);
+        if (param->cong.cong && !txCongested) {
+            txStats.congestions++;
+        }
+        txCongested = param->cong.cong;
+        portEXIT_CRITICAL(&txLock);
+        bt_tx_send_next();
         break;
         /*********************************************************************************************************/
     case ESP_SPP_WRITE_EVT:
-        //ESP_LOGI(BT_TAG, "ESP_SPP_WRITE_EVT");
+        bt_tx_write_done(param->write.status == ESP_SPP_SUCCESS, param->write.len, param->write.cong);
         break;
         /*********************************************************************************************************/
     case ESP_SPP_SRV_OPEN_EVT:
         //This event indicates that the SPP server has been opened, 
         //and the connection handle is provided as a parameter.
         // Store the connection handle for future reference
+        bt_tx_reset();
         connection_handle = param->srv_open.handle;
         ESP_LOGI(BT_TAG, "ESP_SPP_SRV_OPEN_EVT status:%d handle:%"PRIu32", rem_bda:[%s]", param->srv_open.status,
                  param->srv_open.handle, bda2str(param->srv_open.rem_bda, bda_str, sizeof(bda_str)));
@@ -302,4 +434,4 @@ void init_bluetooth(esp_err_t ret){
 #endif /* ENABLE_BT */
 
 /********************************* END OF FILE ********************************/
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
\ No newline at end of file
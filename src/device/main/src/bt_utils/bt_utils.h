@@ -46,6 +46,24 @@
 
 #define BT_TX_BUFFER_SIZE 256
 
+// Bytes waiting to be sent over SPP, a power of 2
+#define BT_TX_QUEUE_SIZE 4096
+
+// Largest single esp_spp_write(), the SPP MTU
+#define BT_TX_WRITE_MAX ESP_SPP_MAX_MTU
+
+/**
+ * @brief Counters of the SPP transmit queue.
+ */
+typedef struct
+{
+    uint32_t queued;        /*< Bytes waiting in the queue now                 */
+    uint32_t sent;          /*< Bytes acknowledged by ESP_SPP_WRITE_EVT        */
+    uint32_t dropped;       /*< Bytes discarded because the queue was full     */
+    uint32_t writes;        /*< esp_spp_write() calls                          */
+    uint32_t congestions;   /*< Times the link reported congestion             */
+} BtTxStats_t;
+
 /**
  * @brief Prints formatted data through Bluetooth.
  *
@@ -64,9 +82,29 @@
  * @note The maximum length of the formatted data that can be sent over Bluetooth is determined
  *       by the BT_TX_BUFFER_SIZE constant defined in the bt_utils.h file. If the formatted data
  *       exceeds this size, it may be truncated.
+ *
+ * @note The data goes through the transmit queue, see bt_write().
  */
 void bt_printf(const char *format, ...);
 
+/**
+ * @brief Queues raw bytes to be sent through Bluetooth SPP.
+ *
+ * Never waits for the link. The queue is sent in writes of up to BT_TX_WRITE_MAX bytes,
+ * the next one starting when ESP_SPP_WRITE_EVT reports the previous one done and the link
+ * is not congested. Data that does not fit in the queue is dropped as a whole and counted.
+ * Nothing is queued while no device is connected.
+ *
+ * @param data Bytes to send.
+ * @param len  Number of bytes.
+ */
+void bt_write(const uint8_t *data, size_t len);
+
+/**
+ * @brief Copies the counters of the SPP transmit queue.
+ */
+void bt_get_tx_stats(BtTxStats_t *stats);
+
 /**
  * @brief Initialize the Bluetooth functionality.
  * 
@@ -9,6 +9,24 @@
 
 #include "../camera/camera_utils.h"
 
+#define FRAME_READY_BIT BIT0
+
+// Sensor mode selected by startX in the OV2640 set_res_raw(), UXGA reads the whole array
+#define OV2640_MODE_UXGA 0
+
+static CameraFrameSlot_t frameSlots[CAMERA_FRAME_SLOTS];
+static int latestSlot = -1;          // Index of the latest frame, -1 before the first capture
+static uint32_t frameSeq = 0;        // Sequence number of the last published frame
+
+static framesize_t frameSize = CAMERA_FRAME_SIZE;    // Setting the sensor returns to after a window
+static int frameQuality = CAMERA_JPEG_QUALITY;
+static bool windowActive = false;    // The sensor is set to a window
+static uint8_t dropFrames = 0;       // Frames to drop before publishing again
+
+static SemaphoreHandle_t frameMutex;     // Protects the frame ring, the sensor setting and the window state
+static SemaphoreHandle_t freeSlots;      // Counts the slots the capture task can still fill
+static EventGroupHandle_t frameEvents;   // Signals consumers waiting for a new frame
+
 // Function to initialize the camera
 esp_err_t init_camera(void)
 {
@@ -37,10 +55,11 @@ esp_err_t init_camera(void)
         .ledc_timer = LEDC_TIMER_0,
         .ledc_channel = LEDC_CHANNEL_0,
         .pixel_format = PIXFORMAT_JPEG,
-        .frame_size = FRAMESIZE_VGA,
-        .jpeg_quality = 10,
-        .fb_count = 1,
-        .grab_mode = CAMERA_GRAB_WHEN_EMPTY // Sets when buffers should be filled
+        .frame_size = CAMERA_FRAME_SIZE,
+        .jpeg_quality = CAMERA_JPEG_QUALITY,
+        .fb_count = CAMERA_FB_COUNT,
+        .fb_location = CAMERA_FB_IN_PSRAM,
+        .grab_mode = CAMERA_GRAB_LATEST // Always hand out the most recent frame
     };
 
     esp_err_t err = esp_camera_init(&camera_config);
@@ -48,9 +67,282 @@ esp_err_t init_camera(void)
     {
         return err;
     }
+
+    frameMutex = xSemaphoreCreateMutex();
+    freeSlots = xSemaphoreCreateCounting(CAMERA_FRAME_SLOTS, CAMERA_FRAME_SLOTS);
+    frameEvents = xEventGroupCreate();
+    if (frameMutex == NULL || freeSlots == NULL || frameEvents == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
     return ESP_OK;
 }
 
+// Give a slot's buffer back to the driver. frameMutex must be held.
+static void return_slot(CameraFrameSlot_t *slot)
+{
+    esp_camera_fb_return(slot->fb);
+    slot->fb = NULL;
+    slot->refcount = 0;
+    xSemaphoreGive(freeSlots);
+}
+
+esp_err_t camera_capture_frame(void)
+{
+    // Wait until a slot is free so the driver always keeps a buffer to fill
+    xSemaphoreTake(freeSlots, portMAX_DELAY);
+
+    camera_fb_t *fb = esp_camera_fb_get();
+    if (!fb)
+    {
+        xSemaphoreGive(freeSlots);
+        return ESP_FAIL;
+    }
+
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+
+    // Read out before the last change of the sensor took effect
+    if (dropFrames > 0)
+    {
+        dropFrames--;
+        esp_camera_fb_return(fb);
+        xSemaphoreGive(frameMutex);
+        xSemaphoreGive(freeSlots);
+        return ESP_OK;
+    }
+
+    int slot = 0;
+    while (frameSlots[slot].fb != NULL)
+    {
+        slot++;
+    }
+
+    if (++frameSeq == 0)
+    {
+        frameSeq = 1; // 0 is reserved for "no frame seen yet"
+    }
+    frameSlots[slot].fb = fb;
+    frameSlots[slot].seq = frameSeq;
+    frameSlots[slot].refcount = 0;
+    frameSlots[slot].windowed = windowActive;
+
+    // The previous frame goes back to the driver once nobody borrows it
+    if (latestSlot >= 0 && frameSlots[latestSlot].refcount == 0)
+    {
+        return_slot(&frameSlots[latestSlot]);
+    }
+    latestSlot = slot;
+
+    xSemaphoreGive(frameMutex);
+
+    // Wake every waiting consumer, then rearm for the next frame
+    xEventGroupSetBits(frameEvents, FRAME_READY_BIT);
+    xEventGroupClearBits(frameEvents, FRAME_READY_BIT);
+
+    return ESP_OK;
+}
+
+// Borrow the latest frame if it is not the one identified by seq and was
+// read out of a window or not, as asked
+static camera_fb_t *acquire_frame(uint32_t *seq, bool windowed, TickType_t wait)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while (true)
+    {
+        xSemaphoreTake(frameMutex, portMAX_DELAY);
+        if (latestSlot >= 0 && frameSlots[latestSlot].seq != *seq && frameSlots[latestSlot].windowed == windowed)
+        {
+            CameraFrameSlot_t *slot = &frameSlots[latestSlot];
+            slot->refcount++;
+            *seq = slot->seq;
+            xSemaphoreGive(frameMutex);
+            return slot->fb;
+        }
+
+        // Frames held back for a window do not count against the wait, the window is short
+        if (!windowed && (windowActive || dropFrames > 0))
+        {
+            start = xTaskGetTickCount();
+        }
+        xSemaphoreGive(frameMutex);
+
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= wait)
+        {
+            return NULL;
+        }
+        xEventGroupWaitBits(frameEvents, FRAME_READY_BIT, pdFALSE, pdTRUE, wait - elapsed);
+    }
+}
+
+camera_fb_t *camera_frame_acquire_next(uint32_t *seq, TickType_t wait)
+{
+    return acquire_frame(seq, false, wait);
+}
+
+camera_fb_t *camera_frame_acquire(TickType_t wait)
+{
+    uint32_t seq = 0;
+    return camera_frame_acquire_next(&seq, wait);
+}
+
+void camera_frame_release(camera_fb_t *fb)
+{
+    if (fb == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    for (int i = 0; i < CAMERA_FRAME_SLOTS; i++)
+    {
+        if (frameSlots[i].fb == fb)
+        {
+            if (frameSlots[i].refcount > 0)
+            {
+                frameSlots[i].refcount--;
+            }
+            if (frameSlots[i].refcount == 0 && i != latestSlot)
+            {
+                return_slot(&frameSlots[i]);
+            }
+            break;
+        }
+    }
+    xSemaphoreGive(frameMutex);
+}
+
+// Set the sensor to the frame setting. frameMutex must be held.
+static esp_err_t apply_frame_setting(sensor_t *sensor)
+{
+    if (sensor->set_framesize(sensor, frameSize) != 0 || sensor->set_quality(sensor, frameQuality) != 0)
+    {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t camera_set_frame_setting(framesize_t size, int quality)
+{
+    sensor_t *sensor = esp_camera_sensor_get();
+    if (sensor == NULL)
+    {
+        return ESP_FAIL;
+    }
+
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    frameSize = size;
+    frameQuality = quality;
+    esp_err_t err = windowActive ? ESP_OK : apply_frame_setting(sensor);
+    xSemaphoreGive(frameMutex);
+
+    return err;
+}
+
+esp_err_t camera_window_fit(CameraWindow_t *window, uint16_t *outputWidth, uint16_t *outputHeight)
+{
+    uint32_t right = (uint32_t)window->x + window->width;
+    uint32_t bottom = (uint32_t)window->y + window->height;
+    if (window->width == 0 || window->height == 0 ||
+        right > CAMERA_SENSOR_WIDTH || bottom > CAMERA_SENSOR_HEIGHT ||
+        window->scale > CAMERA_WINDOW_MAX_SCALE)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // The sensor size is a multiple of the alignment, moving the edges out keeps them on it
+    uint32_t left = window->x & ~(CAMERA_WINDOW_ALIGN - 1);
+    uint32_t top = window->y & ~(CAMERA_WINDOW_ALIGN - 1);
+    right = (right + CAMERA_WINDOW_ALIGN - 1) & ~(CAMERA_WINDOW_ALIGN - 1);
+    bottom = (bottom + CAMERA_WINDOW_ALIGN - 1) & ~(CAMERA_WINDOW_ALIGN - 1);
+    uint32_t width = right - left;
+    uint32_t height = bottom - top;
+
+    uint32_t scale = window->scale;
+    if (scale == 0)
+    {
+        scale = 1;
+        while (scale < CAMERA_WINDOW_MAX_SCALE && (width / scale) * (height / scale) > CAMERA_FRAME_PIXELS)
+        {
+            scale++;
+        }
+    }
+
+    uint32_t outWidth = (width / scale) & ~(CAMERA_WINDOW_ALIGN - 1);
+    uint32_t outHeight = (height / scale) & ~(CAMERA_WINDOW_ALIGN - 1);
+    if (outWidth < CAMERA_WINDOW_MIN_OUTPUT || outHeight < CAMERA_WINDOW_MIN_OUTPUT ||
+        outWidth * outHeight > CAMERA_FRAME_PIXELS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    window->x = left;
+    window->y = top;
+    window->width = width;
+    window->height = height;
+    window->scale = scale;
+    *outputWidth = outWidth;
+    *outputHeight = outHeight;
+    return ESP_OK;
+}
+
+esp_err_t camera_window_capture(CameraWindow_t *window, TickType_t wait, camera_fb_t **fb)
+{
+    uint16_t outputWidth;
+    uint16_t outputHeight;
+    esp_err_t err = camera_window_fit(window, &outputWidth, &outputHeight);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    // The meaning of the set_res_raw() arguments depends on the sensor
+    sensor_t *sensor = esp_camera_sensor_get();
+    if (sensor == NULL || sensor->id.PID != OV2640_PID)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    if (windowActive)
+    {
+        xSemaphoreGive(frameMutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // The window is given by offset and total in UXGA pixels, the DSP scales it to the output
+    int quality = frameQuality < CAMERA_WINDOW_MIN_QUALITY ? CAMERA_WINDOW_MIN_QUALITY : frameQuality;
+    if (sensor->set_res_raw(sensor, OV2640_MODE_UXGA, 0, 0, 0, window->x, window->y,
+                            window->width, window->height, outputWidth, outputHeight, false, false) != 0 ||
+        sensor->set_quality(sensor, quality) != 0)
+    {
+        apply_frame_setting(sensor);
+        dropFrames = CAMERA_WINDOW_SETTLE_FRAMES;
+        xSemaphoreGive(frameMutex);
+        return ESP_FAIL;
+    }
+    windowActive = true;
+    dropFrames = CAMERA_WINDOW_SETTLE_FRAMES;
+    uint32_t seq = frameSeq;
+    xSemaphoreGive(frameMutex);
+
+    *fb = acquire_frame(&seq, true, wait);
+
+    // The borrowed frame stays in its slot, the other consumers get frames again
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    if (apply_frame_setting(sensor) != ESP_OK)
+    {
+        ESP_LOGE(CAMERA_TAG, "Returning the sensor to the frame setting failed");
+    }
+    windowActive = false;
+    dropFrames = CAMERA_WINDOW_SETTLE_FRAMES;
+    xSemaphoreGive(frameMutex);
+
+    return *fb != NULL ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
 
 /********************************* END OF FILE ********************************/
 /******************************************************************************/
@@ -10,15 +10,169 @@
 #ifndef CAMERA_UTILS_H
 #define CAMERA_UTILS_H
 
+#include <stdbool.h>
 #include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
 #include "../camera/camera_pins.h"
+#include "../logging/logging_utils.h"
 #include "../user_roles/user_roles.h"
 
 // Frequency of XCLK pin of the camera
 #define CONFIG_XCLK_FREQ 15000000
 
+// Frame size and JPEG quality set at boot, the frame buffers are sized for them.
+// The frame controller only moves to smaller or more compressed settings from here.
+#define CAMERA_FRAME_SIZE FRAMESIZE_VGA
+#define CAMERA_JPEG_QUALITY 10
+
+// Pixels of a CAMERA_FRAME_SIZE frame, the largest output a sensor window may have
+#define CAMERA_FRAME_PIXELS (640 * 480)
+
+// Full resolution of the OV2640 sensor (UXGA), the coordinates of a sensor window
+#define CAMERA_SENSOR_WIDTH 1600
+#define CAMERA_SENSOR_HEIGHT 1200
+
+// Windows and their output span whole blocks of this many pixels
+#define CAMERA_WINDOW_ALIGN 8
+
+// Smallest width and height of the image read out of a window
+#define CAMERA_WINDOW_MIN_OUTPUT 64
+
+// Largest downscale of a window
+#define CAMERA_WINDOW_MAX_SCALE 8
+
+// Best JPEG quality used for a window. Full resolution detail compresses worse
+// than a downscaled frame, a window at the boot quality could overflow the buffers.
+#define CAMERA_WINDOW_MIN_QUALITY 12
+
+// Frames dropped after the sensor is switched to or from a window, the driver
+// still holds frames read out with the previous setting
+#define CAMERA_WINDOW_SETTLE_FRAMES 2
+
+// Number of frame buffers allocated by the camera driver in PSRAM
+#define CAMERA_FB_COUNT 3
+
+// Frames the capture task may hold at once, one buffer is always left to the driver
+#define CAMERA_FRAME_SLOTS (CAMERA_FB_COUNT - 1)
+
+// Default time a consumer waits for a frame to become available
+#define CAMERA_FRAME_TIMEOUT pdMS_TO_TICKS(1000)
+
+/**
+ * @brief Slot of the shared frame ring.
+ * A slot holds a driver frame buffer until it is no longer the latest frame
+ * and every consumer that borrowed it has released it.
+ */
+typedef struct
+{
+    camera_fb_t *fb;      /*< Driver frame buffer, NULL when the slot is free */
+    uint32_t seq;         /*< Sequence number of the frame (never 0)          */
+    uint16_t refcount;    /*< Number of consumers currently borrowing it      */
+    bool windowed;        /*< Read out of a sensor window, see camera_window_capture() */
+} CameraFrameSlot_t;
+
+/**
+ * @brief Region of the sensor read out by camera_window_capture().
+ * The coordinates are sensor pixels, see CAMERA_SENSOR_WIDTH and CAMERA_SENSOR_HEIGHT.
+ */
+typedef struct
+{
+    uint16_t x;           /*< Left edge                                       */
+    uint16_t y;           /*< Top edge                                        */
+    uint16_t width;       /*< Width of the region                             */
+    uint16_t height;      /*< Height of the region                            */
+    uint8_t scale;        /*< Downscale of the output, 0 for the smallest that fits */
+} CameraWindow_t;
+
+/**
+ * @brief Initializes the camera driver and the shared frame ring.
+ *
+ * @return ESP_OK on success, or the error returned by the camera driver.
+ */
 esp_err_t init_camera(void);
 
+/**
+ * @brief Grabs a frame from the sensor and publishes it as the latest frame.
+ * Blocks while every slot of the ring is borrowed. Meant to be called only
+ * from the camera capture task.
+ *
+ * @return ESP_OK on success, ESP_FAIL if the driver returned no frame.
+ */
+esp_err_t camera_capture_frame(void);
+
+/**
+ * @brief Borrows the latest captured frame.
+ * The frame must be given back with camera_frame_release(). Several consumers
+ * can hold the same frame at once.
+ *
+ * @param wait Ticks to wait if no frame has been captured yet.
+ * @return The frame, or NULL on timeout.
+ */
+camera_fb_t *camera_frame_acquire(TickType_t wait);
+
+/**
+ * @brief Borrows the latest captured frame if it is newer than a known one.
+ * Waits for the capture task when the latest frame is the one identified by seq.
+ *
+ * @param seq  In: sequence number of the last frame seen (0 for any frame).
+ *             Out: sequence number of the returned frame.
+ * @param wait Ticks to wait for a newer frame.
+ * @return The frame, or NULL on timeout.
+ */
+camera_fb_t *camera_frame_acquire_next(uint32_t *seq, TickType_t wait);
+
+/**
+ * @brief Gives back a frame obtained with camera_frame_acquire().
+ *
+ * @param fb The borrowed frame.
+ */
+void camera_frame_release(camera_fb_t *fb);
+
+/**
+ * @brief Sets the frame size and JPEG quality of the frames.
+ * While a window is read out the setting is only recorded and applied when
+ * the window is released.
+ *
+ * @param frameSize Frame size, no larger than CAMERA_FRAME_SIZE.
+ * @param quality   JPEG quality, no better than CAMERA_JPEG_QUALITY.
+ * @return ESP_OK on success, ESP_FAIL if the sensor rejected the setting.
+ */
+esp_err_t camera_set_frame_setting(framesize_t frameSize, int quality);
+
+/**
+ * @brief Aligns a window to the sensor and picks its output size.
+ * The edges are moved out to CAMERA_WINDOW_ALIGN and the scale is the one
+ * asked for, or the smallest that keeps the output within CAMERA_FRAME_PIXELS.
+ *
+ * @param window      In: region asked for. Out: region that will be read out.
+ * @param outputWidth Width of the resulting image.
+ * @param outputHeight Height of the resulting image.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if the region is outside the sensor,
+ *         too small or too large for the scale.
+ */
+esp_err_t camera_window_fit(CameraWindow_t *window, uint16_t *outputWidth, uint16_t *outputHeight);
+
+/**
+ * @brief Reads a region of the sensor at full resolution.
+ * The sensor is switched to the window with set_res_raw(), the frames read
+ * out before it took effect are dropped and the first windowed frame is
+ * borrowed. The sensor then returns to the frame setting. Consumers of
+ * camera_frame_acquire() are never handed windowed frames, they wait for the
+ * window without their wait running out. One window at a time.
+ *
+ * @param window Region to read out, aligned with camera_window_fit() on return.
+ * @param wait   Ticks to wait for the windowed frame.
+ * @param fb     The windowed frame, to give back with camera_frame_release().
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad region,
+ *         ESP_ERR_NOT_SUPPORTED if the sensor is not an OV2640,
+ *         ESP_ERR_INVALID_STATE if another window is being read out,
+ *         ESP_ERR_TIMEOUT if no frame came, ESP_FAIL if the sensor rejected the window.
+ */
+esp_err_t camera_window_capture(CameraWindow_t *window, TickType_t wait, camera_fb_t **fb);
+
 #endif  // CAMERA_UTILS_H
 
 /********************************* END OF FILE ********************************/
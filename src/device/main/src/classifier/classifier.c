@@ -0,0 +1,311 @@
+/*******************************************************************************
+ * @file        classifier.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../classifier/classifier.h"
+#include "../ble_utils/ble_telemetry.h"
+
+#if CLASSIFIER_MODEL_EMBEDDED
+// main/model/classifier.tcnn, embedded by main/CMakeLists.txt
+extern const uint8_t classifierModelStart[] asm("_binary_classifier_tcnn_start");
+extern const uint8_t classifierModelEnd[] asm("_binary_classifier_tcnn_end");
+#endif
+
+// Published result, written by the classifier task only
+static ClassifierStatus_t classifierStatus;
+static portMUX_TYPE classifierLock = portMUX_INITIALIZER_UNLOCKED;
+
+// State below is only touched by the classifier task after init
+static TinyCnnModel_t model;
+static int8_t *arena = NULL;
+static uint8_t *decodeBuffer = NULL;
+static size_t decodeBufferSize = 0;
+static uint32_t frameSeq = 0;
+
+// Big endian RGB565 pixel expanded to 8 bit channels
+static inline void rgb565_expand(const uint8_t *px, uint8_t rgb[3])
+{
+    uint16_t c = (px[0] << 8) | px[1];
+    uint8_t r = (c >> 11) & 0x1F;
+    uint8_t g = (c >> 5) & 0x3F;
+    uint8_t b = c & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Source position of an output pixel, 8 bit fraction, pixel centres aligned
+static inline uint32_t source_position(int index, int side, int output)
+{
+    int32_t position = (int32_t)(((2 * index + 1) * side * 128) / output) - 128;
+    return position > 0 ? (uint32_t)position : 0;
+}
+
+void classifier_prepare_input(const TinyCnnModel_t *model, const uint8_t *rgb565,
+                              uint16_t width, uint16_t height, int8_t *input)
+{
+    const TinyCnnHeader_t *header = model->header;
+    const int outH = header->inputHeight;
+    const int outW = header->inputWidth;
+    const int channels = header->inputChannels;
+    const int side = width < height ? width : height;
+    const uint8_t *origin = rgb565 + ((size_t)((height - side) / 2) * width + (width - side) / 2) * 2;
+
+    // Quantized model input of every 8 bit pixel value
+    int8_t quantize[256];
+    for (int v = 0; v < 256; v++)
+    {
+        float value = v * header->pixelScale + header->pixelOffset;
+        int32_t q = (int32_t)lroundf(value / header->inputScale) + header->inputZeroPoint;
+        quantize[v] = (int8_t)(q < -128 ? -128 : q > 127 ? 127 : q);
+    }
+
+    for (int oy = 0; oy < outH; oy++)
+    {
+        uint32_t sy = source_position(oy, side, outH);
+        int y0 = sy >> 8;
+        int y1 = y0 + 1 < side ? y0 + 1 : side - 1;
+        uint32_t fy = sy & 0xFF;
+
+        for (int ox = 0; ox < outW; ox++)
+        {
+            uint32_t sx = source_position(ox, side, outW);
+            int x0 = sx >> 8;
+            int x1 = x0 + 1 < side ? x0 + 1 : side - 1;
+            uint32_t fx = sx & 0xFF;
+
+            uint8_t p00[3];
+            uint8_t p01[3];
+            uint8_t p10[3];
+            uint8_t p11[3];
+            rgb565_expand(origin + ((size_t)y0 * width + x0) * 2, p00);
+            rgb565_expand(origin + ((size_t)y0 * width + x1) * 2, p01);
+            rgb565_expand(origin + ((size_t)y1 * width + x0) * 2, p10);
+            rgb565_expand(origin + ((size_t)y1 * width + x1) * 2, p11);
+
+            uint8_t rgb[3];
+            for (int c = 0; c < 3; c++)
+            {
+                uint32_t top = p00[c] * (256 - fx) + p01[c] * fx;
+                uint32_t bottom = p10[c] * (256 - fx) + p11[c] * fx;
+                rgb[c] = (uint8_t)((top * (256 - fy) + bottom * fy + (1 << 15)) >> 16);
+            }
+
+            if (channels == 1)
+            {
+                *input++ = quantize[(77 * rgb[0] + 150 * rgb[1] + 29 * rgb[2]) >> 8];
+            }
+            else
+            {
+                *input++ = quantize[rgb[0]];
+                *input++ = quantize[rgb[1]];
+                *input++ = quantize[rgb[2]];
+            }
+        }
+    }
+}
+
+uint16_t classifier_score(const TinyCnnModel_t *model, const int8_t *output, uint8_t *topClass)
+{
+    const TinyCnnHeader_t *header = model->header;
+    const int classes = header->classes;
+
+    int top = 0;
+    for (int i = 1; i < classes; i++)
+    {
+        if (output[i] > output[top])
+        {
+            top = i;
+        }
+    }
+    *topClass = (uint8_t)top;
+
+    // A single output is the logit of the positive class
+    int positive = CLASSIFIER_POSITIVE_CLASS < classes ? CLASSIFIER_POSITIVE_CLASS : 0;
+    float logit = (output[positive] - header->outputZeroPoint) * header->outputScale;
+    float probability;
+
+    if (classes == 1)
+    {
+        probability = 1.0f / (1.0f + expf(-logit));
+    }
+    else
+    {
+        // Softmax relative to the largest output, which keeps expf() in range
+        float largest = (output[top] - header->outputZeroPoint) * header->outputScale;
+        float sum = 0.0f;
+        for (int i = 0; i < classes; i++)
+        {
+            sum += expf((output[i] - header->outputZeroPoint) * header->outputScale - largest);
+        }
+        probability = expf(logit - largest) / sum;
+    }
+
+    return (uint16_t)(probability * 1000.0f + 0.5f);
+}
+
+esp_err_t init_classifier(void)
+{
+#if CLASSIFIER_MODEL_EMBEDDED
+    const uint8_t *data = classifierModelStart;
+    size_t size = classifierModelEnd - classifierModelStart;
+
+    // Embedded files are only byte aligned, the engine reads int32 parameters
+    if (((uintptr_t)data & 3) != 0)
+    {
+        uint8_t *copy = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (copy == NULL)
+        {
+            copy = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+        }
+        if (copy == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(copy, data, size);
+        data = copy;
+    }
+
+    esp_err_t err = tiny_cnn_load(&model, data, size);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    // The activations of a 96x96 input do not fit in internal RAM next to the camera
+    size_t arenaSize = tiny_cnn_arena_size(&model);
+    arena = heap_caps_malloc(arenaSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (arena == NULL)
+    {
+        arena = heap_caps_malloc(arenaSize, MALLOC_CAP_8BIT);
+    }
+    if (arena == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&classifierLock);
+    classifierStatus.ready = true;
+    classifierStatus.macs = model.macs;
+    portEXIT_CRITICAL(&classifierLock);
+
+    ESP_LOGI(CLASSIFIER_TAG, "Model %ux%ux%u, %u layers, %u MACs, arena %u bytes",
+             model.header->inputWidth, model.header->inputHeight, model.header->inputChannels,
+             model.header->layerCount, (unsigned)model.macs, (unsigned)arenaSize);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_FOUND;
+#endif
+}
+
+static esp_err_t ensure_decode_buffer(size_t size)
+{
+    if (size <= decodeBufferSize)
+    {
+        return ESP_OK;
+    }
+
+    uint8_t *buffer = heap_caps_realloc(decodeBuffer, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    decodeBuffer = buffer;
+    decodeBufferSize = size;
+    return ESP_OK;
+}
+
+esp_err_t classifier_check_frame(void)
+{
+    if (arena == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    camera_fb_t *fb = camera_frame_acquire_next(&frameSeq, CAMERA_FRAME_TIMEOUT);
+    if (!fb)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    int64_t start = esp_timer_get_time();
+    uint16_t width = fb->width >> CLASSIFIER_DECODE_SCALE;
+    uint16_t height = fb->height >> CLASSIFIER_DECODE_SCALE;
+    esp_err_t err = fb->format == PIXFORMAT_JPEG ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+
+    if (err == ESP_OK && (width == 0 || height == 0))
+    {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    if (err == ESP_OK)
+    {
+        err = ensure_decode_buffer((size_t)width * height * 2);
+    }
+    if (err == ESP_OK && !jpg2rgb565(fb->buf, fb->len, decodeBuffer, CLASSIFIER_DECODE_SCALE))
+    {
+        err = ESP_FAIL;
+    }
+
+    // Inference only needs the decoded image, give the frame back to the ring early
+    camera_frame_release(fb);
+
+    uint16_t score = 0;
+    uint8_t topClass = 0;
+    if (err == ESP_OK)
+    {
+        classifier_prepare_input(&model, decodeBuffer, width, height, tiny_cnn_input(&model, arena));
+        score = classifier_score(&model, tiny_cnn_run(&model, arena), &topClass);
+    }
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+    bool changed = false;
+    portENTER_CRITICAL(&classifierLock);
+    if (err == ESP_OK)
+    {
+        changed = score != classifierStatus.score || topClass != classifierStatus.topClass;
+        classifierStatus.score = score;
+        classifierStatus.topClass = topClass;
+        classifierStatus.frames++;
+        classifierStatus.lastRunUs = elapsed;
+        if (elapsed > classifierStatus.maxRunUs)
+        {
+            classifierStatus.maxRunUs = elapsed;
+        }
+    }
+    else
+    {
+        classifierStatus.errors++;
+    }
+    portEXIT_CRITICAL(&classifierLock);
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(CLASSIFIER_TAG, "Classification failed: %s", esp_err_to_name(err));
+    }
+#if ENABLE_BLE
+    else if (changed)
+    {
+        ble_telemetry_changed(BLE_TELEMETRY_CLASSIFIER);
+    }
+#else
+    (void)changed;
+#endif
+
+    return err;
+}
+
+void classifier_get_status(ClassifierStatus_t *status)
+{
+    portENTER_CRITICAL(&classifierLock);
+    *status = classifierStatus;
+    portEXIT_CRITICAL(&classifierLock);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
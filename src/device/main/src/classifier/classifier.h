@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * @file        classifier.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Person / smoker classifier running a tiny_cnn model on the camera
+ *              frames. The centre square of a 1/4 scale decode is resampled to the
+ *              model input (96x96 for the reference network) and the score of
+ *              CLASSIFIER_POSITIVE_CLASS is published in per mille.
+ *
+ *              The model is built into the firmware from main/model/classifier.tcnn
+ *              when that file exists, see scripts/tflite_to_tcnn.py. Without it the
+ *              classifier task stops and the score is reported as not ready.
+ *              The activation arena is allocated once, in PSRAM when available.
+ *              The host tool cnn_eval (src/device/host/tools) runs the same input
+ *              preparation, engine and scoring over the dataset images.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "img_converters.h"
+#include "freertos/FreeRTOS.h"
+#include "../camera/camera_utils.h"
+#include "../tiny_cnn/tiny_cnn.h"
+#include "../logging/logging_utils.h"
+
+// Pause between two runs of the classifier task
+#define CLASSIFIER_PERIOD pdMS_TO_TICKS(2000)
+
+// Frames are decoded at 1/4 scale, 160x120 for VGA, before the crop
+#define CLASSIFIER_DECODE_SCALE JPG_SCALE_4X
+
+// Output whose probability is the score: person or smoker
+#define CLASSIFIER_POSITIVE_CLASS 1
+
+/**
+ * @brief Published result of the classifier task.
+ */
+typedef struct
+{
+    bool ready;                 /*< A model is loaded                           */
+    uint16_t score;             /*< Probability of the positive class, per mille */
+    uint8_t topClass;           /*< Most likely class of the last frame          */
+    uint32_t frames;            /*< Frames classified                            */
+    uint32_t errors;            /*< Frames that could not be decoded             */
+    uint32_t lastRunUs;         /*< Decode and inference time of the last frame  */
+    uint32_t maxRunUs;          /*< Longest decode and inference time            */
+    uint32_t macs;              /*< Multiply-accumulates of one inference        */
+} ClassifierStatus_t;
+
+/**
+ * @brief Writes the model input for an RGB565 image: its centre square is
+ * resampled bilinearly to the input size, converted to luma for one channel
+ * models, and quantized with the input parameters of the model.
+ *
+ * @param model  Loaded model.
+ * @param rgb565 Big endian RGB565 pixels, as jpg2rgb565() writes them.
+ * @param width  Image width.
+ * @param height Image height.
+ * @param input  Destination, see tiny_cnn_input().
+ */
+void classifier_prepare_input(const TinyCnnModel_t *model, const uint8_t *rgb565,
+                              uint16_t width, uint16_t height, int8_t *input);
+
+/**
+ * @brief Probability of CLASSIFIER_POSITIVE_CLASS in an output vector, per mille.
+ * A softmax is applied over several outputs, a sigmoid to a single one.
+ *
+ * @param model    Loaded model.
+ * @param output   Result of tiny_cnn_run().
+ * @param topClass Out: index of the largest output.
+ */
+uint16_t classifier_score(const TinyCnnModel_t *model, const int8_t *output, uint8_t *topClass);
+
+/**
+ * @brief Loads the built in model and allocates the arena.
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND when the firmware has no model,
+ *         ESP_ERR_NO_MEM, or the tiny_cnn_load() error.
+ */
+esp_err_t init_classifier(void);
+
+/**
+ * @brief Decodes the next camera frame and classifies it.
+ * Meant to be called only from the classifier task.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE without a model, ESP_ERR_TIMEOUT if no
+ *         frame was captured, or the decode error.
+ */
+esp_err_t classifier_check_frame(void);
+
+/**
+ * @brief Copies the published result of the classifier task.
+ *
+ * @param status Destination of the copy.
+ */
+void classifier_get_status(ClassifierStatus_t *status);
+
+#endif  // CLASSIFIER_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * @file        events.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../events/events.h"
+
+static httpd_req_t *clients[EVENTS_MAX_CLIENTS];
+static SemaphoreHandle_t clientsMutex;     // Protects clients, never held while sending
+
+// Next records to push, only used by the event stream task
+static uint32_t sensorCursor;
+static uint32_t motorCursor;
+
+esp_err_t init_events(void)
+{
+    clientsMutex = xSemaphoreCreateMutex();
+    if (clientsMutex == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    sensorCursor = history_head(&sensorHistory);
+    motorCursor = history_head(&motorHistory);
+
+    return ESP_OK;
+}
+
+void events_notify(void)
+{
+    if (eventStreamTask != NULL)
+    {
+        xTaskNotifyGive(eventStreamTask);
+    }
+}
+
+uint8_t events_client_count(void)
+{
+    uint8_t count = 0;
+
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < EVENTS_MAX_CLIENTS; i++)
+    {
+        if (clients[i] != NULL)
+        {
+            count++;
+        }
+    }
+    xSemaphoreGive(clientsMutex);
+
+    return count;
+}
+
+esp_err_t events_add_client(httpd_req_t *req)
+{
+    esp_err_t err = ESP_ERR_NO_MEM;
+
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < EVENTS_MAX_CLIENTS; i++)
+    {
+        if (clients[i] == NULL)
+        {
+            clients[i] = req;
+            err = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(clientsMutex);
+
+    return err;
+}
+
+// Send a chunk to the clients of a dispatch. A client that fails is moved from
+// targets to dropped and gets nothing more.
+static void broadcast(httpd_req_t **targets, httpd_req_t **dropped, const char *chunk, size_t len)
+{
+    for (int i = 0; i < EVENTS_MAX_CLIENTS; i++)
+    {
+        if (targets[i] != NULL && httpd_resp_send_chunk(targets[i], chunk, len) != ESP_OK)
+        {
+            dropped[i] = targets[i];
+            targets[i] = NULL;
+        }
+    }
+}
+
+// Format one record as an SSE message, returns its length or 0 if it does not fit
+static size_t format_event(const HistoryRecord_t *record, char *buf, size_t size)
+{
+    char data[64];
+    JsonWriter_t writer;
+    json_writer_init(&writer, data, sizeof(data));
+
+    json_writer_begin_object(&writer, NULL);
+    json_writer_add_uint(&writer, "t", record->timestamp);
+    if (record->type == HISTORY_MOTOR)
+    {
+        json_writer_add_uint(&writer, "motor", record->id);
+        json_writer_add_float(&writer, "angle", record->value / 10.0f, 1);
+    }
+    else
+    {
+        json_writer_add_string(&writer, "type", history_type_name(record->type));
+        json_writer_add_uint(&writer, "value", record->value);
+    }
+    json_writer_end_object(&writer);
+    json_writer_finish(&writer);
+
+    int len = snprintf(buf, size, "event: %s\ndata: %s\n\n",
+                       record->type == HISTORY_MOTOR ? "motor" : "sensor", data);
+    return (len > 0 && (size_t)len < size) ? (size_t)len : 0;
+}
+
+// Push the new records of a ring in as few chunks as possible, returns how many were sent
+static size_t dispatch_ring(HistoryRing_t *ring, uint32_t *cursor, httpd_req_t **targets, httpd_req_t **dropped)
+{
+    HistoryRecord_t records[8];
+    char chunk[EVENTS_CHUNK_SIZE];
+    size_t len = 0;
+    size_t total = 0;
+    size_t count;
+
+    while ((count = history_read(ring, cursor, records, sizeof(records) / sizeof(records[0]))) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t event_len = format_event(&records[i], chunk + len, sizeof(chunk) - len);
+            if (event_len == 0 && len > 0)
+            {
+                // Chunk full, send it and start a new one
+                broadcast(targets, dropped, chunk, len);
+                len = 0;
+                event_len = format_event(&records[i], chunk, sizeof(chunk));
+            }
+            len += event_len;
+        }
+        total += count;
+    }
+
+    if (len > 0)
+    {
+        broadcast(targets, dropped, chunk, len);
+    }
+    return total;
+}
+
+void events_dispatch(void)
+{
+    httpd_req_t *targets[EVENTS_MAX_CLIENTS];
+    httpd_req_t *dropped[EVENTS_MAX_CLIENTS] = { NULL };
+
+    // Send to a copy of the list, so a slow client never blocks events_add_client()
+    // and events_client_count(). Only this task removes clients, the copied
+    // requests stay valid until it does.
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
+    memcpy(targets, clients, sizeof(targets));
+    xSemaphoreGive(clientsMutex);
+
+    size_t sent = dispatch_ring(&sensorHistory, &sensorCursor, targets, dropped);
+    sent += dispatch_ring(&motorHistory, &motorCursor, targets, dropped);
+
+    if (sent == 0)
+    {
+        static const char keepalive[] = ": keepalive\n\n";
+        broadcast(targets, dropped, keepalive, sizeof(keepalive) - 1);
+    }
+
+    // Clients added meanwhile took free slots, the dropped ones are still in theirs
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < EVENTS_MAX_CLIENTS; i++)
+    {
+        if (dropped[i] != NULL)
+        {
+            clients[i] = NULL;
+        }
+    }
+    xSemaphoreGive(clientsMutex);
+
+    for (int i = 0; i < EVENTS_MAX_CLIENTS; i++)
+    {
+        if (dropped[i] != NULL)
+        {
+            ESP_LOGI(WEBSERVER_TAG, "Event client disconnected");
+            httpd_req_async_handler_complete(dropped[i]);
+        }
+    }
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
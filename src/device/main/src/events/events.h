@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * @file        events.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Server-Sent Events push of sensor transitions and motor angles.
+ *              The records come from the history rings, the GPIO event and motor
+ *              tasks wake the event stream task right after adding one.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <esp_http_server.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "../history/history.h"
+#include "../json_writer/json_writer.h"
+#include "../logging/logging_utils.h"
+
+// Number of /events connections held open at once
+#define EVENTS_MAX_CLIENTS 3
+
+// A comment line is sent to idle clients this often to detect closed connections
+#define EVENTS_KEEPALIVE_INTERVAL pdMS_TO_TICKS(15000)
+
+// Size of the buffer a batch of events is formatted in before it is sent
+#define EVENTS_CHUNK_SIZE 512
+
+/**
+ * @brief Handle of the event stream task, defined in task_utils.c.
+ */
+extern TaskHandle_t eventStreamTask;
+
+/**
+ * @brief Initializes the client list. Records already in the history are not pushed.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the mutex cannot be created.
+ */
+esp_err_t init_events(void);
+
+/**
+ * @brief Wakes the event stream task after a record was added to a history ring.
+ */
+void events_notify(void);
+
+/**
+ * @brief Returns the number of connected clients.
+ */
+uint8_t events_client_count(void);
+
+/**
+ * @brief Hands an async request over to the event stream task.
+ * The request must come from httpd_req_async_handler_begin() and already have
+ * its headers sent. It is completed by the task once the client goes away.
+ *
+ * @param req The async copy of the request.
+ * @return ESP_OK, or ESP_ERR_NO_MEM when EVENTS_MAX_CLIENTS are already connected.
+ */
+esp_err_t events_add_client(httpd_req_t *req);
+
+/**
+ * @brief Sends every record added since the last call to all clients, or a
+ * keepalive comment if there is none. Must only be called from the event
+ * stream task, the only one that removes clients. The client list is not
+ * locked while sending, a slow client never blocks events_add_client().
+ */
+void events_dispatch(void);
+
+#endif  // EVENTS_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
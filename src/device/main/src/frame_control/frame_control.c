@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * @file        frame_control.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../frame_control/frame_control.h"
+
+// Best to worst. A step makes the frame at most 1.8 times smaller, so a step up
+// from below FRAME_CONTROL_UP_PERCENT of the target stays under the target
+static const FrameControlStep_t ladder[] = {
+    {CAMERA_FRAME_SIZE, CAMERA_JPEG_QUALITY},
+    {FRAMESIZE_VGA, 16},
+    {FRAMESIZE_HVGA, 16},
+    {FRAMESIZE_CIF, 20},
+    {FRAMESIZE_QVGA, 24},
+    {FRAMESIZE_HQVGA, 30},
+};
+
+#define LADDER_STEPS ((uint8_t)(sizeof(ladder) / sizeof(ladder[0])))
+
+// Controller shared by the image handlers of both HTTP servers
+static FrameControl_t control;
+static portMUX_TYPE frameControlLock = portMUX_INITIALIZER_UNLOCKED;
+
+uint8_t frame_control_step_count(void)
+{
+    return LADDER_STEPS;
+}
+
+const FrameControlStep_t *frame_control_step(uint8_t step)
+{
+    return &ladder[step < LADDER_STEPS ? step : LADDER_STEPS - 1];
+}
+
+static inline uint32_t average(uint32_t current, uint32_t value)
+{
+    return (uint32_t)(current + ((int64_t)value - current) / (1 << FRAME_CONTROL_AVERAGE_SHIFT));
+}
+
+bool frame_control_update(FrameControl_t *control, size_t bytes, uint32_t sendUs)
+{
+    if (bytes < FRAME_CONTROL_MIN_BYTES || sendUs == 0)
+    {
+        return false;
+    }
+
+    uint64_t rate = (uint64_t)bytes * 1000000 / sendUs;
+    rate = rate > UINT32_MAX ? UINT32_MAX : rate;
+
+    // The link is the same whatever the setting, only the frame size starts over after a change
+    control->throughput = control->sends == 0 ? (uint32_t)rate : average(control->throughput, (uint32_t)rate);
+    control->frameBytes = control->frameBytes == 0 ? (uint32_t)bytes : average(control->frameBytes, (uint32_t)bytes);
+    control->frameMs = (uint32_t)((uint64_t)control->frameBytes * 1000 / control->throughput);
+    control->sends++;
+
+    if (control->settling > 0)
+    {
+        control->settling--;
+        return false;
+    }
+
+    if (control->frameMs > FRAME_CONTROL_TARGET_MS && control->step + 1 < LADDER_STEPS)
+    {
+        control->step++;
+    }
+    else if (control->frameMs * 100 < FRAME_CONTROL_TARGET_MS * FRAME_CONTROL_UP_PERCENT && control->step > 0)
+    {
+        control->step--;
+    }
+    else
+    {
+        return false;
+    }
+
+    control->frameBytes = 0;
+    control->settling = FRAME_CONTROL_SETTLE_SENDS;
+    control->changes++;
+    return true;
+}
+
+void frame_control_record_send(size_t bytes, int64_t sendUs)
+{
+    portENTER_CRITICAL(&frameControlLock);
+    bool changed = frame_control_update(&control, bytes, sendUs > UINT32_MAX ? UINT32_MAX : (uint32_t)sendUs);
+    uint8_t step = control.step;
+    uint32_t throughput = control.throughput;
+    portEXIT_CRITICAL(&frameControlLock);
+
+    if (!changed)
+    {
+        return;
+    }
+
+    // Changes are FRAME_CONTROL_SETTLE_SENDS sends apart, two handlers never apply at once.
+    // The camera defers the setting while a sensor window is read out.
+    const FrameControlStep_t *setting = frame_control_step(step);
+    if (camera_set_frame_setting(setting->frameSize, setting->quality) != ESP_OK)
+    {
+        ESP_LOGE(CAMERA_TAG, "Setting frame size %d, quality %u failed", setting->frameSize, setting->quality);
+        return;
+    }
+
+    ESP_LOGI(CAMERA_TAG, "Link at %u B/s, frame size %d, quality %u",
+             (unsigned)throughput, setting->frameSize, setting->quality);
+}
+
+void frame_control_get_status(FrameControl_t *status)
+{
+    portENTER_CRITICAL(&frameControlLock);
+    *status = control;
+    portEXIT_CRITICAL(&frameControlLock);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * @file        frame_control.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Frame size and JPEG quality controller driven by the network throughput.
+ *              The image handlers report how long each frame took to send. The
+ *              controller averages the throughput and the frame size, predicts the
+ *              time to send a frame and walks a ladder of sensor settings to keep it
+ *              near FRAME_CONTROL_TARGET_MS: down when a frame takes longer, up when
+ *              it takes well under the target. Step 0 is the boot setting of
+ *              init_camera(), the frame buffers are not sized for anything larger.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef FRAME_CONTROL_H
+#define FRAME_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "../camera/camera_utils.h"
+#include "../logging/logging_utils.h"
+
+// Time to send one frame the controller aims for
+#define FRAME_CONTROL_TARGET_MS 250
+
+// A better setting is tried when a frame takes less than this share of the target, in percent
+#define FRAME_CONTROL_UP_PERCENT 55
+
+// Weight of a new send in the averages, 1/2^shift
+#define FRAME_CONTROL_AVERAGE_SHIFT 2
+
+// Sends measured at a setting before the next change, so it is judged on its own frames
+#define FRAME_CONTROL_SETTLE_SENDS 4
+
+// Shorter sends fit in the socket buffers and say nothing about the link
+#define FRAME_CONTROL_MIN_BYTES 4096
+
+/**
+ * @brief Sensor setting of a ladder step.
+ */
+typedef struct
+{
+    framesize_t frameSize;
+    uint8_t quality;            /*< JPEG quality, lower is better (0-63)        */
+} FrameControlStep_t;
+
+/**
+ * @brief State of the controller, also its published status.
+ */
+typedef struct
+{
+    uint8_t step;               /*< Current ladder step, 0 is the best setting  */
+    uint32_t throughput;        /*< Average throughput, bytes per second        */
+    uint32_t frameBytes;        /*< Average frame size at the current step      */
+    uint32_t frameMs;           /*< Predicted time to send a frame              */
+    uint32_t settling;          /*< Sends left before the next change           */
+    uint32_t sends;             /*< Sends measured                              */
+    uint32_t changes;           /*< Setting changes                             */
+} FrameControl_t;
+
+/**
+ * @brief Number of steps of the ladder.
+ */
+uint8_t frame_control_step_count(void);
+
+/**
+ * @brief Sensor setting of a ladder step.
+ *
+ * @param step Step, clamped to the ladder.
+ */
+const FrameControlStep_t *frame_control_step(uint8_t step);
+
+/**
+ * @brief Feeds one send to the controller.
+ *
+ * @param control Controller state, zero initialized before its first use.
+ * @param bytes   Bytes sent.
+ * @param sendUs  Time spent sending them.
+ * @return true when the step changed and the sensor must be set to it.
+ */
+bool frame_control_update(FrameControl_t *control, size_t bytes, uint32_t sendUs);
+
+/**
+ * @brief Reports a frame sent by an image handler and applies the setting
+ * the controller picks. May be called from any task.
+ *
+ * @param bytes  Bytes sent.
+ * @param sendUs Time spent in httpd_resp_send() or httpd_resp_send_chunk().
+ */
+void frame_control_record_send(size_t bytes, int64_t sendUs);
+
+/**
+ * @brief Copies the controller state.
+ *
+ * @param status Destination of the copy.
+ */
+void frame_control_get_status(FrameControl_t *status);
+
+#endif  // FRAME_CONTROL_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
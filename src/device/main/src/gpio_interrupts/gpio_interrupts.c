@@ -9,8 +9,19 @@
 
 #include "../gpio_interrupts/gpio_interrupts.h" // Create this header file in the same directory
 
+QueueHandle_t gpioEventQueue;
+
+static volatile uint32_t gpioEventsDropped = 0;
+
 esp_err_t init_isr(void)
 {
+    // The queue must exist before the first interrupt fires
+    gpioEventQueue = xQueueCreate(GPIO_EVENT_QUEUE_ITEM_NUMBER, sizeof(GpioEvent_t));
+    if (gpioEventQueue == NULL) {
+        ESP_LOGE(INTERRUPT_LOG_TAG, "GPIO event queue creation failed");
+        return ESP_ERR_NO_MEM;
+    }
+
     // Define the interrupt initialization parameters
     InterruptInitParams_t const InterruptInitParameters[] = {
         {GPIO_LDR, ldr_isr, NULL, GPIO_INTR_ANYEDGE},
@@ -46,31 +57,44 @@ esp_err_t init_isr(void)
     return ESP_OK;
 }
 
-// ISR for GPIO_PIR_SIGNAL pin
-void pir_signal_isr(void* arg)
+uint32_t get_gpio_events_dropped(void)
 {
-    setPirState(gpio_get_level(GPIO_PIR_SIGNAL)); 
+    return gpioEventsDropped;
 }
 
-// ISR for GPIO_LDR pin
-void ldr_isr(void* arg)
+// Post the edge of a pin to the GPIO event task, nothing else is done in interrupt context
+static void IRAM_ATTR post_gpio_event(gpio_num_t gpio)
 {
-    setLdrState(gpio_get_level(GPIO_LDR));
-    switch (getLdrState())
+    GpioEvent_t event = {
+        .timestamp = esp_timer_get_time(),
+        .gpio = gpio,
+        .level = gpio_get_level(gpio)
+    };
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    if (xQueueSendFromISR(gpioEventQueue, &event, &higherPriorityTaskWoken) != pdTRUE)
     {
-        case 0:
-            gpio_set_level(GPIO_LEDs, LOW);
-            break;
-        case 1:
-            gpio_set_level(GPIO_LEDs, HIGH);
-            break;
+        gpioEventsDropped++;
     }
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+// ISR for GPIO_PIR_SIGNAL pin
+void IRAM_ATTR pir_signal_isr(void* arg)
+{
+    post_gpio_event(GPIO_PIR_SIGNAL);
+}
+
+// ISR for GPIO_LDR pin
+void IRAM_ATTR ldr_isr(void* arg)
+{
+    post_gpio_event(GPIO_LDR);
 }
 
 // ISR for GPIO_SMOKE_SENSOR pin
-void smoke_sensor_isr(void* arg)
+void IRAM_ATTR smoke_sensor_isr(void* arg)
 {
-    setSmokeSensorState(gpio_get_level(GPIO_SMOKE_SENSOR));
+    post_gpio_event(GPIO_SMOKE_SENSOR);
 }
 
 /********************************* END OF FILE ********************************/
@@ -14,9 +14,30 @@
 #include "esp_intr_alloc.h"
 #include "esp_attr.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "../logging/logging_utils.h"
 #include "../gpio_utils/gpio_utils.h"
 
+// Number of edges the ISRs can queue before the GPIO event task catches up
+#define GPIO_EVENT_QUEUE_ITEM_NUMBER 16
+
+/**
+ * @brief Edge record posted by the ISRs to the GPIO event task.
+ */
+typedef struct
+{
+    int64_t timestamp;     /*< esp_timer time of the edge in microseconds                     */
+    uint8_t gpio;          /*< GPIO number that triggered the interrupt                       */
+    uint8_t level;         /*< Pin level read in the ISR                                      */
+} GpioEvent_t;
+
+/**
+ * @brief Queue of GpioEvent_t filled by the ISRs, created by init_isr().
+ */
+extern QueueHandle_t gpioEventQueue;
+
 /**
  * @brief Interrupt configuration structure used to initialize interrupts.
  */
@@ -33,7 +54,13 @@ typedef struct
  */
 esp_err_t init_isr(void);
 
-// Function declarations for the interrupt service routines
+/**
+ * @brief Returns the number of edges lost because gpioEventQueue was full.
+ */
+uint32_t get_gpio_events_dropped(void);
+
+// Function declarations for the interrupt service routines.
+// They only post a GpioEvent_t, all processing happens in GpioEventTask.
 void pir_signal_isr(void* arg);
 void ldr_isr(void* arg);
 void smoke_sensor_isr(void* arg);
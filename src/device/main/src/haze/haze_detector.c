@@ -0,0 +1,389 @@
+/*******************************************************************************
+ * @file        haze_detector.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../haze/haze_detector.h"
+
+// Published result, written by the haze task only
+static HazeStatus_t hazeStatus;
+static portMUX_TYPE hazeLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Buffers below are only touched by the haze task
+static HazeDetector_t detector;
+static JpegDcDecoder_t *decoder = NULL;
+static uint8_t *lumaBuffer = NULL;
+static uint8_t *saturationBuffer = NULL;
+static size_t bufferPixels = 0;
+static uint32_t frameSeq = 0;
+
+static uint32_t isqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+// Move a learnt value towards the current one by 1/2^shift
+static inline uint16_t follow(uint16_t learnt, uint16_t current, int shift)
+{
+    return (uint16_t)(learnt + ((int32_t)current - learnt) / (1 << shift));
+}
+
+static esp_err_t ensure_state(HazeDetector_t *state, uint16_t width, uint16_t height)
+{
+    if (width == state->width && height == state->height)
+    {
+        return ESP_OK;
+    }
+
+    uint16_t cols = (width + HAZE_CELL_SIZE - 1) / HAZE_CELL_SIZE;
+    uint16_t rows = (height + HAZE_CELL_SIZE - 1) / HAZE_CELL_SIZE;
+    size_t cells = (size_t)cols * rows;
+
+    uint16_t *background = heap_caps_realloc(state->background, cells * sizeof(uint16_t), MALLOC_CAP_8BIT);
+    if (background == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    state->background = background;
+
+    uint16_t *contrast = heap_caps_realloc(state->contrast, cells * sizeof(uint16_t), MALLOC_CAP_8BIT);
+    if (contrast == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    state->contrast = contrast;
+
+    uint8_t *previous = heap_caps_realloc(state->previous, (size_t)width * height, MALLOC_CAP_8BIT);
+    if (previous == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    state->previous = previous;
+
+    // A background learnt at another size cannot be compared
+    state->width = width;
+    state->height = height;
+    state->cellCols = cols;
+    state->cellRows = rows;
+    haze_detector_reset(state);
+
+    return ESP_OK;
+}
+
+void haze_detector_reset(HazeDetector_t *state)
+{
+    size_t cells = (size_t)state->cellCols * state->cellRows;
+    for (size_t i = 0; i < cells; i++)
+    {
+        state->background[i] = HAZE_REFERENCE_CONTRAST;
+    }
+    state->backgroundGray = HAZE_REFERENCE_GRAY;
+    state->previousValid = false;
+    state->gateOpen = false;
+    state->warmup = HAZE_WARMUP_FRAMES;
+}
+
+void haze_detector_free(HazeDetector_t *state)
+{
+    heap_caps_free(state->background);
+    heap_caps_free(state->contrast);
+    heap_caps_free(state->previous);
+    memset(state, 0, sizeof(*state));
+}
+
+esp_err_t haze_detector_update(HazeDetector_t *state, const uint8_t *luma, const uint8_t *saturation,
+                               uint16_t width, uint16_t height, HazeFeatures_t *features)
+{
+    if (width < 2 || height < 2)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = ensure_state(state, width, height);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    size_t pixels = (size_t)width * height;
+    size_t cells = (size_t)state->cellCols * state->cellRows;
+    memset(state->contrast, 0, cells * sizeof(uint16_t));
+
+    // One pass: gradient sum of each cell, haze-like pixels and their change since the previous frame
+    uint32_t grayCount = 0;
+    int64_t diffSum = 0;
+    uint64_t diffSquares = 0;
+    for (uint16_t y = 0; y < height; y++)
+    {
+        const uint8_t *row = luma + (size_t)y * width;
+        const uint8_t *below = y + 1 < height ? row + width : row;
+        const uint8_t *sat = saturation != NULL ? saturation + (size_t)y * width : NULL;
+        const uint8_t *prev = state->previous + (size_t)y * width;
+        uint16_t *cellRow = state->contrast + (size_t)(y / HAZE_CELL_SIZE) * state->cellCols;
+
+        for (uint16_t x = 0; x < width; x++)
+        {
+            int32_t value = row[x];
+            int32_t right = x + 1 < width ? row[x + 1] : value;
+            int32_t dx = right - value;
+            int32_t dy = below[x] - value;
+            uint32_t gradient = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+
+            // A cell holds at most 64 pixels of gradient 510, the sum fits 16 bits
+            cellRow[x / HAZE_CELL_SIZE] += gradient;
+
+            if (gradient <= HAZE_FLAT_GRADIENT && value >= HAZE_GRAY_LUMA_MIN &&
+                (sat == NULL || sat[x] <= HAZE_GRAY_SATURATION))
+            {
+                grayCount++;
+                int32_t diff = value - prev[x];
+                diffSum += diff;
+                diffSquares += (uint64_t)(diff * diff);
+            }
+        }
+    }
+
+    // Contrast lost by the cells against the background, weighted by the background contrast
+    uint32_t lost = 0;
+    uint32_t backgroundSum = 0;
+    for (uint16_t row = 0; row < state->cellRows; row++)
+    {
+        uint16_t cellHeight = (row + 1) * HAZE_CELL_SIZE <= height ? HAZE_CELL_SIZE : height - row * HAZE_CELL_SIZE;
+        for (uint16_t col = 0; col < state->cellCols; col++)
+        {
+            uint16_t cellWidth = (col + 1) * HAZE_CELL_SIZE <= width ? HAZE_CELL_SIZE : width - col * HAZE_CELL_SIZE;
+            size_t i = (size_t)row * state->cellCols + col;
+
+            uint16_t contrast = (uint16_t)((state->contrast[i] * 16u) / (cellWidth * cellHeight));
+            state->contrast[i] = contrast;
+            if (contrast < state->background[i])
+            {
+                lost += state->background[i] - contrast;
+            }
+            backgroundSum += state->background[i];
+        }
+    }
+    features->contrastLoss = backgroundSum ? (uint16_t)(((uint64_t)lost * 1000) / backgroundSum) : 0;
+
+    // Share of the non gray background that turned gray
+    uint16_t grayPermille = (uint16_t)(((uint64_t)grayCount * 1000) / pixels);
+    features->grayGrowth = 0;
+    if (grayPermille > state->backgroundGray)
+    {
+        features->grayGrowth = (uint16_t)(((uint32_t)(grayPermille - state->backgroundGray) * 1000) /
+                                          (1000 - state->backgroundGray));
+    }
+
+    // Standard deviation of the change of the haze-like pixels, the mean removes exposure shifts
+    features->temporal = 0;
+    if (state->previousValid && grayPermille >= HAZE_TEMPORAL_MIN_GRAY && grayCount > 0)
+    {
+        // n^2 times the variance, exact in integers
+        uint64_t scaled = (uint64_t)grayCount * diffSquares - (uint64_t)(diffSum * diffSum);
+        uint32_t deviation = isqrt((scaled * 256) / ((uint64_t)grayCount * grayCount)); // 1/16 levels
+        uint32_t temporal = (deviation * 1000) / HAZE_TEMPORAL_FULL;
+        features->temporal = temporal > 1000 ? 1000 : (uint16_t)temporal;
+    }
+
+    features->score = (uint16_t)((HAZE_WEIGHT_CONTRAST * features->contrastLoss +
+                                  HAZE_WEIGHT_GRAY * features->grayGrowth +
+                                  HAZE_WEIGHT_TEMPORAL * features->temporal) /
+                                 (HAZE_WEIGHT_CONTRAST + HAZE_WEIGHT_GRAY + HAZE_WEIGHT_TEMPORAL));
+
+    int shift;
+    if (state->warmup > 0)
+    {
+        // The scene is not known yet, learn it fast with the gate closed
+        state->warmup--;
+        shift = 1;
+    }
+    else
+    {
+        if (!state->gateOpen && features->score >= HAZE_SCORE_THRESHOLD)
+        {
+            state->gateOpen = true;
+        }
+        else if (state->gateOpen && features->score + HAZE_SCORE_HYSTERESIS < HAZE_SCORE_THRESHOLD)
+        {
+            state->gateOpen = false;
+        }
+
+        // Keep learning while the gate is open, slowly, so a lasting change of the scene is accepted
+        shift = state->gateOpen ? HAZE_BACKGROUND_SHIFT_GATED : HAZE_BACKGROUND_SHIFT;
+    }
+    for (size_t i = 0; i < cells; i++)
+    {
+        state->background[i] = follow(state->background[i], state->contrast[i], shift);
+    }
+    state->backgroundGray = follow(state->backgroundGray, grayPermille, shift);
+
+    memcpy(state->previous, luma, pixels);
+    state->previousValid = true;
+
+    return ESP_OK;
+}
+
+esp_err_t init_haze_detection(void)
+{
+    decoder = heap_caps_malloc(sizeof(JpegDcDecoder_t), MALLOC_CAP_8BIT);
+    if (decoder == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t ensure_buffers(size_t pixels)
+{
+    if (pixels <= bufferPixels)
+    {
+        return ESP_OK;
+    }
+
+    uint8_t *luma = heap_caps_realloc(lumaBuffer, pixels, MALLOC_CAP_8BIT);
+    if (luma == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    lumaBuffer = luma;
+
+    uint8_t *saturation = heap_caps_realloc(saturationBuffer, pixels, MALLOC_CAP_8BIT);
+    if (saturation == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    saturationBuffer = saturation;
+
+    bufferPixels = pixels;
+    return ESP_OK;
+}
+
+// Decode a frame at 1/8 scale into the task buffers
+static esp_err_t decode_frame(const camera_fb_t *fb, JpegDcImage_t *image)
+{
+    if (fb->format != PIXFORMAT_JPEG)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    uint16_t width;
+    uint16_t height;
+    esp_err_t err = jpeg_dc_get_size(fb->buf, fb->len, &width, &height);
+    if (err == ESP_OK)
+    {
+        err = ensure_buffers((size_t)width * height);
+    }
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    image->luma = lumaBuffer;
+    image->saturation = saturationBuffer;
+    image->capacity = bufferPixels;
+    return jpeg_dc_decode(decoder, fb->buf, fb->len, image);
+}
+
+esp_err_t haze_check_frame(void)
+{
+    if (decoder == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    camera_fb_t *fb = camera_frame_acquire_next(&frameSeq, CAMERA_FRAME_TIMEOUT);
+    if (!fb)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    int64_t start = esp_timer_get_time();
+    JpegDcImage_t image;
+    esp_err_t err = decode_frame(fb, &image);
+
+    // The kernel only needs the thumbnail, give the frame back to the ring early
+    camera_frame_release(fb);
+
+    HazeFeatures_t features = {0};
+    if (err == ESP_OK)
+    {
+        err = haze_detector_update(&detector, image.luma, image.saturation, image.width, image.height, &features);
+    }
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+    bool wasOpen;
+    portENTER_CRITICAL(&hazeLock);
+    wasOpen = hazeStatus.gateOpen;
+    if (err == ESP_OK)
+    {
+        hazeStatus.features = features;
+        hazeStatus.gateOpen = detector.gateOpen;
+        hazeStatus.frames++;
+        hazeStatus.lastCheckUs = elapsed;
+        if (elapsed > hazeStatus.maxCheckUs)
+        {
+            hazeStatus.maxCheckUs = elapsed;
+        }
+    }
+    else
+    {
+        hazeStatus.errors++;
+    }
+    portEXIT_CRITICAL(&hazeLock);
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(HAZE_TAG, "Haze check failed: %s", esp_err_to_name(err));
+    }
+    else if (detector.gateOpen != wasOpen)
+    {
+        ESP_LOGI(HAZE_TAG, "Haze gate %s, score %u", detector.gateOpen ? "opened" : "closed", features.score);
+    }
+
+    return err;
+}
+
+void haze_get_status(HazeStatus_t *status)
+{
+    portENTER_CRITICAL(&hazeLock);
+    *status = hazeStatus;
+    portEXIT_CRITICAL(&hazeLock);
+}
+
+bool haze_gate_open(void)
+{
+    portENTER_CRITICAL(&hazeLock);
+    bool open = hazeStatus.gateOpen;
+    portEXIT_CRITICAL(&hazeLock);
+
+    return open;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
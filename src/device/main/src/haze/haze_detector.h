@@ -0,0 +1,179 @@
+/*******************************************************************************
+ * @file        haze_detector.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Smoke and haze detection on the 1/8 scale luma of the camera frames.
+ *              Three integer features are computed per frame, in per mille:
+ *                contrast loss: local contrast lost against the learnt background,
+ *                               measured in cells of HAZE_CELL_SIZE pixels
+ *                gray growth:   share of the scene turned into flat, bright,
+ *                               low saturation pixels
+ *                temporal:      spread of the change of those pixels since the
+ *                               previous frame, a uniform exposure shift is ignored
+ *              Their weighted sum is the score. The upload gate opens when it
+ *              reaches HAZE_SCORE_THRESHOLD and closes HAZE_SCORE_HYSTERESIS below.
+ *              The kernel only uses integer loops, the host tool haze_eval
+ *              (src/device/host/tools) runs it over the dataset images.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef HAZE_DETECTOR_H
+#define HAZE_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "../camera/camera_utils.h"
+#include "../jpeg_dc/jpeg_dc.h"
+#include "../logging/logging_utils.h"
+
+// Pause between two checks of the haze task
+#define HAZE_CHECK_PERIOD pdMS_TO_TICKS(1000)
+
+// Side of a contrast cell, in 1/8 scale pixels (64 frame pixels)
+#define HAZE_CELL_SIZE 8
+
+// Local contrast of a cell before any background is learnt, mean gradient in 1/16 levels
+#define HAZE_REFERENCE_CONTRAST (12 * 16)
+
+// Gray pixel share of the scene, per mille, before any background is learnt
+#define HAZE_REFERENCE_GRAY 50
+
+// A pixel is haze-like when its saturation, gradient and luma are within these bounds
+#define HAZE_GRAY_SATURATION 10
+#define HAZE_FLAT_GRADIENT 10
+#define HAZE_GRAY_LUMA_MIN 80
+
+// Deviation of the change of the haze-like pixels, in 1/16 levels, giving a full temporal feature
+#define HAZE_TEMPORAL_FULL (12 * 16)
+
+// Haze-like pixels, per mille, needed for the temporal feature to be measured
+#define HAZE_TEMPORAL_MIN_GRAY 10
+
+// Weights of the contrast, gray and temporal features in the score
+#define HAZE_WEIGHT_CONTRAST 4
+#define HAZE_WEIGHT_GRAY 4
+#define HAZE_WEIGHT_TEMPORAL 2
+
+// Score, per mille, at which the upload gate opens
+#define HAZE_SCORE_THRESHOLD 350
+#define HAZE_SCORE_HYSTERESIS 50
+
+// Frames after a reset during which the background is learnt fast and the gate stays closed
+#define HAZE_WARMUP_FRAMES 8
+
+// The background follows the scene by 1/2^shift per frame, much slower while the gate is open
+#define HAZE_BACKGROUND_SHIFT 3
+#define HAZE_BACKGROUND_SHIFT_GATED 7
+
+/**
+ * @brief Features of one frame, all per mille.
+ */
+typedef struct
+{
+    uint16_t contrastLoss;
+    uint16_t grayGrowth;
+    uint16_t temporal;
+    uint16_t score;
+} HazeFeatures_t;
+
+/**
+ * @brief State of the kernel between frames.
+ * The buffers are allocated for the image size and reallocated when it changes.
+ */
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint16_t cellCols;
+    uint16_t cellRows;
+    uint16_t *background;       /*< Learnt contrast of each cell, 1/16 levels   */
+    uint16_t *contrast;         /*< Contrast of each cell in the current frame  */
+    uint8_t *previous;          /*< Luma of the previous frame                  */
+    bool previousValid;
+    uint16_t backgroundGray;    /*< Learnt gray pixel share, per mille          */
+    uint8_t warmup;             /*< Frames left before the gate may open        */
+    bool gateOpen;
+} HazeDetector_t;
+
+/**
+ * @brief Published result of the haze task.
+ */
+typedef struct
+{
+    HazeFeatures_t features;    /*< Features of the last checked frame          */
+    bool gateOpen;              /*< Uploads are worth it                        */
+    uint32_t frames;            /*< Frames checked                              */
+    uint32_t errors;            /*< Frames that could not be decoded            */
+    uint32_t lastCheckUs;       /*< Decode and kernel time of the last frame    */
+    uint32_t maxCheckUs;        /*< Longest decode and kernel time              */
+} HazeStatus_t;
+
+/**
+ * @brief Forgets the learnt background and the previous frame.
+ * The background is learnt again during HAZE_WARMUP_FRAMES frames.
+ *
+ * @param detector Kernel state, zero initialized before its first use.
+ */
+void haze_detector_reset(HazeDetector_t *detector);
+
+/**
+ * @brief Releases the buffers of the kernel state.
+ *
+ * @param detector Kernel state.
+ */
+void haze_detector_free(HazeDetector_t *detector);
+
+/**
+ * @brief Runs the kernel on one frame and updates the background and the gate.
+ *
+ * @param detector   Kernel state.
+ * @param luma       1/8 scale luma, see jpeg_dc_decode().
+ * @param saturation 1/8 scale saturation, NULL for a gray image.
+ * @param width      Image width.
+ * @param height     Image height.
+ * @param features   Out: features of the frame.
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE for images smaller than 2x2,
+ *         ESP_ERR_NO_MEM if the buffers cannot be allocated.
+ */
+esp_err_t haze_detector_update(HazeDetector_t *detector, const uint8_t *luma, const uint8_t *saturation,
+                               uint16_t width, uint16_t height, HazeFeatures_t *features);
+
+/**
+ * @brief Allocates the decoder state of the haze task.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM otherwise.
+ */
+esp_err_t init_haze_detection(void);
+
+/**
+ * @brief Decodes the next camera frame at 1/8 scale and runs the kernel on it.
+ * Meant to be called only from the haze task.
+ *
+ * @return ESP_OK, ESP_ERR_TIMEOUT if no frame was captured, or the decode error.
+ */
+esp_err_t haze_check_frame(void);
+
+/**
+ * @brief Copies the published result of the haze task.
+ *
+ * @param status Destination of the copy.
+ */
+void haze_get_status(HazeStatus_t *status);
+
+/**
+ * @brief Whether the last checked frame is worth uploading.
+ */
+bool haze_gate_open(void);
+
+#endif  // HAZE_DETECTOR_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
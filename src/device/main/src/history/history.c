@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * @file        history.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../history/history.h"
+
+static HistoryRecord_t sensorRecords[HISTORY_SENSOR_RING_SIZE];
+static HistoryRecord_t motorRecords[HISTORY_MOTOR_RING_SIZE];
+
+HistoryRing_t sensorHistory = {sensorRecords, HISTORY_SENSOR_RING_SIZE, 0};
+HistoryRing_t motorHistory = {motorRecords, HISTORY_MOTOR_RING_SIZE, 0};
+
+uint32_t history_now(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void history_push(HistoryRing_t *ring, HistoryType_t type, uint8_t id, uint16_t value)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    HistoryRecord_t *record = &ring->records[head & (ring->size - 1)];
+
+    record->timestamp = history_now();
+    record->type = type;
+    record->id = id;
+    record->value = value;
+
+    // Publish the record only once it is completely written
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+const char *history_type_name(HistoryType_t type)
+{
+    static const char *names[] = {"pir", "ldr", "smoke", "led", "motor"};
+
+    if ((size_t)type >= sizeof(names) / sizeof(names[0]))
+    {
+        return "unknown";
+    }
+    return names[type];
+}
+
+uint32_t history_head(HistoryRing_t *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire);
+}
+
+uint32_t history_oldest(HistoryRing_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head > ring->size ? head - ring->size : 0;
+}
+
+size_t history_read(HistoryRing_t *ring, uint32_t *cursor, HistoryRecord_t *out, size_t max)
+{
+    while (true)
+    {
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint32_t oldest = head > ring->size ? head - ring->size : 0;
+        uint32_t start = *cursor < oldest ? oldest : *cursor;
+
+        size_t count = head - start;
+        if (count > max)
+        {
+            count = max;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = ring->records[(start + i) & (ring->size - 1)];
+        }
+
+        // Find out whether the writer overwrote some of the copied records meanwhile,
+        // counting the record it may be writing right now
+        atomic_thread_fence(memory_order_acquire);
+        head = atomic_load_explicit(&ring->head, memory_order_relaxed) + 1;
+        oldest = head > ring->size ? head - ring->size : 0;
+        if (oldest <= start)
+        {
+            *cursor = start + count;
+            return count;
+        }
+
+        size_t skip = oldest - start;
+        if (skip < count)
+        {
+            memmove(out, out + skip, (count - skip) * sizeof(HistoryRecord_t));
+            *cursor = start + count;
+            return count - skip;
+        }
+
+        // The whole batch was overwritten, retry from the oldest valid record
+        *cursor = oldest;
+    }
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * @file        history.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Timestamped history of sensor transitions and motor angles.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+
+// Records kept per ring, must be a power of two
+#define HISTORY_SENSOR_RING_SIZE 128
+#define HISTORY_MOTOR_RING_SIZE 256
+
+/**
+ * @brief Source of a history record.
+ */
+typedef enum
+{
+    HISTORY_PIR,
+    HISTORY_LDR,
+    HISTORY_SMOKE,
+    HISTORY_LED,
+    HISTORY_MOTOR
+} HistoryType_t;
+
+/**
+ * @brief One state transition or motor angle sample.
+ */
+typedef struct
+{
+    uint32_t timestamp;    /*< Milliseconds since boot                         */
+    uint8_t type;          /*< HistoryType_t                                   */
+    uint8_t id;            /*< Motor number for HISTORY_MOTOR, 0 otherwise     */
+    uint16_t value;        /*< Pin level, or motor angle in tenths of a degree */
+} HistoryRecord_t;
+
+/**
+ * @brief Fixed size ring of records with a single writer.
+ * The writer never waits: once the ring is full the oldest records are
+ * overwritten. Readers detect records overwritten while they copied them.
+ */
+typedef struct
+{
+    HistoryRecord_t *records;   /*< Storage of size entries                     */
+    uint32_t size;              /*< Number of records, a power of two           */
+    atomic_uint_least32_t head; /*< Number of records ever written              */
+} HistoryRing_t;
+
+extern HistoryRing_t sensorHistory; // Written by the GPIO event task only
+extern HistoryRing_t motorHistory;  // Written by the motor default control task only
+
+/**
+ * @brief Milliseconds since boot, the time base of the records.
+ */
+uint32_t history_now(void);
+
+/**
+ * @brief Appends a record stamped with the current time.
+ * Must only be called from the single writer of the ring.
+ *
+ * @param ring  Ring to append to.
+ * @param type  Source of the record.
+ * @param id    Motor number, 0 for sensors.
+ * @param value Pin level or motor angle in tenths of a degree.
+ */
+void history_push(HistoryRing_t *ring, HistoryType_t type, uint8_t id, uint16_t value);
+
+/**
+ * @brief Short lowercase name of a record type ("pir", "ldr", "smoke", "led", "motor").
+ */
+const char *history_type_name(HistoryType_t type);
+
+/**
+ * @brief Index the next record of a ring will be written at.
+ */
+uint32_t history_head(HistoryRing_t *ring);
+
+/**
+ * @brief Index of the oldest record still held by a ring.
+ */
+uint32_t history_oldest(HistoryRing_t *ring);
+
+/**
+ * @brief Copies records starting at a ring index.
+ * Records already overwritten are skipped, so the cursor may jump forward.
+ *
+ * @param ring   Ring to read from.
+ * @param cursor In: index of the first record wanted. Out: index after the last copied one.
+ * @param out    Destination buffer.
+ * @param max    Capacity of out.
+ * @return Number of records copied, 0 once the reader has caught up.
+ */
+size_t history_read(HistoryRing_t *ring, uint32_t *cursor, HistoryRecord_t *out, size_t max);
+
+#endif  // HISTORY_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
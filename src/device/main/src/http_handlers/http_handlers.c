@@ -9,6 +9,31 @@
 
 #include "../http_handlers/http_handlers.h"
 
+// Multipart stream framing
+static const char *STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
+static const char *STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
+static const char *STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+
+// Read the optional ?fps=<n> query parameter of a stream request
+static uint32_t get_stream_fps(httpd_req_t *req)
+{
+    uint32_t fps = STREAM_DEFAULT_FPS;
+    char query[32];
+    char value[8];
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "fps", value, sizeof(value)) == ESP_OK)
+    {
+        int requested = atoi(value);
+        if (requested > 0)
+        {
+            fps = requested > STREAM_MAX_FPS ? STREAM_MAX_FPS : (uint32_t)requested;
+        }
+    }
+
+    return fps;
+}
+
 // HTTP request handler for getting a single image base64 encoded
 esp_err_t image_base64_httpd_handler(httpd_req_t *req)
 {
@@ -20,7 +45,7 @@ esp_err_t image_base64_httpd_handler(httpd_req_t *req)
         return ESP_OK;
     }
 
-    camera_fb_t *fb = esp_camera_fb_get();
+    camera_fb_t *fb = camera_frame_acquire(CAMERA_FRAME_TIMEOUT);
     if (!fb) {
         ESP_LOGE(CAMERA_TAG, "Camera capture failed");
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
@@ -30,36 +55,127 @@ esp_err_t image_base64_httpd_handler(httpd_req_t *req)
     // Set the content type header
     httpd_resp_set_type(req, "image/jpeg");
 
-    // Calculate the size of the base64-encoded data
-    size_t encoded_len = (fb->len + 2) / 3 * 4;
+    // Encode and send the image chunk by chunk from a fixed stack buffer
+    char encoded_chunk[BASE64_ENCODE_UPDATE_MAX(BASE64_CHUNK_SIZE)];
+    Base64EncodeCtx_t ctx;
+    base64_encode_init(&ctx);
+
+    // Only the time spent sending counts for the frame controller, not the encoding
+    esp_err_t res = ESP_OK;
+    size_t frame_len = fb->len;
+    size_t sent = 0;
+    int64_t send_us = 0;
+    for (size_t offset = 0; offset < fb->len && res == ESP_OK; offset += BASE64_CHUNK_SIZE) {
+        size_t chunk_len = fb->len - offset;
+        if (chunk_len > BASE64_CHUNK_SIZE) {
+            chunk_len = BASE64_CHUNK_SIZE;
+        }
+
+        // A zero length chunk would terminate the response, skip it
+        size_t encoded_len = base64_encode_update(&ctx, fb->buf + offset, chunk_len, encoded_chunk);
+        if (encoded_len > 0) {
+            int64_t start = esp_timer_get_time();
+            res = httpd_resp_send_chunk(req, encoded_chunk, encoded_len);
+            send_us += esp_timer_get_time() - start;
+            sent += encoded_len;
+        }
+    }
 
-    char *encoded_data = (char *)malloc(encoded_len);
-    if (!encoded_data) {
-        ESP_LOGE(CAMERA_TAG, "Memory allocation failed");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
-        esp_camera_fb_return(fb);
+    if (res == ESP_OK) {
+        size_t encoded_len = base64_encode_final(&ctx, encoded_chunk);
+        if (encoded_len > 0) {
+            int64_t start = esp_timer_get_time();
+            res = httpd_resp_send_chunk(req, encoded_chunk, encoded_len);
+            send_us += esp_timer_get_time() - start;
+            sent += encoded_len;
+        }
+    }
+
+    // Cleanup
+    camera_frame_release(fb);
+
+    if (res != ESP_OK) {
+        ESP_LOGE(CAMERA_TAG, "Sending base64 image failed");
         return ESP_FAIL;
     }
 
-    // Encode the image data using base64
-    size_t encoded_data_len = encoded_len;
-    int ret = base64_encode((const unsigned char *)fb->buf, fb->len, encoded_data, &encoded_data_len);
-    if (ret != 0) {
-        ESP_LOGE(CAMERA_TAG, "Base64 encoding failed. Error code: %d", ret);
-        ESP_LOGE(CAMERA_TAG, "Encoded data length: %d", encoded_data_len);
+    // The controller sizes JPEG frames: report the frame length, with the time
+    // the link would take to send it at the rate the encoded bytes went out
+    if (sent > 0) {
+        frame_control_record_send(frame_len, send_us * (int64_t)frame_len / (int64_t)sent);
+    }
+
+    // Terminate the chunked response
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Send a region of the sensor read out at full resolution (?roi=x,y,w,h&scale=n)
+static esp_err_t send_window_image(httpd_req_t *req, const char *query, const char *roi)
+{
+    CameraWindow_t window = {0};
+    uint16_t *bounds[] = {&window.x, &window.y, &window.width, &window.height};
+    const char *p = roi;
+    for (int i = 0; i < 4; i++) {
+        char *end;
+        unsigned long bound = strtoul(p, &end, 10);
+        if (end == p || bound > UINT16_MAX || *end != (i < 3 ? ',' : '\0')) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected roi=x,y,w,h");
+            return ESP_OK;
+        }
+        *bounds[i] = (uint16_t)bound;
+        p = end + 1;
+    }
+
+    char value[4];
+    if (httpd_query_key_value(query, "scale", value, sizeof(value)) == ESP_OK) {
+        int scale = atoi(value);
+        if (scale < 1 || scale > CAMERA_WINDOW_MAX_SCALE) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Scale out of range");
+            return ESP_OK;
+        }
+        window.scale = (uint8_t)scale;
+    }
+
+    camera_fb_t *fb = NULL;
+    esp_err_t err = camera_window_capture(&window, CAMERA_FRAME_TIMEOUT, &fb);
+    if (err == ESP_ERR_INVALID_ARG) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Region outside the sensor or too large for the scale");
+        return ESP_OK;
+    }
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        httpd_resp_send_err(req, HTTPD_501_METHOD_NOT_IMPLEMENTED, "Sensor windowing not supported");
+        return ESP_OK;
+    }
+    if (err == ESP_ERR_INVALID_STATE) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        return httpd_resp_sendstr(req, "Another region is being read out");
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(CAMERA_TAG, "Region capture failed");
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
-        free(encoded_data);
-        esp_camera_fb_return(fb);
         return ESP_FAIL;
     }
 
-    // Send the encoded image data as the response
-    httpd_resp_send(req, encoded_data, encoded_data_len);
+    // The region read out, its edges are aligned to the sensor
+    char roi_header[24];
+    char scale_header[4];
+    snprintf(roi_header, sizeof(roi_header), "%u,%u,%u,%u",
+             window.x, window.y, window.width, window.height);
+    snprintf(scale_header, sizeof(scale_header), "%u", window.scale);
+    httpd_resp_set_hdr(req, "X-Roi", roi_header);
+    httpd_resp_set_hdr(req, "X-Roi-Scale", scale_header);
+    httpd_resp_set_type(req, "image/jpeg");
 
-    // Cleanup
-    free(encoded_data);
-    esp_camera_fb_return(fb);
+    // Not fed to the frame controller, a region says nothing about the frame setting
+    esp_err_t res = httpd_resp_send(req, (const char *)fb->buf, fb->len);
 
+    camera_frame_release(fb);
+
+    if (res != ESP_OK) {
+        ESP_LOGE(CAMERA_TAG, "Sending region image failed");
+        return ESP_FAIL;
+    }
     return ESP_OK;
 }
 
@@ -74,7 +190,24 @@ esp_err_t image_httpd_handler(httpd_req_t *req)
         return ESP_OK;
     }
 
-    camera_fb_t *fb = esp_camera_fb_get();
+    char query[IMAGE_QUERY_SIZE];
+    char value[IMAGE_ROI_SIZE];
+    bool has_query = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+
+    // With ?haze=1 only frames the haze detector finds worth uploading are sent
+    if (has_query &&
+        httpd_query_key_value(query, "haze", value, sizeof(value)) == ESP_OK &&
+        atoi(value) != 0 && !haze_gate_open())
+    {
+        httpd_resp_set_status(req, HTTPD_204);
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    if (has_query && httpd_query_key_value(query, "roi", value, sizeof(value)) == ESP_OK) {
+        return send_window_image(req, query, value);
+    }
+
+    camera_fb_t *fb = camera_frame_acquire(CAMERA_FRAME_TIMEOUT);
     if (!fb) {
         ESP_LOGE(CAMERA_TAG, "Camera capture failed");
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
@@ -84,13 +217,580 @@ esp_err_t image_httpd_handler(httpd_req_t *req)
     // Set the content type header
     httpd_resp_set_type(req, "image/jpeg");
 
+    // Send the image data, timed for the frame controller
+    int64_t start = esp_timer_get_time();
+    esp_err_t res = httpd_resp_send(req, (const char *)fb->buf, fb->len);
+    int64_t send_us = esp_timer_get_time() - start;
+    size_t sent = fb->len;
+
+    camera_frame_release(fb);
+
+    if (res == ESP_OK) {
+        frame_control_record_send(sent, send_us);
+    }
+    return ESP_OK;
+}
+
+// HTTP request handler for a 1/8 scale grayscale preview of the latest frame
+esp_err_t thumb_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    camera_fb_t *fb = camera_frame_acquire(CAMERA_FRAME_TIMEOUT);
+    if (!fb) {
+        ESP_LOGE(CAMERA_TAG, "Camera capture failed");
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
+        return ESP_FAIL;
+    }
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    esp_err_t err = fb->format == PIXFORMAT_JPEG ? jpeg_dc_get_size(fb->buf, fb->len, &width, &height)
+                                                 : ESP_ERR_NOT_SUPPORTED;
+
+    // The PGM header is written in front of the luma, so the image goes out in one send
+    char header[THUMB_HEADER_SIZE];
+    int header_len = snprintf(header, sizeof(header), "P5\n%u %u\n255\n", width, height);
+    size_t pixels = (size_t)width * height;
+    JpegDcDecoder_t *decoder = NULL;
+    char *pgm = NULL;
+
+    if (err == ESP_OK) {
+        decoder = heap_caps_malloc(sizeof(JpegDcDecoder_t), MALLOC_CAP_8BIT);
+        pgm = heap_caps_malloc(header_len + pixels, MALLOC_CAP_8BIT);
+        err = decoder != NULL && pgm != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+    }
+    if (err == ESP_OK) {
+        JpegDcImage_t image = {.luma = (uint8_t *)pgm + header_len, .saturation = NULL, .capacity = pixels};
+        err = jpeg_dc_decode(decoder, fb->buf, fb->len, &image);
+    }
+
+    // Only the thumbnail is sent, give the frame back before the transfer
+    camera_frame_release(fb);
+    free(decoder);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(CAMERA_TAG, "Thumbnail failed: %s", esp_err_to_name(err));
+        free(pgm);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
+        return ESP_FAIL;
+    }
+
+    memcpy(pgm, header, header_len);
+    httpd_resp_set_type(req, "image/x-portable-graymap");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    esp_err_t res = httpd_resp_send(req, pgm, header_len + pixels);
+
+    free(pgm);
+    return res;
+}
+
+// HTTP request handler for streaming images as MJPEG
+esp_err_t stream_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    uint32_t fps = get_stream_fps(req);
+    TickType_t frame_period = pdMS_TO_TICKS(1000 / fps);
+    if (frame_period == 0) {
+        frame_period = 1;
+    }
+
+    // Set the content type header
+    esp_err_t res = httpd_resp_set_type(req, STREAM_CONTENT_TYPE);
+    if (res != ESP_OK) {
+        return res;
+    }
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    ESP_LOGI(CAMERA_TAG, "Stream started at %u fps", (unsigned)fps);
+
+    char part_header[64];
+    uint32_t frame_seq = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (true) {
+        // Only send frames the client has not seen yet
+        camera_fb_t *fb = camera_frame_acquire_next(&frame_seq, CAMERA_FRAME_TIMEOUT);
+        if (!fb) {
+            ESP_LOGE(CAMERA_TAG, "Camera capture failed");
+            res = ESP_FAIL;
+            break;
+        }
+
+        size_t header_len = snprintf(part_header, sizeof(part_header), STREAM_PART, (unsigned)fb->len);
+        size_t sent = strlen(STREAM_BOUNDARY) + header_len + fb->len;
+        int64_t start = esp_timer_get_time();
+
+        res = httpd_resp_send_chunk(req, STREAM_BOUNDARY, strlen(STREAM_BOUNDARY));
+        if (res == ESP_OK) {
+            res = httpd_resp_send_chunk(req, part_header, header_len);
+        }
+        if (res == ESP_OK) {
+            // The frame buffer is handed to the socket as is, no intermediate copy
+            res = httpd_resp_send_chunk(req, (const char *)fb->buf, fb->len);
+        }
+        int64_t send_us = esp_timer_get_time() - start;
+
+        camera_frame_release(fb);
+
+        if (res != ESP_OK) {
+            // Client closed the connection
+            break;
+        }
+
+        frame_control_record_send(sent, send_us);
+
+        vTaskDelayUntil(&last_wake, frame_period);
+    }
+
+    ESP_LOGI(CAMERA_TAG, "Stream stopped");
+    return res;
+}
+
+// HTTP request handler for getting a frame in which motion was detected
+esp_err_t motion_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    // Read the optional ?since=<id> query parameter
+    uint32_t since = 0;
+    char query[32];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK)
+    {
+        since = strtoul(value, NULL, 10);
+    }
+
+    MotionSnapshot_t *snapshot = motion_snapshot_acquire(since);
+    if (!snapshot) {
+        httpd_resp_set_status(req, HTTPD_204);
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    char id[12];
+    char timestamp[24];
+    char changed[8];
+    snprintf(id, sizeof(id), "%u", (unsigned)snapshot->id);
+    snprintf(timestamp, sizeof(timestamp), "%lld", (long long)snapshot->timestamp);
+    snprintf(changed, sizeof(changed), "%u", snapshot->changedPermille);
+
+    // Set the content type and motion headers
+    httpd_resp_set_type(req, "image/jpeg");
+    httpd_resp_set_hdr(req, "X-Motion-Id", id);
+    httpd_resp_set_hdr(req, "X-Motion-Timestamp", timestamp);
+    httpd_resp_set_hdr(req, "X-Motion-Changed-Permille", changed);
+
     // Send the image data
-    httpd_resp_send(req, (const char *)fb->buf, fb->len);
+    esp_err_t res = httpd_resp_send(req, (const char *)snapshot->buf, snapshot->len);
+
+    motion_snapshot_release(snapshot);
+    return res;
+}
+
+// Send the records of a ring from a record index on as the elements of a JSON
+// array. The cursor is left at the index after the last record sent.
+static esp_err_t send_history_ring(httpd_req_t *req, HistoryRing_t *ring, uint32_t *cursor)
+{
+    HistoryRecord_t records[HISTORY_READ_BATCH];
+    char chunk[HISTORY_CHUNK_SIZE];
+    size_t len = 0;
+    bool first = true;
+    size_t count;
+
+    // A cursor ahead of the ring comes from before a reboot, start over
+    if (*cursor > history_head(ring)) {
+        *cursor = 0;
+    }
+
+    while ((count = history_read(ring, cursor, records, HISTORY_READ_BATCH)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const HistoryRecord_t *record = &records[i];
+
+            // Room for the longest entry: ,[4294967295,255,6553.5]
+            if (len + 32 > sizeof(chunk)) {
+                esp_err_t res = httpd_resp_send_chunk(req, chunk, len);
+                if (res != ESP_OK) {
+                    return res;
+                }
+                len = 0;
+            }
+
+            if (record->type == HISTORY_MOTOR) {
+                len += snprintf(chunk + len, sizeof(chunk) - len, "%s[%u,%u,%u.%u]", first ? "" : ",",
+                                (unsigned)record->timestamp, record->id, record->value / 10, record->value % 10);
+            } else {
+                len += snprintf(chunk + len, sizeof(chunk) - len, "%s[%u,\"%s\",%u]", first ? "" : ",",
+                                (unsigned)record->timestamp, history_type_name(record->type), record->value);
+            }
+            first = false;
+        }
+    }
+
+    if (len > 0) {
+        return httpd_resp_send_chunk(req, chunk, len);
+    }
+    return ESP_OK;
+}
+
+// HTTP request handler for getting the sensor and motor history
+esp_err_t history_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    // Read the optional ?sensors=<index>&motors=<index> cursors. Record indices
+    // never repeat, unlike timestamps several records can share
+    uint32_t sensor_cursor = 0;
+    uint32_t motor_cursor = 0;
+    char query[48];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "sensors", value, sizeof(value)) == ESP_OK) {
+            sensor_cursor = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "motors", value, sizeof(value)) == ESP_OK) {
+            motor_cursor = strtoul(value, NULL, 10);
+        }
+    }
+
+    httpd_resp_set_type(req, "application/json");
+
+    esp_err_t res = httpd_resp_sendstr_chunk(req, "{\"sensors\":[");
+    if (res == ESP_OK) {
+        res = send_history_ring(req, &sensorHistory, &sensor_cursor);
+    }
+    if (res == ESP_OK) {
+        res = httpd_resp_sendstr_chunk(req, "],\"motors\":[");
+    }
+    if (res == ESP_OK) {
+        res = send_history_ring(req, &motorHistory, &motor_cursor);
+    }
+    if (res == ESP_OK) {
+        char tail[56];
+        snprintf(tail, sizeof(tail), "],\"next\":{\"sensors\":%u,\"motors\":%u}}",
+                 (unsigned)sensor_cursor, (unsigned)motor_cursor);
+        res = httpd_resp_sendstr_chunk(req, tail);
+    }
+
+    if (res != ESP_OK) {
+        ESP_LOGE(WEBSERVER_TAG, "Sending history failed");
+        return ESP_FAIL;
+    }
+
+    // Terminate the chunked response
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Write the current sensor, LED and motor values, shared by /state and /events
+static size_t write_state_json(char *buf, size_t size)
+{
+    JsonWriter_t writer;
+    json_writer_init(&writer, buf, size);
+
+    json_writer_begin_object(&writer, NULL);
+    json_writer_add_uint(&writer, "uptime_ms", esp_timer_get_time() / 1000);
+
+    json_writer_begin_object(&writer, "sensors");
+    json_writer_add_uint(&writer, "pir", getPirState());
+    json_writer_add_uint(&writer, "ldr", getLdrState());
+    json_writer_add_uint(&writer, "smoke", getSmokeSensorState());
+    json_writer_end_object(&writer);
+
+    json_writer_add_uint(&writer, "led", getLedState());
+
+    // Lock-free snapshots, never wait on the motor tasks or the planner
+    MotorState motor1State;
+    MotorState motor2State;
+    get_motor_state(&motor1, &motor1State);
+    get_motor_state(&motor2, &motor2State);
+
+    json_writer_begin_object(&writer, "motors");
+    json_writer_begin_object(&writer, "1");
+    json_writer_add_float(&writer, "angle", motor1State.angle, 1);
+    json_writer_add_float(&writer, "target", motor1State.target, 1);
+    json_writer_add_bool(&writer, "active", motor1State.is_active);
+    json_writer_end_object(&writer);
+    json_writer_begin_object(&writer, "2");
+    json_writer_add_float(&writer, "angle", motor2State.angle, 1);
+    json_writer_add_float(&writer, "target", motor2State.target, 1);
+    json_writer_add_bool(&writer, "active", motor2State.is_active);
+    json_writer_end_object(&writer);
+    json_writer_end_object(&writer);
+
+    json_writer_end_object(&writer);
+
+    return json_writer_finish(&writer);
+}
+
+// HTTP request handler for getting every sensor, LED and motor value at once
+esp_err_t state_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    char response[STATE_RESPONSE_SIZE];
+    size_t len = write_state_json(response, sizeof(response));
+    if (len == 0) {
+        ESP_LOGE(WEBSERVER_TAG, "State response does not fit in %d bytes", STATE_RESPONSE_SIZE);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, response, len);
+}
+
+// HTTP request handler for the Server-Sent Events push channel
+esp_err_t events_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    if (events_client_count() >= EVENTS_MAX_CLIENTS) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "10");
+        return httpd_resp_sendstr(req, "Too many event clients");
+    }
+
+    // Initial snapshot, so clients do not have to call /state first
+    char state[STATE_RESPONSE_SIZE];
+    if (write_state_json(state, sizeof(state)) == 0) {
+        ESP_LOGE(WEBSERVER_TAG, "State response does not fit in %d bytes", STATE_RESPONSE_SIZE);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
+        return ESP_FAIL;
+    }
+
+    // Keep the connection open after this handler returns
+    httpd_req_t *async_req;
+    esp_err_t err = httpd_req_async_handler_begin(req, &async_req);
+    if (err != ESP_OK) {
+        ESP_LOGE(WEBSERVER_TAG, "Failed to start event stream: %s", esp_err_to_name(err));
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
+        return err;
+    }
+
+    httpd_resp_set_type(async_req, "text/event-stream");
+    httpd_resp_set_hdr(async_req, "Cache-Control", "no-cache");
+
+    char chunk[STATE_RESPONSE_SIZE + 32];
+    int len = snprintf(chunk, sizeof(chunk), "retry: 3000\nevent: state\ndata: %s\n\n", state);
+    err = httpd_resp_send_chunk(async_req, chunk, len);
+    if (err == ESP_OK) {
+        err = events_add_client(async_req);
+    }
+    if (err != ESP_OK) {
+        httpd_req_async_handler_complete(async_req);
+        return ESP_OK;
+    }
+
+    ESP_LOGI(WEBSERVER_TAG, "Event client connected");
+    return ESP_OK;
+}
+
+// HTTP request handler for getting the patrol preset list
+esp_err_t patrol_get_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    PatrolPreset_t presets[PATROL_MAX_PRESETS];
+    size_t count = patrol_get_presets(presets, PATROL_MAX_PRESETS);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *list = cJSON_AddArrayToObject(root, "presets");
+    for (size_t i = 0; i < count; i++) {
+        cJSON *preset = cJSON_CreateObject();
+        cJSON_AddNumberToObject(preset, "pan", presets[i].pan / 10.0);
+        cJSON_AddNumberToObject(preset, "tilt", presets[i].tilt / 10.0);
+        cJSON_AddNumberToObject(preset, "dwell_ms", presets[i].dwellMs);
+        cJSON_AddBoolToObject(preset, "capture", presets[i].capture);
+        cJSON_AddItemToArray(list, preset);
+    }
+
+    char *response = cJSON_PrintUnformatted(root);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response, strlen(response));
+
+    cJSON_Delete(root);
+    free(response);
 
-    esp_camera_fb_return(fb);
     return ESP_OK;
 }
 
+// Read one preset object, angles in degrees
+static bool parse_patrol_preset(const cJSON *item, PatrolPreset_t *preset)
+{
+    cJSON *pan = cJSON_GetObjectItem(item, "pan");
+    cJSON *tilt = cJSON_GetObjectItem(item, "tilt");
+    cJSON *dwell = cJSON_GetObjectItem(item, "dwell_ms");
+    cJSON *capture = cJSON_GetObjectItem(item, "capture");
+
+    if (!cJSON_IsNumber(pan) || !cJSON_IsNumber(tilt) || !cJSON_IsNumber(dwell) ||
+        (capture != NULL && !cJSON_IsBool(capture))) {
+        return false;
+    }
+    if (pan->valuedouble < 0 || pan->valuedouble > SERVO_MAX_ANGLE ||
+        tilt->valuedouble < 0 || tilt->valuedouble > SERVO_MAX_ANGLE ||
+        dwell->valuedouble < 0 || dwell->valuedouble > UINT16_MAX) {
+        return false;
+    }
+
+    preset->pan = (uint16_t)(pan->valuedouble * 10 + 0.5);
+    preset->tilt = (uint16_t)(tilt->valuedouble * 10 + 0.5);
+    preset->dwellMs = (uint16_t)dwell->valuedouble;
+    preset->capture = cJSON_IsTrue(capture) ? 1 : 0;
+    preset->reserved = 0;
+    return true;
+}
+
+// HTTP request handler for replacing the patrol preset list
+esp_err_t patrol_set_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Insufficient permissions");
+        return ESP_OK;
+    }
+
+    if (req->content_len == 0 || req->content_len > PATROL_BODY_MAX) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bad Request");
+        return ESP_OK;
+    }
+
+    // Read the whole body, it may arrive in several parts
+    char *content = malloc(req->content_len + 1);
+    if (!content) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Internal Server Error");
+        return ESP_OK;
+    }
+    size_t received = 0;
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, content + received, req->content_len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret <= 0) {
+            free(content);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bad Request");
+            return ESP_OK;
+        }
+        received += ret;
+    }
+    content[received] = '\0';
+
+    cJSON *json = cJSON_Parse(content);
+    free(content);
+    cJSON *list = json ? cJSON_GetObjectItem(json, "presets") : NULL;
+    if (!cJSON_IsArray(list) || cJSON_GetArraySize(list) > PATROL_MAX_PRESETS) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_OK;
+    }
+
+    PatrolPreset_t presets[PATROL_MAX_PRESETS];
+    size_t count = cJSON_GetArraySize(list);
+    for (size_t i = 0; i < count; i++) {
+        if (!parse_patrol_preset(cJSON_GetArrayItem(list, i), &presets[i])) {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid preset");
+            return ESP_OK;
+        }
+    }
+    cJSON_Delete(json);
+
+    if (patrol_set_presets(presets, count) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save presets");
+        return ESP_OK;
+    }
+
+    httpd_resp_sendstr(req, "Presets saved");
+    return ESP_OK;
+}
+
+// HTTP request handler for getting the frame kept at a patrol preset
+esp_err_t patrol_capture_httpd_handler(httpd_req_t *req)
+{
+    // Authenticate the user
+    authenticatedUserRole = authenticateUser(req);
+
+    if (authenticatedUserRole != ROLE_USER && authenticatedUserRole != ROLE_ADMIN) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+        return ESP_OK;
+    }
+
+    // Read the ?preset=<n> query parameter
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "preset", value, sizeof(value)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing preset");
+        return ESP_OK;
+    }
+    unsigned long preset = strtoul(value, NULL, 10);
+
+    PatrolCapture_t *capture = preset < PATROL_MAX_PRESETS ? patrol_capture_acquire(preset) : NULL;
+    if (!capture) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No frame at this preset");
+        return ESP_OK;
+    }
+
+    char timestamp[24];
+    snprintf(timestamp, sizeof(timestamp), "%lld", (long long)capture->timestamp);
+
+    // Set the content type and capture headers
+    httpd_resp_set_type(req, "image/jpeg");
+    httpd_resp_set_hdr(req, "X-Patrol-Timestamp", timestamp);
+
+    // Send the image data
+    esp_err_t res = httpd_resp_send(req, (const char *)capture->buf, capture->len);
+
+    patrol_capture_release(capture);
+    return res;
+}
+
 // HTTP request handler for getting the camera status
 esp_err_t status_httpd_handler(httpd_req_t *req)
 {
@@ -105,6 +805,78 @@ esp_err_t status_httpd_handler(httpd_req_t *req)
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "status", "online");
 
+    // Interrupt processing counters
+    GpioEventStats_t stats;
+    get_gpio_event_stats(&stats);
+    cJSON *gpio_events = cJSON_AddObjectToObject(root, "gpio_events");
+    cJSON_AddNumberToObject(gpio_events, "processed", stats.processed);
+    cJSON_AddNumberToObject(gpio_events, "bounced", stats.bounced);
+    cJSON_AddNumberToObject(gpio_events, "dropped", stats.dropped);
+    cJSON_AddNumberToObject(gpio_events, "last_latency_us", stats.lastLatencyUs);
+    cJSON_AddNumberToObject(gpio_events, "max_latency_us", stats.maxLatencyUs);
+
+    // Log sink counters
+    LogSinkStats_t logStats;
+    log_sink_get_stats(&logStats);
+    cJSON *log = cJSON_AddObjectToObject(root, "log");
+    cJSON_AddNumberToObject(log, "written", logStats.written);
+    cJSON_AddNumberToObject(log, "dropped", logStats.dropped);
+    cJSON_AddNumberToObject(log, "truncated", logStats.truncated);
+
+    // Haze detector result
+    HazeStatus_t hazeStatus;
+    haze_get_status(&hazeStatus);
+    cJSON *haze = cJSON_AddObjectToObject(root, "haze");
+    cJSON_AddNumberToObject(haze, "score", hazeStatus.features.score);
+    cJSON_AddNumberToObject(haze, "contrast_loss", hazeStatus.features.contrastLoss);
+    cJSON_AddNumberToObject(haze, "gray_growth", hazeStatus.features.grayGrowth);
+    cJSON_AddNumberToObject(haze, "temporal", hazeStatus.features.temporal);
+    cJSON_AddBoolToObject(haze, "gate_open", hazeStatus.gateOpen);
+    cJSON_AddNumberToObject(haze, "frames", hazeStatus.frames);
+    cJSON_AddNumberToObject(haze, "errors", hazeStatus.errors);
+    cJSON_AddNumberToObject(haze, "last_check_us", hazeStatus.lastCheckUs);
+    cJSON_AddNumberToObject(haze, "max_check_us", hazeStatus.maxCheckUs);
+
+    // Frame size and quality picked for the measured link
+    FrameControl_t frameControl;
+    frame_control_get_status(&frameControl);
+    const FrameControlStep_t *setting = frame_control_step(frameControl.step);
+    cJSON *frame_control = cJSON_AddObjectToObject(root, "frame_control");
+    cJSON_AddNumberToObject(frame_control, "step", frameControl.step);
+    cJSON_AddNumberToObject(frame_control, "frame_size", setting->frameSize);
+    cJSON_AddNumberToObject(frame_control, "quality", setting->quality);
+    cJSON_AddNumberToObject(frame_control, "throughput", frameControl.throughput);
+    cJSON_AddNumberToObject(frame_control, "frame_bytes", frameControl.frameBytes);
+    cJSON_AddNumberToObject(frame_control, "frame_ms", frameControl.frameMs);
+    cJSON_AddNumberToObject(frame_control, "target_ms", FRAME_CONTROL_TARGET_MS);
+    cJSON_AddNumberToObject(frame_control, "sends", frameControl.sends);
+    cJSON_AddNumberToObject(frame_control, "changes", frameControl.changes);
+
+    // Classifier result
+    ClassifierStatus_t classifierStatus;
+    classifier_get_status(&classifierStatus);
+    cJSON *classifier = cJSON_AddObjectToObject(root, "classifier");
+    cJSON_AddBoolToObject(classifier, "ready", classifierStatus.ready);
+    cJSON_AddNumberToObject(classifier, "score", classifierStatus.score);
+    cJSON_AddNumberToObject(classifier, "top_class", classifierStatus.topClass);
+    cJSON_AddNumberToObject(classifier, "frames", classifierStatus.frames);
+    cJSON_AddNumberToObject(classifier, "errors", classifierStatus.errors);
+    cJSON_AddNumberToObject(classifier, "last_run_us", classifierStatus.lastRunUs);
+    cJSON_AddNumberToObject(classifier, "max_run_us", classifierStatus.maxRunUs);
+    cJSON_AddNumberToObject(classifier, "macs", classifierStatus.macs);
+
+#if ENABLE_BT
+    // Bluetooth SPP transmit queue counters
+    BtTxStats_t btStats;
+    bt_get_tx_stats(&btStats);
+    cJSON *bt_tx = cJSON_AddObjectToObject(root, "bt_tx");
+    cJSON_AddNumberToObject(bt_tx, "queued", btStats.queued);
+    cJSON_AddNumberToObject(bt_tx, "sent", btStats.sent);
+    cJSON_AddNumberToObject(bt_tx, "dropped", btStats.dropped);
+    cJSON_AddNumberToObject(bt_tx, "writes", btStats.writes);
+    cJSON_AddNumberToObject(bt_tx, "congestions", btStats.congestions);
+#endif /* ENABLE_BT */
+
     char *response = cJSON_Print(root);
 
     httpd_resp_set_type(req, "application/json");
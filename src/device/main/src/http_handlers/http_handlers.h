@@ -18,14 +18,54 @@
 #include <esp_camera.h>
 #include <cJSON.h>
 #include <esp_http_server.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #include "../logging/logging_utils.h"
 #include "../user_roles/user_roles.h"
 #include "../base64/base64_utils.h"
 #include "../camera/camera_pins.h"
+#include "../camera/camera_utils.h"
+#include "../motion/motion_detection.h"
+#include "../haze/haze_detector.h"
+#include "../jpeg_dc/jpeg_dc.h"
+#include "../frame_control/frame_control.h"
+#include "../classifier/classifier.h"
 #include "../gpio_interrupts/gpio_interrupts.h"
 #include "../gpio_state/gpio_state.h"
 #include "../motor_control/motor_control.h"
+#include "../task_utils/task_utils.h"
+#include "../history/history.h"
+#include "../events/events.h"
+#include "../patrol/patrol.h"
+#include "../json_writer/json_writer.h"
+
+// Boundary for multipart/x-mixed-replace content type
+#define PART_BOUNDARY "123456789000000000000987654321"
+
+// Frame rate used by /stream when no ?fps=<n> query parameter is given
+#define STREAM_DEFAULT_FPS 10
+// Upper bound accepted for the ?fps=<n> query parameter
+#define STREAM_MAX_FPS 30
+
+// Size of the /image query string, room for roi=x,y,w,h&scale=n&haze=1
+#define IMAGE_QUERY_SIZE 64
+// Size of the value of the ?roi=x,y,w,h query parameter
+#define IMAGE_ROI_SIZE 24
+
+// Room for the "P5\n<width> <height>\n255\n" header of the /thumb PGM image
+#define THUMB_HEADER_SIZE 24
+
+// Size of the stack buffer the /state reply is written to
+#define STATE_RESPONSE_SIZE 256
+
+// Largest preset list body accepted by POST /patrol
+#define PATROL_BODY_MAX 2048
+
+// Records copied from a history ring per read in /history
+#define HISTORY_READ_BATCH 16
+// Size of the buffer /history formats its response in before sending a chunk
+#define HISTORY_CHUNK_SIZE 512
 
 /**
  * @brief       The authenticated user role.
@@ -42,11 +82,106 @@ esp_err_t image_base64_httpd_handler(httpd_req_t *req);
 
 /**
  * @brief       HTTP request handler for getting a single image.
+ * @details     With the ?haze=1 query parameter the image is only sent while the
+ *              haze detector gate is open, 204 No Content is returned otherwise.
+ *              With ?roi=x,y,w,h only that region of the sensor is read out, in
+ *              full resolution (UXGA) pixels, see camera_window_capture(). The
+ *              optional ?scale=n divides its size, by default the smallest scale
+ *              that fits the frame buffers is used. The region read out and the
+ *              scale are returned in the X-Roi and X-Roi-Scale headers.
  * @param[in]   req The HTTP request object.
  * @return      An esp_err_t indicating the success or failure of the operation.
  */
 esp_err_t image_httpd_handler(httpd_req_t *req);
 
+/**
+ * @brief       HTTP request handler for a grayscale preview of the latest frame.
+ * @details     Sends the 1/8 scale luma of the frame (80x60 for VGA) as a binary
+ *              PGM image. Only the DC coefficients of the JPEG data are decoded,
+ *              see jpeg_dc_decode().
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t thumb_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for an MJPEG stream (multipart/x-mixed-replace).
+ * @details     Keeps the connection open and pushes one JPEG part per frame, sending
+ *              the camera frame buffer directly to the socket without copying it.
+ *              The frame rate can be selected with the ?fps=<n> query parameter
+ *              (1 to STREAM_MAX_FPS, STREAM_DEFAULT_FPS when omitted).
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t stream_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for getting a frame in which motion was detected.
+ * @details     Returns the oldest stored motion frame newer than the ?since=<id> query
+ *              parameter (any stored frame when omitted), with its id in the
+ *              X-Motion-Id header. Answers 204 No Content when there is none, so
+ *              clients can poll cheaply instead of pulling every image.
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t motion_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for getting the sensor and motor history.
+ * @details     Returns every sensor transition and motor angle still held from the
+ *              ?sensors=<index>&motors=<index> record indices on (0 when omitted)
+ *              in one JSON document. The "next" member holds the indices to pass on
+ *              the following request.
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t history_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for getting every sensor, LED and motor value at once.
+ * @details     The reply is written to a stack buffer with the JSON writer, the
+ *              request does not allocate any memory.
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t state_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for the Server-Sent Events push channel.
+ * @details     Replies with a text/event-stream that starts with the /state values
+ *              and then carries every sensor transition and motor angle change.
+ *              The connection is handed to the event stream task, so it does not
+ *              hold an HTTP server worker.
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t events_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for getting the patrol preset list.
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t patrol_get_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for replacing the patrol preset list.
+ * @details     Admin only. The list is saved to NVS and the patrol restarts at the
+ *              first preset, an empty list returns the motors to the default sweep.
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t patrol_set_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief       HTTP request handler for getting the frame kept at a patrol preset.
+ * @details     The preset index is given with ?preset=<n>. Answers 404 if no frame
+ *              was kept at it since the list was set.
+ * @param[in]   req The HTTP request object.
+ * @return      An esp_err_t indicating the success or failure of the operation.
+ */
+esp_err_t patrol_capture_httpd_handler(httpd_req_t *req);
+
 /**
  * @brief       HTTP request handler for getting the camera status.
  * @param[in]   req The HTTP request object.
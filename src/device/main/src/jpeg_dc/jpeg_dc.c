@@ -0,0 +1,663 @@
+/*******************************************************************************
+ * @file        jpeg_dc.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../jpeg_dc/jpeg_dc.h"
+
+// Marker codes, the byte following 0xFF
+#define JPEG_SOF0 0xC0  // Baseline
+#define JPEG_SOF1 0xC1  // Extended sequential, Huffman
+#define JPEG_DHT  0xC4
+#define JPEG_JPG  0xC8
+#define JPEG_DAC  0xCC
+#define JPEG_RST0 0xD0
+#define JPEG_RST7 0xD7
+#define JPEG_SOI  0xD8
+#define JPEG_EOI  0xD9
+#define JPEG_SOS  0xDA
+#define JPEG_DQT  0xDB
+#define JPEG_DRI  0xDD
+#define JPEG_TEM  0x01
+
+#define JPEG_MAX_COMPONENTS 3
+#define JPEG_MAX_SAMPLING 2
+
+typedef struct
+{
+    uint8_t id;
+    uint8_t h;                  // Horizontal sampling factor
+    uint8_t v;                  // Vertical sampling factor
+    uint8_t quant;              // Quantization table
+    uint8_t dcTable;
+    uint8_t acTable;
+    int32_t pred;               // DC predictor
+} JpegComponent_t;
+
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t count;
+    uint8_t hmax;
+    uint8_t vmax;
+    uint16_t restartInterval;
+    JpegComponent_t comps[JPEG_MAX_COMPONENTS];
+} JpegFrame_t;
+
+// Entropy coded data, bits are kept MSB aligned in a 32 bit buffer
+typedef struct
+{
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    uint32_t bits;
+    int count;
+    bool marker;                // A marker was reached, zeros are fed from now on
+} JpegBits_t;
+
+// Step to the next marker segment. Payload is NULL for standalone markers
+static bool next_segment(const uint8_t *jpg, size_t len, size_t *pos, uint8_t *marker,
+                         const uint8_t **payload, size_t *payloadLen)
+{
+    size_t p = *pos;
+    if (p >= len || jpg[p] != 0xFF)
+    {
+        return false;
+    }
+
+    // Markers may be preceded by fill bytes
+    while (p < len && jpg[p] == 0xFF)
+    {
+        p++;
+    }
+    if (p >= len)
+    {
+        return false;
+    }
+
+    *marker = jpg[p++];
+    *payload = NULL;
+    *payloadLen = 0;
+
+    if (*marker == JPEG_SOI || *marker == JPEG_TEM || (*marker >= JPEG_RST0 && *marker <= JPEG_RST7))
+    {
+        *pos = p;
+        return true;
+    }
+
+    if (p + 2 > len)
+    {
+        return false;
+    }
+    size_t segmentLen = ((size_t)jpg[p] << 8) | jpg[p + 1];
+    if (segmentLen < 2 || p + segmentLen > len)
+    {
+        return false;
+    }
+
+    *payload = jpg + p + 2;
+    *payloadLen = segmentLen - 2;
+    *pos = p + segmentLen;
+    return true;
+}
+
+// Start of frame markers of the processes this decoder does not handle
+static bool is_unsupported_sof(uint8_t marker)
+{
+    return marker >= 0xC2 && marker <= 0xCF && marker != JPEG_DHT && marker != JPEG_JPG && marker != JPEG_DAC;
+}
+
+static esp_err_t parse_sof(const uint8_t *p, size_t len, JpegFrame_t *frame)
+{
+    if (len < 6)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (p[0] != 8)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    frame->height = ((uint16_t)p[1] << 8) | p[2];
+    frame->width = ((uint16_t)p[3] << 8) | p[4];
+    frame->count = p[5];
+    if (frame->width == 0 || frame->height == 0)
+    {
+        // A height defined later by a DNL segment is not supported
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (frame->count != 1 && frame->count != JPEG_MAX_COMPONENTS)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (len < 6 + 3 * (size_t)frame->count)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    frame->hmax = 1;
+    frame->vmax = 1;
+    for (int i = 0; i < frame->count; i++)
+    {
+        JpegComponent_t *comp = &frame->comps[i];
+        comp->id = p[6 + 3 * i];
+        comp->h = p[7 + 3 * i] >> 4;
+        comp->v = p[7 + 3 * i] & 0x0F;
+        comp->quant = p[8 + 3 * i];
+        if (comp->h == 0 || comp->v == 0 || comp->quant > 3)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (comp->h > JPEG_MAX_SAMPLING || comp->v > JPEG_MAX_SAMPLING)
+        {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        frame->hmax = comp->h > frame->hmax ? comp->h : frame->hmax;
+        frame->vmax = comp->v > frame->vmax ? comp->v : frame->vmax;
+    }
+
+    if (frame->count == 1)
+    {
+        // A single component scan is never interleaved, its MCU is one block
+        frame->comps[0].h = frame->comps[0].v = 1;
+        frame->hmax = frame->vmax = 1;
+    }
+    else if (frame->comps[0].h != frame->hmax || frame->comps[0].v != frame->vmax)
+    {
+        // Luma is expected to have the full resolution
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
+// Keep the first entry of each table, the only one DC coefficients use
+static esp_err_t parse_dqt(JpegDcDecoder_t *decoder, const uint8_t *p, size_t len)
+{
+    while (len > 0)
+    {
+        uint8_t precision = p[0] >> 4;
+        uint8_t id = p[0] & 0x0F;
+        size_t tableLen = 1 + (precision ? 128 : 64);
+        if (id > 3 || len < tableLen)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        decoder->quantDc[id] = precision ? (((uint16_t)p[1] << 8) | p[2]) : p[1];
+        p += tableLen;
+        len -= tableLen;
+    }
+
+    return ESP_OK;
+}
+
+static bool build_huffman(JpegDcHuffman_t *table, const uint8_t counts[16], const uint8_t *values, size_t total)
+{
+    table->defined = false;
+    memset(table->lookup, 0, sizeof(table->lookup));
+    memcpy(table->values, values, total);
+
+    int32_t code = 0;
+    int32_t index = 0;
+    for (int len = 1; len <= 16; len++)
+    {
+        table->valueOffset[len] = index - code;
+        for (int i = 0; i < counts[len - 1]; i++)
+        {
+            // More codes than the length allows, checked before the code indexes lookup
+            if (code >= (1 << len))
+            {
+                return false;
+            }
+            if (len <= JPEG_DC_LOOKUP_BITS)
+            {
+                // Every lookup index starting with this code maps to it
+                int shift = JPEG_DC_LOOKUP_BITS - len;
+                for (int fill = 0; fill < (1 << shift); fill++)
+                {
+                    table->lookup[(code << shift) | fill] = (uint16_t)((len << 8) | values[index]);
+                }
+            }
+            code++;
+            index++;
+        }
+        table->maxCode[len] = counts[len - 1] ? code - 1 : -1;
+        code <<= 1;
+    }
+    table->maxCode[17] = INT32_MAX;
+    table->defined = true;
+
+    return true;
+}
+
+static esp_err_t parse_dht(JpegDcDecoder_t *decoder, const uint8_t *p, size_t len)
+{
+    while (len > 0)
+    {
+        if (len < 17)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        uint8_t tableClass = p[0] >> 4;
+        uint8_t id = p[0] & 0x0F;
+        size_t total = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            total += p[1 + i];
+        }
+        if (tableClass > 1 || total > 256 || len < 17 + total)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (id > 1)
+        {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+
+        JpegDcHuffman_t *table = tableClass ? &decoder->ac[id] : &decoder->dc[id];
+        if (!build_huffman(table, p + 1, p + 17, total))
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        p += 17 + total;
+        len -= 17 + total;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t parse_sos(const JpegDcDecoder_t *decoder, const uint8_t *p, size_t len, JpegFrame_t *frame)
+{
+    if (frame->count == 0 || len < 1 || len < 1 + 2 * (size_t)p[0] + 3)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Every component must be in this scan, the frame is decoded in one pass
+    if (p[0] != frame->count)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    for (int i = 0; i < frame->count; i++)
+    {
+        JpegComponent_t *comp = NULL;
+        for (int j = 0; j < frame->count; j++)
+        {
+            if (frame->comps[j].id == p[1 + 2 * i])
+            {
+                comp = &frame->comps[j];
+            }
+        }
+        if (comp == NULL)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        comp->dcTable = p[2 + 2 * i] >> 4;
+        comp->acTable = p[2 + 2 * i] & 0x0F;
+        if (comp->dcTable > 1 || comp->acTable > 1 ||
+            !decoder->dc[comp->dcTable].defined || !decoder->ac[comp->acTable].defined)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        comp->pred = 0;
+    }
+
+    return ESP_OK;
+}
+
+static void fill_bits(JpegBits_t *bits)
+{
+    while (bits->count <= 24)
+    {
+        uint32_t byte = 0;
+        if (!bits->marker && bits->pos < bits->len)
+        {
+            byte = bits->data[bits->pos];
+            if (byte != 0xFF)
+            {
+                bits->pos++;
+            }
+            else if (bits->pos + 1 < bits->len && bits->data[bits->pos + 1] == 0x00)
+            {
+                // Stuffed zero after a 0xFF data byte
+                bits->pos += 2;
+            }
+            else
+            {
+                // Leave the marker in place for the restart handling
+                bits->marker = true;
+                byte = 0;
+            }
+        }
+        bits->bits |= byte << (24 - bits->count);
+        bits->count += 8;
+    }
+}
+
+static inline void drop_bits(JpegBits_t *bits, int n)
+{
+    bits->bits <<= n;
+    bits->count -= n;
+}
+
+static int decode_huffman(JpegBits_t *bits, const JpegDcHuffman_t *table)
+{
+    fill_bits(bits);
+
+    uint16_t entry = table->lookup[bits->bits >> (32 - JPEG_DC_LOOKUP_BITS)];
+    if (entry != 0)
+    {
+        drop_bits(bits, entry >> 8);
+        return entry & 0xFF;
+    }
+
+    // Longer codes, fill_bits() left at least 16 bits in the buffer
+    uint32_t peek = bits->bits >> 16;
+    for (int len = JPEG_DC_LOOKUP_BITS + 1; len <= 16; len++)
+    {
+        int32_t code = (int32_t)(peek >> (16 - len));
+        if (code <= table->maxCode[len])
+        {
+            drop_bits(bits, len);
+            return table->values[code + table->valueOffset[len]];
+        }
+    }
+
+    return -1;
+}
+
+// Read a size bit magnitude and extend its sign
+static int32_t receive_extend(JpegBits_t *bits, int size)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    fill_bits(bits);
+    int32_t value = (int32_t)(bits->bits >> (32 - size));
+    drop_bits(bits, size);
+
+    return value < (1 << (size - 1)) ? value - (1 << size) + 1 : value;
+}
+
+// Decode one block, keeping its DC coefficient and only skipping the AC ones
+static bool decode_block(JpegBits_t *bits, const JpegDcDecoder_t *decoder, JpegComponent_t *comp, int32_t *dc)
+{
+    int size = decode_huffman(bits, &decoder->dc[comp->dcTable]);
+    if (size < 0 || size > 11)
+    {
+        return false;
+    }
+    comp->pred += receive_extend(bits, size);
+    *dc = comp->pred * decoder->quantDc[comp->quant];
+
+    const JpegDcHuffman_t *ac = &decoder->ac[comp->acTable];
+    for (int k = 1; k < 64; k++)
+    {
+        int symbol = decode_huffman(bits, ac);
+        if (symbol < 0)
+        {
+            return false;
+        }
+
+        int run = symbol >> 4;
+        size = symbol & 0x0F;
+        if (size == 0)
+        {
+            if (run != 15)
+            {
+                break; // End of block
+            }
+            k += 15;
+        }
+        else
+        {
+            k += run;
+            fill_bits(bits);
+            drop_bits(bits, size);
+        }
+    }
+
+    return true;
+}
+
+// Skip to the RSTn marker that ends a restart interval and reset the predictors
+static bool restart(JpegBits_t *bits, JpegFrame_t *frame)
+{
+    size_t pos = bits->pos;
+    while (pos + 1 < bits->len && !(bits->data[pos] == 0xFF &&
+           bits->data[pos + 1] >= JPEG_RST0 && bits->data[pos + 1] <= JPEG_RST7))
+    {
+        pos++;
+    }
+    if (pos + 1 >= bits->len)
+    {
+        return false;
+    }
+
+    bits->pos = pos + 2;
+    bits->bits = 0;
+    bits->count = 0;
+    bits->marker = false;
+    for (int i = 0; i < frame->count; i++)
+    {
+        frame->comps[i].pred = 0;
+    }
+
+    return true;
+}
+
+// Mean of a block from its dequantized DC coefficient, which is 8 times the mean minus 128
+static inline uint8_t dc_to_pixel(int32_t dc)
+{
+    int32_t value = dc + 1024 + 4;
+    if (value < 0)
+    {
+        return 0;
+    }
+    value >>= 3;
+    return value > 255 ? 255 : (uint8_t)value;
+}
+
+// Distance of a block from gray, from the dequantized DC coefficients of its chroma
+static inline uint8_t dc_to_saturation(int32_t cb, int32_t cr)
+{
+    cb = cb < 0 ? -cb : cb;
+    cr = cr < 0 ? -cr : cr;
+    int32_t value = ((cb > cr ? cb : cr) + 4) >> 3;
+    return value > 128 ? 128 : (uint8_t)value;
+}
+
+static esp_err_t decode_scan(const JpegDcDecoder_t *decoder, JpegFrame_t *frame, JpegBits_t *bits, JpegDcImage_t *image)
+{
+    uint16_t width = image->width;
+    uint16_t height = image->height;
+    int mcuCols = (frame->width + 8 * frame->hmax - 1) / (8 * frame->hmax);
+    int mcuRows = (frame->height + 8 * frame->vmax - 1) / (8 * frame->vmax);
+    JpegComponent_t *luma = &frame->comps[0];
+
+    // Dequantized chroma DC of the current MCU, per component and block
+    int32_t chroma[JPEG_MAX_COMPONENTS - 1][JPEG_MAX_SAMPLING * JPEG_MAX_SAMPLING];
+    uint32_t mcu = 0;
+
+    for (int mcuY = 0; mcuY < mcuRows; mcuY++)
+    {
+        for (int mcuX = 0; mcuX < mcuCols; mcuX++, mcu++)
+        {
+            if (frame->restartInterval != 0 && mcu != 0 && mcu % frame->restartInterval == 0 &&
+                !restart(bits, frame))
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+
+            for (int c = 0; c < frame->count; c++)
+            {
+                JpegComponent_t *comp = &frame->comps[c];
+                for (int v = 0; v < comp->v; v++)
+                {
+                    for (int h = 0; h < comp->h; h++)
+                    {
+                        int32_t dc;
+                        if (!decode_block(bits, decoder, comp, &dc))
+                        {
+                            return ESP_ERR_INVALID_ARG;
+                        }
+
+                        if (c == 0)
+                        {
+                            // Blocks padding the frame to whole MCUs are dropped
+                            int x = mcuX * comp->h + h;
+                            int y = mcuY * comp->v + v;
+                            if (x < width && y < height)
+                            {
+                                image->luma[y * width + x] = dc_to_pixel(dc);
+                            }
+                        }
+                        else
+                        {
+                            chroma[c - 1][v * JPEG_MAX_SAMPLING + h] = dc;
+                        }
+                    }
+                }
+            }
+
+            if (image->saturation == NULL || frame->count == 1)
+            {
+                continue;
+            }
+
+            // Each luma block takes the chroma block covering it
+            const JpegComponent_t *cb = &frame->comps[1];
+            const JpegComponent_t *cr = &frame->comps[2];
+            for (int v = 0; v < luma->v; v++)
+            {
+                for (int h = 0; h < luma->h; h++)
+                {
+                    int x = mcuX * luma->h + h;
+                    int y = mcuY * luma->v + v;
+                    if (x < width && y < height)
+                    {
+                        int32_t cbDc = chroma[0][(v * cb->v / luma->v) * JPEG_MAX_SAMPLING + h * cb->h / luma->h];
+                        int32_t crDc = chroma[1][(v * cr->v / luma->v) * JPEG_MAX_SAMPLING + h * cr->h / luma->h];
+                        image->saturation[y * width + x] = dc_to_saturation(cbDc, crDc);
+                    }
+                }
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t jpeg_dc_get_size(const uint8_t *jpg, size_t len, uint16_t *width, uint16_t *height)
+{
+    if (len < 2 || jpg[0] != 0xFF || jpg[1] != JPEG_SOI)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t pos = 2;
+    uint8_t marker;
+    const uint8_t *payload;
+    size_t payloadLen;
+    while (next_segment(jpg, len, &pos, &marker, &payload, &payloadLen) && marker != JPEG_SOS)
+    {
+        if ((marker == JPEG_SOF0 || marker == JPEG_SOF1 || is_unsupported_sof(marker)) && payloadLen >= 5)
+        {
+            *height = (((uint16_t)payload[1] << 8 | payload[2]) + 7) / 8;
+            *width = (((uint16_t)payload[3] << 8 | payload[4]) + 7) / 8;
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t jpeg_dc_decode(JpegDcDecoder_t *decoder, const uint8_t *jpg, size_t len, JpegDcImage_t *image)
+{
+    if (decoder == NULL || jpg == NULL || image == NULL || image->luma == NULL ||
+        len < 2 || jpg[0] != 0xFF || jpg[1] != JPEG_SOI)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(decoder, 0, sizeof(*decoder));
+    JpegFrame_t frame = {0};
+
+    size_t pos = 2;
+    uint8_t marker;
+    const uint8_t *payload;
+    size_t payloadLen;
+    while (next_segment(jpg, len, &pos, &marker, &payload, &payloadLen))
+    {
+        esp_err_t err = ESP_OK;
+
+        if (marker == JPEG_SOF0 || marker == JPEG_SOF1)
+        {
+            err = parse_sof(payload, payloadLen, &frame);
+        }
+        else if (is_unsupported_sof(marker))
+        {
+            err = ESP_ERR_NOT_SUPPORTED;
+        }
+        else if (marker == JPEG_DQT)
+        {
+            err = parse_dqt(decoder, payload, payloadLen);
+        }
+        else if (marker == JPEG_DHT)
+        {
+            err = parse_dht(decoder, payload, payloadLen);
+        }
+        else if (marker == JPEG_DRI && payloadLen >= 2)
+        {
+            frame.restartInterval = ((uint16_t)payload[0] << 8) | payload[1];
+        }
+        else if (marker == JPEG_EOI)
+        {
+            break;
+        }
+        else if (marker == JPEG_SOS)
+        {
+            err = parse_sos(decoder, payload, payloadLen, &frame);
+            if (err != ESP_OK)
+            {
+                return err;
+            }
+
+            image->width = (frame.width + 7) / 8;
+            image->height = (frame.height + 7) / 8;
+            size_t pixels = (size_t)image->width * image->height;
+            if (pixels > image->capacity)
+            {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            if (image->saturation != NULL && frame.count == 1)
+            {
+                memset(image->saturation, 0, pixels);
+            }
+
+            JpegBits_t bits = {.data = jpg, .len = len, .pos = pos};
+            return decode_scan(decoder, &frame, &bits, image);
+        }
+
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+
+    return ESP_ERR_INVALID_ARG;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * @file        jpeg_dc.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       1/8 scale decoding of baseline JPEG frames from their DC coefficients.
+ *              The DC coefficient of an 8x8 block is the mean of its pixels, so
+ *              Huffman decoding only the DC values, and skipping the AC ones
+ *              without dequantizing or transforming them, gives one pixel per
+ *              block: an 80x60 luma image for a VGA frame, in a few milliseconds.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef JPEG_DC_H
+#define JPEG_DC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_err.h"
+
+// Huffman codes up to this length are decoded with a single table lookup
+#define JPEG_DC_LOOKUP_BITS 8
+
+/**
+ * @brief Huffman table, in the canonical form of the DHT segment.
+ */
+typedef struct
+{
+    uint16_t lookup[1 << JPEG_DC_LOOKUP_BITS]; /*< Code length << 8 | symbol, 0 for longer codes */
+    int32_t maxCode[18];                       /*< Largest code of each length, -1 if none       */
+    int32_t valueOffset[17];                   /*< Index in values minus code, per length        */
+    uint8_t values[256];                       /*< Symbols sorted by code                        */
+    bool defined;
+} JpegDcHuffman_t;
+
+/**
+ * @brief Working state of the decoder, about 3.5 KB.
+ * Owned by the caller so that a decode neither allocates nor needs a large stack.
+ * One context must not be used by two decodes at the same time.
+ */
+typedef struct
+{
+    JpegDcHuffman_t dc[2];
+    JpegDcHuffman_t ac[2];
+    uint16_t quantDc[4];        /*< First entry of each quantization table */
+} JpegDcDecoder_t;
+
+/**
+ * @brief Image produced by jpeg_dc_decode(), one pixel per 8x8 block of the frame.
+ */
+typedef struct
+{
+    uint8_t *luma;              /*< Mean luma of each block, row major, required         */
+    uint8_t *saturation;        /*< Chroma distance from gray (0-128), NULL to skip it   */
+    size_t capacity;            /*< Size of each of the buffers above                    */
+    uint16_t width;             /*< Out: frame width / 8, rounded up                     */
+    uint16_t height;            /*< Out: frame height / 8, rounded up                    */
+} JpegDcImage_t;
+
+/**
+ * @brief Reads the size of the 1/8 scale image of a JPEG frame without decoding it.
+ *
+ * @param jpg    JPEG data.
+ * @param len    Length of the JPEG data.
+ * @param width  Out: frame width / 8, rounded up.
+ * @param height Out: frame height / 8, rounded up.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if no frame header is found.
+ */
+esp_err_t jpeg_dc_get_size(const uint8_t *jpg, size_t len, uint16_t *width, uint16_t *height);
+
+/**
+ * @brief Decodes a JPEG frame at 1/8 scale from its DC coefficients.
+ * Supports baseline frames with one (gray) or three (YCbCr) components in one
+ * interleaved scan, any sampling factors up to 2x2 and restart markers.
+ *
+ * @param decoder Working state, see JpegDcDecoder_t.
+ * @param jpg     JPEG data.
+ * @param len     Length of the JPEG data.
+ * @param image   Destination buffers, width and height are set on success.
+ * @return ESP_OK on success,
+ *         ESP_ERR_INVALID_SIZE if the image does not fit in the buffers,
+ *         ESP_ERR_NOT_SUPPORTED for progressive, 12 bit or multi scan frames,
+ *         ESP_ERR_INVALID_ARG if the data is not a valid JPEG stream.
+ */
+esp_err_t jpeg_dc_decode(JpegDcDecoder_t *decoder, const uint8_t *jpg, size_t len, JpegDcImage_t *image);
+
+#endif  // JPEG_DC_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * @file        json_writer.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../json_writer/json_writer.h"
+
+// Append raw characters, flags the writer on overflow
+static void put(JsonWriter_t *writer, const char *str, size_t len)
+{
+    if (writer->overflow || writer->len + len >= writer->size)
+    {
+        writer->overflow = true;
+        return;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        writer->buf[writer->len++] = str[i];
+    }
+}
+
+static void put_char(JsonWriter_t *writer, char c)
+{
+    put(writer, &c, 1);
+}
+
+// Append a quoted and escaped string
+static void put_string(JsonWriter_t *writer, const char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    put_char(writer, '"');
+    for (; *str != '\0'; str++)
+    {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\')
+        {
+            char escaped[2] = {'\\', (char)c};
+            put(writer, escaped, 2);
+        }
+        else if (c < 0x20)
+        {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            put(writer, escaped, 6);
+        }
+        else
+        {
+            put_char(writer, (char)c);
+        }
+    }
+    put_char(writer, '"');
+}
+
+// Separator and member name that precede every value
+static void put_key(JsonWriter_t *writer, const char *key)
+{
+    if (!writer->first)
+    {
+        put_char(writer, ',');
+    }
+    writer->first = false;
+
+    if (key != NULL)
+    {
+        put_string(writer, key);
+        put_char(writer, ':');
+    }
+}
+
+void json_writer_init(JsonWriter_t *writer, char *buf, size_t size)
+{
+    writer->buf = buf;
+    writer->size = size;
+    writer->len = 0;
+    writer->first = true;
+    writer->overflow = (buf == NULL || size == 0);
+}
+
+void json_writer_begin_object(JsonWriter_t *writer, const char *key)
+{
+    put_key(writer, key);
+    put_char(writer, '{');
+    writer->first = true;
+}
+
+void json_writer_end_object(JsonWriter_t *writer)
+{
+    put_char(writer, '}');
+    writer->first = false;
+}
+
+void json_writer_begin_array(JsonWriter_t *writer, const char *key)
+{
+    put_key(writer, key);
+    put_char(writer, '[');
+    writer->first = true;
+}
+
+void json_writer_end_array(JsonWriter_t *writer)
+{
+    put_char(writer, ']');
+    writer->first = false;
+}
+
+void json_writer_add_uint(JsonWriter_t *writer, const char *key, uint64_t value)
+{
+    char digits[21];
+    size_t pos = sizeof(digits);
+
+    // Convert from the last digit, 64 bit printf support is not guaranteed
+    do
+    {
+        digits[--pos] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    put_key(writer, key);
+    put(writer, digits + pos, sizeof(digits) - pos);
+}
+
+void json_writer_add_int(JsonWriter_t *writer, const char *key, int32_t value)
+{
+    char number[12];
+    int len = snprintf(number, sizeof(number), "%ld", (long)value);
+
+    put_key(writer, key);
+    put(writer, number, len);
+}
+
+void json_writer_add_bool(JsonWriter_t *writer, const char *key, bool value)
+{
+    put_key(writer, key);
+    if (value)
+    {
+        put(writer, "true", 4);
+    }
+    else
+    {
+        put(writer, "false", 5);
+    }
+}
+
+void json_writer_add_float(JsonWriter_t *writer, const char *key, float value, uint8_t decimals)
+{
+    static const uint32_t scales[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+    if (decimals > 6)
+    {
+        decimals = 6;
+    }
+
+    bool negative = value < 0.0f;
+    uint64_t scaled = (uint64_t)((negative ? -value : value) * scales[decimals] + 0.5f);
+    uint64_t integer = scaled / scales[decimals];
+    uint32_t fraction = scaled % scales[decimals];
+
+    char number[32];
+    int len;
+    if (decimals > 0)
+    {
+        len = snprintf(number, sizeof(number), "%s%lu.%0*lu", negative && scaled != 0 ? "-" : "",
+                       (unsigned long)integer, decimals, (unsigned long)fraction);
+    }
+    else
+    {
+        len = snprintf(number, sizeof(number), "%s%lu", negative && scaled != 0 ? "-" : "",
+                       (unsigned long)integer);
+    }
+
+    put_key(writer, key);
+    put(writer, number, len);
+}
+
+void json_writer_add_string(JsonWriter_t *writer, const char *key, const char *value)
+{
+    put_key(writer, key);
+    put_string(writer, value);
+}
+
+size_t json_writer_finish(JsonWriter_t *writer)
+{
+    if (writer->overflow)
+    {
+        if (writer->size > 0)
+        {
+            writer->buf[0] = '\0';
+        }
+        return 0;
+    }
+    writer->buf[writer->len] = '\0';
+    return writer->len;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
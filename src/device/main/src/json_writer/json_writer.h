@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * @file        json_writer.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Minimal JSON writer into a caller provided buffer.
+ *              Meant for small replies built on the stack, it never allocates.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @brief State of a document being written.
+ */
+typedef struct
+{
+    char *buf;        /*< Destination buffer                                  */
+    size_t size;      /*< Size of buf                                         */
+    size_t len;       /*< Characters written so far                           */
+    bool first;       /*< The next member is the first of its object          */
+    bool overflow;    /*< The document did not fit, the output is unusable    */
+} JsonWriter_t;
+
+/**
+ * @brief Starts a document in buf.
+ */
+void json_writer_init(JsonWriter_t *writer, char *buf, size_t size);
+
+/**
+ * @brief Opens an object.
+ *
+ * @param key Member name, NULL for an array element or the root.
+ */
+void json_writer_begin_object(JsonWriter_t *writer, const char *key);
+
+/**
+ * @brief Closes the innermost open object.
+ */
+void json_writer_end_object(JsonWriter_t *writer);
+
+/**
+ * @brief Opens an array.
+ *
+ * @param key Member name, NULL for an array element or the root.
+ */
+void json_writer_begin_array(JsonWriter_t *writer, const char *key);
+
+/**
+ * @brief Closes the innermost open array.
+ */
+void json_writer_end_array(JsonWriter_t *writer);
+
+// Add a number or boolean member, key is NULL inside arrays
+void json_writer_add_uint(JsonWriter_t *writer, const char *key, uint64_t value);
+void json_writer_add_int(JsonWriter_t *writer, const char *key, int32_t value);
+void json_writer_add_bool(JsonWriter_t *writer, const char *key, bool value);
+
+/**
+ * @brief Adds a number with a fixed number of decimals.
+ * Formatted with integer arithmetic, printf's float conversion may allocate.
+ *
+ * @param decimals Digits after the decimal point, 0 to 6.
+ */
+void json_writer_add_float(JsonWriter_t *writer, const char *key, float value, uint8_t decimals);
+
+/**
+ * @brief Adds a string member, escaping quotes, backslashes and control characters.
+ */
+void json_writer_add_string(JsonWriter_t *writer, const char *key, const char *value);
+
+/**
+ * @brief Terminates the document.
+ *
+ * @return Length of the document, or 0 if it did not fit in the buffer.
+ */
+size_t json_writer_finish(JsonWriter_t *writer);
+
+#endif  // JSON_WRITER_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,699 @@
+/*******************************************************************************
+ * @file        log_codec.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../log_codec/log_codec.h"
+#include <stdatomic.h>
+#include "log_catalog.h"
+
+// Entries of the caches from a format or tag pointer to its id
+#define LOG_CODEC_FORMAT_CACHE_SIZE 64
+#define LOG_CODEC_TAG_CACHE_SIZE 16
+
+// A cache entry packs the id in the low bits and the pointer bits above the index in the rest
+#define LOG_CODEC_CACHE_ID_BITS 10
+#define LOG_CODEC_CACHE_ID_MASK ((1u << LOG_CODEC_CACHE_ID_BITS) - 1)
+
+_Static_assert(LOG_CATALOG_FORMAT_COUNT + 1 < LOG_CODEC_CACHE_ID_MASK, "Too many log formats for the cache");
+_Static_assert(LOG_CATALOG_TAG_COUNT < 255, "Too many log tags");
+
+/**
+ * @brief Length modifier of a conversion.
+ */
+typedef enum
+{
+    LOG_LENGTH_NONE,
+    LOG_LENGTH_HH,
+    LOG_LENGTH_H,
+    LOG_LENGTH_L,
+    LOG_LENGTH_LL,
+    LOG_LENGTH_J,
+    LOG_LENGTH_Z,
+    LOG_LENGTH_T,
+    LOG_LENGTH_LONG_DOUBLE
+} LogLength_t;
+
+/**
+ * @brief One printf conversion.
+ */
+typedef struct
+{
+    const char *flags;      /*< First flag character, right after '%'         */
+    uint8_t flagCount;      /*< Number of flag characters                     */
+    int width;              /*< Field width, -1 when absent                   */
+    int precision;          /*< Precision, -1 when absent                     */
+    bool widthStar;         /*< The width is taken from an argument           */
+    bool precisionStar;     /*< The precision is taken from an argument       */
+    LogLength_t length;     /*< Length modifier                               */
+    char conversion;        /*< Conversion character                          */
+} LogSpec_t;
+
+/**
+ * @brief Hash of a catalog format, sorted for a binary search.
+ */
+typedef struct
+{
+    uint32_t hash;
+    uint16_t id;
+} LogFormatIndex_t;
+
+static LogFormatIndex_t formatIndex[LOG_CATALOG_FORMAT_COUNT];
+
+static atomic_uint_least32_t formatCache[LOG_CODEC_FORMAT_CACHE_SIZE];
+static atomic_uint_least32_t tagCache[LOG_CODEC_TAG_CACHE_SIZE];
+
+// FNV-1a of len bytes
+static uint32_t hash_bytes(const char *s, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (uint8_t)s[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static int compare_index(const void *a, const void *b)
+{
+    uint32_t ha = ((const LogFormatIndex_t *)a)->hash;
+    uint32_t hb = ((const LogFormatIndex_t *)b)->hash;
+    return ha < hb ? -1 : ha > hb;
+}
+
+void init_log_codec(void)
+{
+    for (uint16_t i = 0; i < LOG_CATALOG_FORMAT_COUNT; i++)
+    {
+        formatIndex[i].hash = hash_bytes(log_catalog_formats[i], strlen(log_catalog_formats[i]));
+        formatIndex[i].id = i;
+    }
+    qsort(formatIndex, LOG_CATALOG_FORMAT_COUNT, sizeof(formatIndex[0]), compare_index);
+}
+
+// Id cached for a pointer, -1 on a miss
+static int cache_lookup(atomic_uint_least32_t *cache, size_t size, const void *key)
+{
+    uintptr_t address = (uintptr_t)key;
+    uint32_t tag = (uint32_t)(address / size) << LOG_CODEC_CACHE_ID_BITS;
+    uint32_t entry = atomic_load_explicit(&cache[address & (size - 1)], memory_order_relaxed);
+
+    // The id is stored plus one so that an empty entry never matches
+    if ((entry & LOG_CODEC_CACHE_ID_MASK) == 0 || (entry & ~LOG_CODEC_CACHE_ID_MASK) != tag)
+    {
+        return -1;
+    }
+    return (int)(entry & LOG_CODEC_CACHE_ID_MASK) - 1;
+}
+
+static void cache_store(atomic_uint_least32_t *cache, size_t size, const void *key, int id)
+{
+    uintptr_t address = (uintptr_t)key;
+    uint32_t tag = (uint32_t)(address / size) << LOG_CODEC_CACHE_ID_BITS;
+    atomic_store_explicit(&cache[address & (size - 1)], tag | (uint32_t)(id + 1), memory_order_relaxed);
+}
+
+// Catalog id of a format, LOG_CATALOG_FORMAT_COUNT when it is not in the catalog
+static int find_format(const char *fmt, const char *user, size_t len)
+{
+    int id = cache_lookup(formatCache, LOG_CODEC_FORMAT_CACHE_SIZE, fmt);
+    if (id >= 0)
+    {
+        return id;
+    }
+
+    id = LOG_CATALOG_FORMAT_COUNT;
+    uint32_t hash = hash_bytes(user, len);
+    size_t low = 0;
+    size_t high = LOG_CATALOG_FORMAT_COUNT;
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        if (formatIndex[mid].hash < hash)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    for (; low < LOG_CATALOG_FORMAT_COUNT && formatIndex[low].hash == hash; low++)
+    {
+        const char *candidate = log_catalog_formats[formatIndex[low].id];
+        if (strncmp(candidate, user, len) == 0 && candidate[len] == '\0')
+        {
+            id = formatIndex[low].id;
+            break;
+        }
+    }
+
+    cache_store(formatCache, LOG_CODEC_FORMAT_CACHE_SIZE, fmt, id);
+    return id;
+}
+
+// Catalog id of a tag, LOG_CATALOG_TAG_COUNT when it is not in the catalog
+static int find_tag(const char *tag)
+{
+    int id = cache_lookup(tagCache, LOG_CODEC_TAG_CACHE_SIZE, tag);
+    if (id >= 0)
+    {
+        return id;
+    }
+
+    for (id = 0; id < LOG_CATALOG_TAG_COUNT; id++)
+    {
+        if (strcmp(log_catalog_tags[id], tag) == 0)
+        {
+            break;
+        }
+    }
+
+    cache_store(tagCache, LOG_CODEC_TAG_CACHE_SIZE, tag, id);
+    return id;
+}
+
+// Parse the conversion following a '%', returns the character after it or NULL
+static const char *parse_spec(const char *p, LogSpec_t *spec)
+{
+    spec->flags = p;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+    {
+        p++;
+    }
+    spec->flagCount = (uint8_t)(p - spec->flags);
+
+    spec->width = -1;
+    spec->widthStar = false;
+    if (*p == '*')
+    {
+        spec->widthStar = true;
+        p++;
+    }
+    else if (*p >= '0' && *p <= '9')
+    {
+        spec->width = (int)strtol(p, (char **)&p, 10);
+    }
+
+    spec->precision = -1;
+    spec->precisionStar = false;
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            spec->precisionStar = true;
+            p++;
+        }
+        else
+        {
+            spec->precision = (int)strtol(p, (char **)&p, 10);
+        }
+    }
+
+    spec->length = LOG_LENGTH_NONE;
+    switch (*p)
+    {
+        case 'h':
+            p++;
+            spec->length = LOG_LENGTH_H;
+            if (*p == 'h')
+            {
+                p++;
+                spec->length = LOG_LENGTH_HH;
+            }
+            break;
+        case 'l':
+            p++;
+            spec->length = LOG_LENGTH_L;
+            if (*p == 'l')
+            {
+                p++;
+                spec->length = LOG_LENGTH_LL;
+            }
+            break;
+        case 'j': p++; spec->length = LOG_LENGTH_J; break;
+        case 'z': p++; spec->length = LOG_LENGTH_Z; break;
+        case 't': p++; spec->length = LOG_LENGTH_T; break;
+        case 'L': p++; spec->length = LOG_LENGTH_LONG_DOUBLE; break;
+        default: break;
+    }
+
+    spec->conversion = *p;
+    return *p != '\0' ? p + 1 : NULL;
+}
+
+static bool put_byte(uint8_t *out, size_t *pos, size_t max, uint8_t byte)
+{
+    if (*pos >= max)
+    {
+        return false;
+    }
+    out[(*pos)++] = byte;
+    return true;
+}
+
+static bool put_varint(uint8_t *out, size_t *pos, size_t max, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        if (!put_byte(out, pos, max, (uint8_t)(value | 0x80)))
+        {
+            return false;
+        }
+        value >>= 7;
+    }
+    return put_byte(out, pos, max, (uint8_t)value);
+}
+
+static bool put_signed(uint8_t *out, size_t *pos, size_t max, int64_t value)
+{
+    // Zigzag, small negative numbers stay short
+    return put_varint(out, pos, max, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static int64_t read_signed_arg(LogLength_t length, va_list *args)
+{
+    switch (length)
+    {
+        case LOG_LENGTH_L: return va_arg(*args, long);
+        case LOG_LENGTH_LL: return va_arg(*args, long long);
+        case LOG_LENGTH_J: return va_arg(*args, intmax_t);
+        case LOG_LENGTH_Z: return (int64_t)va_arg(*args, size_t);
+        case LOG_LENGTH_T: return va_arg(*args, ptrdiff_t);
+        default: return va_arg(*args, int);
+    }
+}
+
+static uint64_t read_unsigned_arg(LogLength_t length, va_list *args)
+{
+    switch (length)
+    {
+        case LOG_LENGTH_L: return va_arg(*args, unsigned long);
+        case LOG_LENGTH_LL: return va_arg(*args, unsigned long long);
+        case LOG_LENGTH_J: return va_arg(*args, uintmax_t);
+        case LOG_LENGTH_Z: return va_arg(*args, size_t);
+        case LOG_LENGTH_T: return (uint64_t)va_arg(*args, ptrdiff_t);
+        default: return va_arg(*args, unsigned int);
+    }
+}
+
+// Copy the arguments of one conversion into the record
+static bool encode_arg(const LogSpec_t *spec, va_list *args, uint8_t *out, size_t *pos, size_t max)
+{
+    if (spec->widthStar && !put_signed(out, pos, max, va_arg(*args, int)))
+    {
+        return false;
+    }
+    if (spec->precisionStar && !put_signed(out, pos, max, va_arg(*args, int)))
+    {
+        return false;
+    }
+
+    switch (spec->conversion)
+    {
+        case 'd':
+        case 'i':
+            return put_signed(out, pos, max, read_signed_arg(spec->length, args));
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            return put_varint(out, pos, max, read_unsigned_arg(spec->length, args));
+        case 'c':
+            return put_varint(out, pos, max, (uint8_t)va_arg(*args, int));
+        case 'p':
+            return put_varint(out, pos, max, (uintptr_t)va_arg(*args, void *));
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        {
+            if (spec->length == LOG_LENGTH_LONG_DOUBLE)
+            {
+                return false;
+            }
+            double value = va_arg(*args, double);
+            if (*pos + sizeof(value) > max)
+            {
+                return false;
+            }
+            memcpy(&out[*pos], &value, sizeof(value));
+            *pos += sizeof(value);
+            return true;
+        }
+        case 's':
+        {
+            if (spec->length != LOG_LENGTH_NONE)
+            {
+                return false;
+            }
+            const char *value = va_arg(*args, const char *);
+            if (value == NULL)
+            {
+                value = "(null)";
+            }
+            // Strings are cut to the room left in the record
+            size_t len = strlen(value);
+            size_t room = max > *pos + 1 ? max - *pos - 1 : 0;
+            if (len > room)
+            {
+                len = room;
+            }
+            if (len > UINT8_MAX)
+            {
+                len = UINT8_MAX;
+            }
+            if (!put_byte(out, pos, max, (uint8_t)len))
+            {
+                return false;
+            }
+            memcpy(&out[*pos], value, len);
+            *pos += len;
+            return true;
+        }
+        case '%':
+            return true;
+        default:
+            // %n and unknown conversions
+            return false;
+    }
+}
+
+size_t log_codec_encode(uint8_t *out, size_t max, const char *fmt, va_list args)
+{
+    va_list ap;
+    va_copy(ap, args);
+    size_t result = 0;
+
+    if (max > LOG_CODEC_RECORD_MAX)
+    {
+        max = LOG_CODEC_RECORD_MAX;
+    }
+
+    // ESP_LOGx() formats are [color] "L (%<timestamp>) %s: " <format> [reset color] "\n"
+    const char *p = fmt;
+    if (*p == '\033')
+    {
+        p = strchr(p, 'm');
+        if (p == NULL)
+        {
+            goto done;
+        }
+        p++;
+    }
+
+    char level = *p++;
+    if (strchr("EWIDV", level) == NULL || level == '\0' || strncmp(p, " (%", 3) != 0)
+    {
+        goto done;
+    }
+
+    LogSpec_t timestampSpec;
+    p = parse_spec(p + 3, &timestampSpec);
+    if (p == NULL || (timestampSpec.conversion != 'u' && timestampSpec.conversion != 'd') ||
+        strncmp(p, ") %s: ", 6) != 0)
+    {
+        goto done;
+    }
+
+    const char *user = p + 6;
+    size_t userLen = strlen(user);
+    if (userLen == 0 || user[userLen - 1] != '\n')
+    {
+        goto done;
+    }
+    userLen--;
+    if (userLen >= 4 && memcmp(&user[userLen - 4], "\033[0m", 4) == 0)
+    {
+        userLen -= 4;
+    }
+
+    int formatId = find_format(fmt, user, userLen);
+    if (formatId >= LOG_CATALOG_FORMAT_COUNT)
+    {
+        goto done;
+    }
+
+    uint64_t timestamp = read_unsigned_arg(timestampSpec.length, &ap);
+    int tagId = find_tag(va_arg(ap, const char *));
+    if (tagId >= LOG_CATALOG_TAG_COUNT)
+    {
+        goto done;
+    }
+
+    size_t pos = LOG_CODEC_HEADER_SIZE;
+    if (!put_byte(out, &pos, max, (uint8_t)level) ||
+        !put_byte(out, &pos, max, (uint8_t)tagId) ||
+        !put_byte(out, &pos, max, (uint8_t)formatId) ||
+        !put_byte(out, &pos, max, (uint8_t)(formatId >> 8)) ||
+        !put_varint(out, &pos, max, timestamp))
+    {
+        goto done;
+    }
+
+    // Walk the catalog copy of the format, it ends where the user part does
+    for (const char *f = log_catalog_formats[formatId]; *f != '\0'; f++)
+    {
+        if (*f != '%')
+        {
+            continue;
+        }
+        LogSpec_t spec;
+        f = parse_spec(f + 1, &spec);
+        if (f == NULL || !encode_arg(&spec, &ap, out, &pos, max))
+        {
+            goto done;
+        }
+        f--;
+    }
+
+    out[0] = LOG_CODEC_MARKER;
+    out[1] = (uint8_t)(pos - LOG_CODEC_HEADER_SIZE);
+    result = pos;
+
+done:
+    va_end(ap);
+    return result;
+}
+
+static bool get_varint(const uint8_t *in, size_t *pos, size_t len, uint64_t *value)
+{
+    *value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (*pos >= len)
+        {
+            return false;
+        }
+        uint8_t byte = in[(*pos)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool get_signed(const uint8_t *in, size_t *pos, size_t len, int64_t *value)
+{
+    uint64_t raw;
+    if (!get_varint(in, pos, len, &raw))
+    {
+        return false;
+    }
+    *value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+    return true;
+}
+
+// Append to out like snprintf, keeping it NUL terminated when it is full
+static void append(char *out, size_t max, size_t *used, const char *fmt, ...)
+{
+    if (*used + 1 >= max)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(&out[*used], max - *used, fmt, args);
+    va_end(args);
+    if (n > 0)
+    {
+        *used += (size_t)n < max - *used ? (size_t)n : max - *used - 1;
+    }
+}
+
+// Format one conversion from the record arguments
+static bool decode_arg(const LogSpec_t *spec, const uint8_t *in, size_t *pos, size_t len,
+                       char *out, size_t max, size_t *used)
+{
+    int64_t width = spec->width;
+    int64_t precision = spec->precision;
+    if (spec->widthStar && !get_signed(in, pos, len, &width))
+    {
+        return false;
+    }
+    if (spec->precisionStar && !get_signed(in, pos, len, &precision))
+    {
+        return false;
+    }
+
+    // Rebuild the conversion with its arguments resolved
+    char conversion[32];
+    int n = snprintf(conversion, sizeof(conversion), "%%%.*s", spec->flagCount, spec->flags);
+    if (width >= 0)
+    {
+        n += snprintf(&conversion[n], sizeof(conversion) - n, "%d", (int)width);
+    }
+    if (precision >= 0)
+    {
+        n += snprintf(&conversion[n], sizeof(conversion) - n, ".%d", (int)precision);
+    }
+
+    switch (spec->conversion)
+    {
+        case 'd':
+        case 'i':
+        {
+            int64_t value;
+            if (!get_signed(in, pos, len, &value))
+            {
+                return false;
+            }
+            snprintf(&conversion[n], sizeof(conversion) - n, "ll%c", spec->conversion);
+            append(out, max, used, conversion, (long long)value);
+            return true;
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+        case 'p':
+        {
+            uint64_t value;
+            if (!get_varint(in, pos, len, &value))
+            {
+                return false;
+            }
+            if (spec->conversion == 'c')
+            {
+                snprintf(&conversion[n], sizeof(conversion) - n, "c");
+                append(out, max, used, conversion, (int)value);
+            }
+            else if (spec->conversion == 'p')
+            {
+                // Device pointers mean nothing on the host, print the address
+                snprintf(&conversion[n], sizeof(conversion) - n, "llx");
+                append(out, max, used, "0x");
+                append(out, max, used, conversion, (unsigned long long)value);
+            }
+            else
+            {
+                snprintf(&conversion[n], sizeof(conversion) - n, "ll%c", spec->conversion);
+                append(out, max, used, conversion, (unsigned long long)value);
+            }
+            return true;
+        }
+        case 's':
+        {
+            if (*pos >= len || *pos + 1 + in[*pos] > len)
+            {
+                return false;
+            }
+            char value[UINT8_MAX + 1];
+            uint8_t valueLen = in[(*pos)++];
+            memcpy(value, &in[*pos], valueLen);
+            value[valueLen] = '\0';
+            *pos += valueLen;
+            snprintf(&conversion[n], sizeof(conversion) - n, "s");
+            append(out, max, used, conversion, value);
+            return true;
+        }
+        case '%':
+            append(out, max, used, "%%");
+            return true;
+        default:
+        {
+            double value;
+            if (*pos + sizeof(value) > len)
+            {
+                return false;
+            }
+            memcpy(&value, &in[*pos], sizeof(value));
+            *pos += sizeof(value);
+            snprintf(&conversion[n], sizeof(conversion) - n, "%c", spec->conversion);
+            append(out, max, used, conversion, value);
+            return true;
+        }
+    }
+}
+
+size_t log_codec_decode(const uint8_t *record, size_t len, char *out, size_t max)
+{
+    if (max == 0)
+    {
+        return 0;
+    }
+    out[0] = '\0';
+
+    if (len < LOG_CODEC_HEADER_SIZE || record[0] != LOG_CODEC_MARKER ||
+        len < LOG_CODEC_HEADER_SIZE + (size_t)record[1])
+    {
+        return 0;
+    }
+    len = LOG_CODEC_HEADER_SIZE + record[1];
+
+    size_t pos = LOG_CODEC_HEADER_SIZE;
+    uint64_t timestamp;
+    if (len < pos + 4)
+    {
+        return 0;
+    }
+    char level = (char)record[pos++];
+    uint8_t tagId = record[pos++];
+    uint16_t formatId = record[pos] | (uint16_t)(record[pos + 1] << 8);
+    pos += 2;
+    if (tagId >= LOG_CATALOG_TAG_COUNT || formatId >= LOG_CATALOG_FORMAT_COUNT ||
+        !get_varint(record, &pos, len, &timestamp))
+    {
+        return 0;
+    }
+
+    size_t used = 0;
+    append(out, max, &used, "%c (%llu) %s: ", level, (unsigned long long)timestamp, log_catalog_tags[tagId]);
+
+    const char *f = log_catalog_formats[formatId];
+    while (*f != '\0')
+    {
+        const char *next = strchr(f, '%');
+        if (next == NULL)
+        {
+            append(out, max, &used, "%s", f);
+            break;
+        }
+        append(out, max, &used, "%.*s", (int)(next - f), f);
+
+        LogSpec_t spec;
+        f = parse_spec(next + 1, &spec);
+        if (f == NULL || !decode_arg(&spec, record, &pos, len, out, max, &used))
+        {
+            return 0;
+        }
+    }
+    append(out, max, &used, "\n");
+
+    return len;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * @file        log_codec.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Compact binary encoding of ESP log lines.
+ *              Instead of the formatted text, a record holds the level, the ids
+ *              of the tag and of the format string in log_catalog.h, the
+ *              timestamp and the raw arguments. The text is rebuilt on the host
+ *              by log_decode (src/device/host/tools) from the same catalog.
+ *
+ *              Record layout, integers are little endian:
+ *                LOG_CODEC_MARKER, payload length, level letter, tag id,
+ *                format id (2 bytes), timestamp (varint), arguments.
+ *              Integer arguments are varints, zigzag encoded when signed,
+ *              doubles take 8 bytes and strings a length byte and their bytes.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef LOG_CODEC_H
+#define LOG_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// First byte of a record. ASCII record separator, it never appears in a text line
+#define LOG_CODEC_MARKER 0x1E
+
+// Marker, payload length
+#define LOG_CODEC_HEADER_SIZE 2
+
+// Longest record, the payload length is a single byte
+#define LOG_CODEC_RECORD_MAX (LOG_CODEC_HEADER_SIZE + 255)
+
+/**
+ * @brief Builds the format lookup table. Must be called before log_codec_encode().
+ */
+void init_log_codec(void);
+
+/**
+ * @brief Encodes a line logged by ESP_LOGx().
+ * The format must be one of the catalog, called through esp_log_write() with
+ * the timestamp and tag as first arguments. Anything else is left to the caller
+ * to print as text, args is left untouched for it.
+ *
+ * @param out  Destination of the record.
+ * @param max  Capacity of out.
+ * @param fmt  Format passed to the vprintf function of the log.
+ * @param args Arguments of the line.
+ * @return Length of the record, 0 if the line cannot be encoded.
+ */
+size_t log_codec_encode(uint8_t *out, size_t max, const char *fmt, va_list args);
+
+/**
+ * @brief Rebuilds the text of a record.
+ *
+ * @param record Record starting with LOG_CODEC_MARKER.
+ * @param len    Bytes available at record.
+ * @param out    Destination of the text, always NUL terminated.
+ * @param max    Capacity of out.
+ * @return Length of the record consumed, 0 if it is incomplete or invalid.
+ */
+size_t log_codec_decode(const uint8_t *record, size_t len, char *out, size_t max);
+
+#endif  // LOG_CODEC_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,187 @@
+/*******************************************************************************
+ * @file        log_sink.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../log_sink/log_sink.h"
+
+/**
+ * @brief One line of the ring.
+ * A slot at ring position pos is free for the writer of pos when its sequence
+ * equals pos, and holds a complete line when it equals pos + 1.
+ */
+typedef struct
+{
+    atomic_uint_least32_t sequence;
+    uint16_t len;
+    char line[LOG_SINK_LINE_MAX];
+} LogSinkSlot_t;
+
+static LogSinkSlot_t slots[LOG_SINK_SLOTS];
+
+static atomic_uint_least32_t tail;   // Next position claimed by a writer
+static atomic_uint_least32_t head;   // Next position read by the log sink task
+
+static atomic_uint_least32_t dropped;
+static atomic_uint_least32_t truncated;
+static uint32_t written;
+
+// Lines are collected here and sent to the outputs LOG_SINK_BATCH_SIZE bytes at a time
+static char batch[LOG_SINK_BATCH_SIZE];
+static size_t batchLen;
+
+void init_log_sink(void)
+{
+    for (uint32_t i = 0; i < LOG_SINK_SLOTS; i++)
+    {
+        atomic_init(&slots[i].sequence, i);
+    }
+    atomic_init(&tail, 0);
+    atomic_init(&head, 0);
+
+    #if ENABLE_BINARY_LOG
+    init_log_codec();
+    #endif /* ENABLE_BINARY_LOG */
+
+    esp_log_set_vprintf(log_sink_vprintf);
+}
+
+int log_sink_vprintf(const char *fmt, va_list args)
+{
+    // Nobody drains the ring yet, print right away
+    if (logSinkTask == NULL)
+    {
+        return vprintf(fmt, args);
+    }
+
+    // Claim a slot, several tasks may be logging at the same time
+    uint32_t pos = atomic_load_explicit(&tail, memory_order_relaxed);
+    LogSinkSlot_t *slot;
+    while (true)
+    {
+        slot = &slots[pos & (LOG_SINK_SLOTS - 1)];
+        uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds a line of the previous lap, the ring is full
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return 0;
+        }
+        else
+        {
+            // Another writer claimed this position first
+            pos = atomic_load_explicit(&tail, memory_order_relaxed);
+        }
+    }
+
+    int len = 0;
+
+    #if ENABLE_BINARY_LOG
+    // Keep the raw arguments, the host formats the line
+    len = (int)log_codec_encode((uint8_t *)slot->line, LOG_SINK_LINE_MAX, fmt, args);
+    #endif /* ENABLE_BINARY_LOG */
+
+    if (len == 0)
+    {
+        len = vsnprintf(slot->line, LOG_SINK_LINE_MAX, fmt, args);
+    }
+
+    if (len < 0)
+    {
+        len = 0;
+    }
+    else if (len >= LOG_SINK_LINE_MAX)
+    {
+        // Keep the line break so the next line starts on its own
+        len = LOG_SINK_LINE_MAX - 1;
+        slot->line[len - 1] = '\n';
+        atomic_fetch_add_explicit(&truncated, 1, memory_order_relaxed);
+    }
+    slot->len = (uint16_t)len;
+
+    // Publish the line only once it is completely written
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+    // Wake the log sink task early instead of letting the ring fill up
+    if (pos - atomic_load_explicit(&head, memory_order_relaxed) == LOG_SINK_SLOTS / 2)
+    {
+        xTaskNotifyGive(logSinkTask);
+    }
+    return len;
+}
+
+// Send the collected lines to every output
+static void flush_batch(void)
+{
+    if (batchLen == 0)
+    {
+        return;
+    }
+
+    fwrite(batch, 1, batchLen, stdout);
+    fflush(stdout);
+
+    #if ENABLE_BT
+    bt_write((const uint8_t *)batch, batchLen);
+    #endif /* ENABLE_BT */
+
+    #if ENABLE_BLE
+    ble_write((const uint8_t *)batch, batchLen);
+    #endif /* ENABLE_BLE */
+
+    batchLen = 0;
+}
+
+void log_sink_drain(void)
+{
+    uint32_t pos = atomic_load_explicit(&head, memory_order_relaxed);
+
+    while (true)
+    {
+        LogSinkSlot_t *slot = &slots[pos & (LOG_SINK_SLOTS - 1)];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + 1)
+        {
+            // Empty, or the writer of this position has not finished yet
+            break;
+        }
+
+        if (batchLen + slot->len > sizeof(batch))
+        {
+            flush_batch();
+        }
+        memcpy(&batch[batchLen], slot->line, slot->len);
+        batchLen += slot->len;
+        written++;
+
+        // Hand the slot back to the writers of the next lap
+        atomic_store_explicit(&slot->sequence, pos + LOG_SINK_SLOTS, memory_order_release);
+        pos++;
+        atomic_store_explicit(&head, pos, memory_order_relaxed);
+    }
+
+    flush_batch();
+}
+
+void log_sink_get_stats(LogSinkStats_t *stats)
+{
+    stats->written = written;
+    stats->dropped = atomic_load_explicit(&dropped, memory_order_relaxed);
+    stats->truncated = atomic_load_explicit(&truncated, memory_order_relaxed);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * @file        log_sink.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Non-blocking output of the ESP log.
+ *              Installed with esp_log_set_vprintf(), it formats each line into a
+ *              slot of a lock-free multi-producer ring and returns. The log sink
+ *              task drains the ring in batches to the UART and, when enabled, to
+ *              the SPP and BLE links. Lines logged while the ring is full are
+ *              dropped and counted, the logging task never waits for the radio.
+ *              With ENABLE_BINARY_LOG the slots hold log_codec records instead
+ *              of text, the line is never formatted on the device.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../logging/logging_utils.h"
+#include "../log_codec/log_codec.h"
+
+// Lines held in the ring, a power of 2
+#define LOG_SINK_SLOTS 32
+
+// Longest line kept, longer lines are truncated
+#define LOG_SINK_LINE_MAX 128
+
+// Bytes sent to the outputs in one write
+#define LOG_SINK_BATCH_SIZE 512
+
+// The ring is drained at least this often, and as soon as it is half full
+#define LOG_SINK_FLUSH_PERIOD pdMS_TO_TICKS(50)
+
+/**
+ * @brief Handle of the log sink task, defined in task_utils.c.
+ */
+extern TaskHandle_t logSinkTask;
+
+/**
+ * @brief Counters of the log sink since boot.
+ */
+typedef struct
+{
+    uint32_t written;     /*< Lines sent to the outputs                   */
+    uint32_t dropped;     /*< Lines lost because the ring was full        */
+    uint32_t truncated;   /*< Lines cut to LOG_SINK_LINE_MAX - 1 bytes    */
+} LogSinkStats_t;
+
+/**
+ * @brief Routes the ESP log through the ring. Until the log sink task runs the
+ *        lines are still printed directly to the UART.
+ */
+void init_log_sink(void);
+
+/**
+ * @brief vprintf_like_t installed by init_log_sink(). Never blocks.
+ *
+ * @return Number of characters kept, 0 if the line was dropped.
+ */
+int log_sink_vprintf(const char *fmt, va_list args);
+
+/**
+ * @brief Sends every line in the ring to the outputs. Meant to be called only
+ *        from the log sink task.
+ */
+void log_sink_drain(void);
+
+/**
+ * @brief Copies the counters of the log sink.
+ */
+void log_sink_get_stats(LogSinkStats_t *stats);
+
+#endif  // LOG_SINK_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
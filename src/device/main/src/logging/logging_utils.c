@@ -18,32 +18,17 @@ const char *INTERRUPT_LOG_TAG = "Interrupt Log";
 const char *GPIO_TAG = "GPIO Log";
 const char *GPIO_STATES_TAG = "GPIO States Log";
 const char *MOTOR_TAG = "Motor Log";
+const char *MOTION_TAG = "Motion Log";
+const char *PATROL_TAG = "Patrol Log";
+const char *HAZE_TAG = "Haze Log";
+const char *CLASSIFIER_TAG = "Classifier Log";
 
 #if ENABLE_BT
 const char *BT_TAG = "Bluetooth Log";
-
-void bt_log_output(const char *fmt, va_list args)
-{
-    char buffer[BT_TX_BUFFER_SIZE];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-
-    bt_printf("%s", buffer); //setup serial output communicate by bt
-    // ALWAYS Write to stdout
-    printf("%s", buffer);
-}
 #endif /* ENABLE_BT */
 
-
 #if ENABLE_BLE
 const char *BLE_TAG = "BLE-Server";
-
-void ble_log_output(const char *fmt, va_list args)
-{
-    char buffer[MAX_NOTIFICATION_LEN];
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-
-    ble_printf("%s", buffer); //setup serial output communicate by ble
-}
 #endif /* ENABLE_BLE */
 
 /********************************* END OF FILE ********************************/
@@ -60,6 +60,26 @@ extern const char *GPIO_STATES_TAG;
  */
 extern const char *MOTOR_TAG;
 
+/**
+ * @brief Tag for motion detection log messages
+ */
+extern const char *MOTION_TAG;
+
+/**
+ * @brief Tag for patrol log messages
+ */
+extern const char *PATROL_TAG;
+
+/**
+ * @brief Tag for haze detection log messages
+ */
+extern const char *HAZE_TAG;
+
+/**
+ * @brief Tag for classifier log messages
+ */
+extern const char *CLASSIFIER_TAG;
+
 #if ENABLE_BT
 
 #include "../bt_utils/bt_utils.h"
@@ -69,13 +89,6 @@ extern const char *MOTOR_TAG;
  */
 extern const char *BT_TAG;
 
-/**
- * @brief Logging function for Bluetooth output
- * @param fmt Format string for the log message
- * @param args Variable argument list
- */
-void bt_log_output(const char *fmt, va_list args);
-
 #endif /* ENABLE_BT */
 
 #if ENABLE_BLE
@@ -87,13 +100,6 @@ void bt_log_output(const char *fmt, va_list args);
  */
 extern const char *BLE_TAG;
 
-/**
- * @brief Logging function for Bluetooth Low Energy output
- * @param fmt Format string for the log message
- * @param args Variable argument list
- */
-void ble_log_output(const char *fmt, va_list args);
-
 #endif /* ENABLE_BLE */
 
 #endif  // LOGGING_UTILS_H
@@ -22,22 +22,36 @@ void app_main(void)
 
     #if ENABLE_BT
     init_bluetooth(ret);
-    // Set the custom log output function
-    esp_log_set_vprintf(bt_log_output);
     #endif /* ENABLE_BT */
     
     #if ENABLE_BLE
     // Initialize Bluetooth Low Energy
     startBLE();
-    snprintf(notification, 
-            sizeof(notification), "Initial Notification");
-    // Set the custom log output function
-    esp_log_set_vprintf(ble_log_output);
+    ble_printf("Initial Notification");
     #endif /* ENABLE_BLE */
 
+    // Route the log through the ring drained by the log sink task
+    init_log_sink();
+
     // Initialize the camera
     ESP_ERROR_CHECK(init_camera());
 
+    // Initialize the motion frame store
+    ESP_ERROR_CHECK(init_motion_detection());
+
+    // Decoder of the haze detect task
+    ESP_ERROR_CHECK(init_haze_detection());
+
+    // Model of the classifier task, the firmware may be built without one
+    esp_err_t classifierErr = init_classifier();
+    if (classifierErr != ESP_OK)
+    {
+        ESP_LOGW(CLASSIFIER_TAG, "Classifier disabled: %s", esp_err_to_name(classifierErr));
+    }
+
+    // Initialize the /events client list
+    ESP_ERROR_CHECK(init_events());
+
     // Initialize GPIO pins
     init_gpio();
 
@@ -47,6 +61,12 @@ void app_main(void)
     //Init motor structures
     initialize_motors();
 
+    // Start the servo trajectory timer
+    ESP_ERROR_CHECK(init_motor_planner());
+
+    // Load the patrol presets saved in NVS
+    ESP_ERROR_CHECK(init_patrol());
+
     //Initialize FreeRTOS Tasks
     initialize_tasks();
 
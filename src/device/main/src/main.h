@@ -27,20 +27,25 @@
 #include "connect_wifi/connect_wifi.h"
 #include "camera/camera_utils.h"
 #include "camera/camera_pins.h"
+#include "motion/motion_detection.h"
+#include "haze/haze_detector.h"
+#include "classifier/classifier.h"
+#include "events/events.h"
 #include "gpio_utils/gpio_utils.h"
 #include "motor_control/motor_control.h"
+#include "motor_planner/motor_planner.h"
+#include "patrol/patrol.h"
 #include "web_server/web_server.c"
 #include "http_handlers/http_handlers.h"
 #include "motor_control/motor_control.h"
 #include "task_utils/task_utils.h"
 #include "gpio_interrupts/gpio_interrupts.h"
 #include "logging/logging_utils.h"
+#include "log_sink/log_sink.h"
 
 // Global variable to store the authenticated user's role
 extern UserRole authenticatedUserRole;
 
-// Boundary for multipart/x-mixed-replace content type
-#define PART_BOUNDARY "123456789000000000000987654321"
 // Boundary for multipart/form-data content type
 #define BOUNDARY "------------------------123456789000000000000987654321"
 
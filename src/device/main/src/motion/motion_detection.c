@@ -0,0 +1,273 @@
+/*******************************************************************************
+ * @file        motion_detection.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../motion/motion_detection.h"
+
+static MotionSnapshot_t snapshots[MOTION_SNAPSHOT_COUNT];
+static uint32_t snapshotId = 0;             // Id of the last stored snapshot
+static SemaphoreHandle_t snapshotMutex;     // Protects snapshots and snapshotId
+
+// Buffers below are only touched by the motion capture task
+static JpegDcDecoder_t *decoder = NULL;
+static uint8_t *decodeBuffer = NULL;        // Luma of the frame decoded at 1/8 scale
+static uint8_t *thumbnails[2] = {NULL, NULL};
+static uint8_t *currentThumb = NULL;        // Thumbnail of the frame being analysed
+static uint8_t *referenceThumb = NULL;      // Thumbnail of the previous frame
+static bool referenceValid = false;
+static size_t decodeWidth = 0;
+static size_t decodeHeight = 0;
+
+esp_err_t init_motion_detection(void)
+{
+    snapshotMutex = xSemaphoreCreateMutex();
+    decoder = heap_caps_malloc(sizeof(JpegDcDecoder_t), MALLOC_CAP_8BIT);
+    if (snapshotMutex == NULL || decoder == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+// Resize the work buffers for frames decoded to width x height
+static bool ensure_buffers(size_t width, size_t height)
+{
+    if (width == decodeWidth && height == decodeHeight)
+    {
+        return true;
+    }
+
+    size_t thumbPixels = (width / 2) * (height / 2);
+    uint8_t *decode = heap_caps_realloc(decodeBuffer, width * height, MALLOC_CAP_8BIT);
+    if (decode == NULL)
+    {
+        return false;
+    }
+    decodeBuffer = decode;
+
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t *thumb = heap_caps_realloc(thumbnails[i], thumbPixels, MALLOC_CAP_8BIT);
+        if (thumb == NULL)
+        {
+            return false;
+        }
+        thumbnails[i] = thumb;
+    }
+
+    currentThumb = thumbnails[0];
+    referenceThumb = thumbnails[1];
+    referenceValid = false; // A different frame size cannot be compared
+    decodeWidth = width;
+    decodeHeight = height;
+    return true;
+}
+
+// Decode a JPEG frame to a grayscale thumbnail at 1/16 of its size in currentThumb
+static bool make_thumbnail(const camera_fb_t *fb)
+{
+    if (fb->format != PIXFORMAT_JPEG)
+    {
+        return false;
+    }
+
+    // Only the DC coefficients are decoded, one luma value per 8x8 block
+    uint16_t width;
+    uint16_t height;
+    if (jpeg_dc_get_size(fb->buf, fb->len, &width, &height) != ESP_OK ||
+        width < 2 || height < 2 || !ensure_buffers(width, height))
+    {
+        return false;
+    }
+
+    JpegDcImage_t image = {.luma = decodeBuffer, .saturation = NULL, .capacity = (size_t)width * height};
+    if (jpeg_dc_decode(decoder, fb->buf, fb->len, &image) != ESP_OK)
+    {
+        return false;
+    }
+
+    // Average 2x2 blocks to smooth out JPEG noise
+    size_t thumbWidth = width / 2;
+    size_t thumbHeight = height / 2;
+    for (size_t y = 0; y < thumbHeight; y++)
+    {
+        const uint8_t *row0 = decodeBuffer + (2 * y) * width;
+        const uint8_t *row1 = row0 + width;
+        for (size_t x = 0; x < thumbWidth; x++)
+        {
+            uint32_t sum = row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1];
+            currentThumb[y * thumbWidth + x] = sum >> 2;
+        }
+    }
+
+    return true;
+}
+
+// Per mille of pixels that differ between the reference and current thumbnails
+static uint16_t changed_permille(void)
+{
+    size_t pixels = (decodeWidth / 2) * (decodeHeight / 2);
+    int32_t sumReference = 0;
+    int32_t sumCurrent = 0;
+
+    for (size_t i = 0; i < pixels; i++)
+    {
+        sumReference += referenceThumb[i];
+        sumCurrent += currentThumb[i];
+    }
+
+    // Ignore a uniform brightness shift, e.g. from the auto exposure
+    int32_t offset = (sumCurrent - sumReference) / (int32_t)pixels;
+
+    size_t changed = 0;
+    for (size_t i = 0; i < pixels; i++)
+    {
+        int32_t diff = (int32_t)currentThumb[i] - referenceThumb[i] - offset;
+        if (diff > MOTION_PIXEL_THRESHOLD || diff < -MOTION_PIXEL_THRESHOLD)
+        {
+            changed++;
+        }
+    }
+
+    return (uint16_t)((changed * 1000) / pixels);
+}
+
+// Copy a frame to the oldest snapshot slot nobody is reading
+static bool store_snapshot(const camera_fb_t *fb, uint16_t permille)
+{
+    bool stored = false;
+
+    xSemaphoreTake(snapshotMutex, portMAX_DELAY);
+
+    MotionSnapshot_t *slot = NULL;
+    for (int i = 0; i < MOTION_SNAPSHOT_COUNT; i++)
+    {
+        if (snapshots[i].readers == 0 && (slot == NULL || snapshots[i].id < slot->id))
+        {
+            slot = &snapshots[i];
+        }
+    }
+
+    if (slot != NULL)
+    {
+        if (slot->capacity < fb->len)
+        {
+            uint8_t *buf = heap_caps_realloc(slot->buf, fb->len, MALLOC_CAP_SPIRAM);
+            if (buf != NULL)
+            {
+                slot->buf = buf;
+                slot->capacity = fb->len;
+            }
+        }
+
+        if (slot->capacity >= fb->len)
+        {
+            memcpy(slot->buf, fb->buf, fb->len);
+            slot->len = fb->len;
+            slot->id = ++snapshotId;
+            slot->timestamp = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+            slot->changedPermille = permille;
+            stored = true;
+        }
+    }
+
+    xSemaphoreGive(snapshotMutex);
+
+    return stored;
+}
+
+uint8_t motion_capture_burst(void)
+{
+    uint8_t stored = 0;
+    uint32_t seq = 0;
+
+    for (int i = 0; i < MOTION_BURST_FRAMES; i++)
+    {
+        camera_fb_t *fb = camera_frame_acquire_next(&seq, CAMERA_FRAME_TIMEOUT);
+        if (!fb)
+        {
+            ESP_LOGE(MOTION_TAG, "No frame for motion check");
+            break;
+        }
+
+        if (make_thumbnail(fb))
+        {
+            // The first frame of a burst is compared with the scene before the PIR fired
+            if (referenceValid)
+            {
+                uint16_t permille = changed_permille();
+                if (permille >= MOTION_CHANGED_PERMILLE)
+                {
+                    if (store_snapshot(fb, permille))
+                    {
+                        stored++;
+                    }
+                    else
+                    {
+                        ESP_LOGW(MOTION_TAG, "No free slot for motion frame");
+                    }
+                }
+            }
+
+            uint8_t *swap = referenceThumb;
+            referenceThumb = currentThumb;
+            currentThumb = swap;
+            referenceValid = true;
+        }
+        else
+        {
+            ESP_LOGE(MOTION_TAG, "Frame could not be decoded");
+        }
+
+        camera_frame_release(fb);
+    }
+
+    ESP_LOGI(MOTION_TAG, "Motion burst done, %u frames stored", stored);
+
+    return stored;
+}
+
+MotionSnapshot_t *motion_snapshot_acquire(uint32_t afterId)
+{
+    MotionSnapshot_t *found = NULL;
+
+    xSemaphoreTake(snapshotMutex, portMAX_DELAY);
+    for (int i = 0; i < MOTION_SNAPSHOT_COUNT; i++)
+    {
+        if (snapshots[i].id > afterId && (found == NULL || snapshots[i].id < found->id))
+        {
+            found = &snapshots[i];
+        }
+    }
+    if (found != NULL)
+    {
+        found->readers++;
+    }
+    xSemaphoreGive(snapshotMutex);
+
+    return found;
+}
+
+void motion_snapshot_release(MotionSnapshot_t *snapshot)
+{
+    if (snapshot == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(snapshotMutex, portMAX_DELAY);
+    if (snapshot->readers > 0)
+    {
+        snapshot->readers--;
+    }
+    xSemaphoreGive(snapshotMutex);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * @file        motion_detection.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       PIR triggered capture with a frame difference check.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef MOTION_DETECTION_H
+#define MOTION_DETECTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "../camera/camera_utils.h"
+#include "../jpeg_dc/jpeg_dc.h"
+#include "../logging/logging_utils.h"
+
+// Frames analysed every time the PIR sensor fires
+#define MOTION_BURST_FRAMES 5
+
+// Pause between two bursts while the PIR output stays high
+#define MOTION_BURST_INTERVAL pdMS_TO_TICKS(500)
+
+// Luma difference (0-255) above which a thumbnail pixel counts as changed
+#define MOTION_PIXEL_THRESHOLD 24
+
+// Share of changed thumbnail pixels, in per mille, that makes a frame worth keeping
+#define MOTION_CHANGED_PERMILLE 15
+
+// Number of changed frames kept for clients to download
+#define MOTION_SNAPSHOT_COUNT 4
+
+/**
+ * @brief Copy of a camera frame in which motion was detected.
+ */
+typedef struct
+{
+    uint8_t *buf;               /*< JPEG data, kept in PSRAM                     */
+    size_t len;                 /*< Length of the JPEG data                      */
+    size_t capacity;            /*< Allocated size of buf                        */
+    uint32_t id;                /*< Increasing snapshot id, 0 when the slot is empty */
+    int64_t timestamp;          /*< Capture time of the frame in microseconds    */
+    uint16_t changedPermille;   /*< Share of thumbnail pixels that changed       */
+    uint8_t readers;            /*< Clients currently sending this snapshot      */
+} MotionSnapshot_t;
+
+/**
+ * @brief Initializes the snapshot store used by the motion capture task.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the mutex or the decoder cannot be created.
+ */
+esp_err_t init_motion_detection(void);
+
+/**
+ * @brief Analyses MOTION_BURST_FRAMES consecutive frames.
+ * Each frame is decoded at 1/8 scale from its DC coefficients, reduced to
+ * a 1/16 scale grayscale thumbnail and compared with the previous one. Frames in which more than
+ * MOTION_CHANGED_PERMILLE of the pixels changed are copied to the snapshot
+ * store, the others are dropped.
+ *
+ * @return Number of frames stored.
+ */
+uint8_t motion_capture_burst(void);
+
+/**
+ * @brief Borrows the oldest stored snapshot newer than a known one.
+ * The snapshot must be given back with motion_snapshot_release().
+ *
+ * @param afterId Id of the last snapshot seen by the client (0 for any).
+ * @return The snapshot, or NULL if there is no newer one.
+ */
+MotionSnapshot_t *motion_snapshot_acquire(uint32_t afterId);
+
+/**
+ * @brief Gives back a snapshot obtained with motion_snapshot_acquire().
+ *
+ * @param snapshot The borrowed snapshot.
+ */
+void motion_snapshot_release(MotionSnapshot_t *snapshot);
+
+#endif  // MOTION_DETECTION_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
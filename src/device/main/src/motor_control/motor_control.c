@@ -13,36 +13,98 @@ Motor create_motor(ledc_mode_t speed_mode, uint8_t channel) {
     Motor motor;
     motor.speed_mode = speed_mode;
     motor.channel = channel;
-    motor.angle = 0.0f;
-    motor.is_active = true;
+    motor.min_offset_us = 0;
+    motor.max_offset_us = 0;
+    motor.duty_table = NULL;
+    motor.state.angle = 0.0f;
+    motor.state.target = 0.0f;
+    motor.state.is_active = true;
+    motor.state.timestamp = 0;
+    atomic_init(&motor.state_seq, 0);
+    motor.state_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
     return motor;
 }
 
+// Seqlock writer side. The critical section orders concurrent writers and keeps
+// the writer from being preempted while the sequence is odd.
+static void motor_state_write_begin(Motor *motor) {
+    taskENTER_CRITICAL(&motor->state_lock);
+    atomic_fetch_add_explicit(&motor->state_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void motor_state_write_end(Motor *motor, int64_t now) {
+    motor->state.timestamp = now;
+    atomic_fetch_add_explicit(&motor->state_seq, 1, memory_order_release);
+    taskEXIT_CRITICAL(&motor->state_lock);
+}
+
 //Global motor strucures
 Motor motor1;
 Motor motor2;
 
+// Duty tables, in internal RAM so lookups never wait for flash
+static uint16_t motor1DutyTable[MOTOR_DUTY_TABLE_SIZE];
+static uint16_t motor2DutyTable[MOTOR_DUTY_TABLE_SIZE];
+
 void initialize_motors()
 {
     motor1 = create_motor(MOTOR_1_SPEED_MODE, MOTOR_1_CHANNEL);
     motor2 = create_motor(MOTOR_2_SPEED_MODE, MOTOR_2_CHANNEL);
+
+    motor1.duty_table = motor1DutyTable;
+    motor2.duty_table = motor2DutyTable;
+    calibrate_motor(&motor1, MOTOR_1_MIN_OFFSET_US, MOTOR_1_MAX_OFFSET_US);
+    calibrate_motor(&motor2, MOTOR_2_MIN_OFFSET_US, MOTOR_2_MAX_OFFSET_US);
+}
+
+esp_err_t calibrate_motor(Motor *motor, int16_t min_offset_us, int16_t max_offset_us) {
+    int32_t min_us = SERVO_WIDTH_MIN_US + min_offset_us;
+    int32_t max_us = SERVO_WIDTH_MAX_US + max_offset_us;
+    MOTOR_CHECK(motor->duty_table != NULL, "Motor has no duty table", ESP_ERR_INVALID_STATE);
+    MOTOR_CHECK(min_us > 0 && min_us < max_us && max_us < PWM_PERIOD_US, "Pulse widths out of range", ESP_ERR_INVALID_ARG);
+
+    motor->min_offset_us = min_offset_us;
+    motor->max_offset_us = max_offset_us;
+
+    // duty = width_us * 2^resolution / period_us, rounded, in integers to avoid float drift
+    const int64_t steps = MOTOR_DUTY_TABLE_SIZE - 1;
+    const int64_t den = steps * PWM_PERIOD_US;
+    for (int64_t i = 0; i < MOTOR_DUTY_TABLE_SIZE; i++) {
+        int64_t width_scaled = min_us * steps + (max_us - min_us) * i;   // Pulse width * steps
+        motor->duty_table[i] = (uint16_t)((width_scaled * (1 << PWM_RESOLUTION) + den / 2) / den);
+    }
+
+    return ESP_OK;
 }
 
 void start_motor_movement(Motor *motor) {
-    motor->is_active = true;
+    int64_t now = esp_timer_get_time();
+    motor_state_write_begin(motor);
+    motor->state.is_active = true;
+    motor_state_write_end(motor, now);
 }
 
 void stop_motor_movement(Motor *motor) {
-    motor->is_active = false;
+    int64_t now = esp_timer_get_time();
+    motor_state_write_begin(motor);
+    motor->state.is_active = false;
+    motor_state_write_end(motor, now);
 }
 
 esp_err_t move_motor(const Motor *motor, float angle) {
+    MOTOR_CHECK(angle >= 0.0f, "Angle can't be negative", ESP_ERR_INVALID_ARG);
+
+    return move_motor_tenths(motor, (uint16_t)(fminf(angle, SERVO_MAX_ANGLE) * 10.0f + 0.5f));
+}
+
+esp_err_t move_motor_tenths(const Motor *motor, uint16_t tenths) {
     MOTOR_CHECK(motor->speed_mode < LEDC_SPEED_MODE_MAX, "LEDC speed mode invalid", ESP_ERR_INVALID_ARG);
     MOTOR_CHECK(motor->channel < LEDC_CHANNEL_MAX, "LEDC channel number too large", ESP_ERR_INVALID_ARG);
-    MOTOR_CHECK(angle >= 0.0f, "Angle can't be negative", ESP_ERR_INVALID_ARG);
+    MOTOR_CHECK(motor->duty_table != NULL, "Motor has no duty table", ESP_ERR_INVALID_STATE);
 
     esp_err_t result;
-    uint32_t duty = calculate_duty(angle);
+    uint32_t duty = motor_duty(motor, tenths);
     result = ledc_set_duty(motor->speed_mode, (ledc_channel_t)motor->channel, duty);
     result |= ledc_update_duty(motor->speed_mode, (ledc_channel_t)motor->channel);
 
@@ -55,20 +117,51 @@ esp_err_t move_motor(const Motor *motor, float angle) {
 }
 
 uint32_t calculate_duty(float angle) {
-    uint32_t duty  = (uint32_t)(SERVO_WIDTH_MIN_US + ((SERVO_WIDTH_MAX_US - SERVO_WIDTH_MIN_US) * angle) / SERVO_MAX_ANGLE);
+    float width_us = SERVO_WIDTH_MIN_US + ((SERVO_WIDTH_MAX_US - SERVO_WIDTH_MIN_US) * angle) / SERVO_MAX_ANGLE;
+    uint32_t duty  = (uint32_t)(width_us * (1 << PWM_RESOLUTION) / PWM_PERIOD_US + 0.5f);
     return duty;
 }
 
-// Motor getter
+void get_motor_state(const Motor *motor, MotorState *state)
+{
+    unsigned int seq;
+    do {
+        seq = atomic_load_explicit(&motor->state_seq, memory_order_acquire);
+        *state = *(const volatile MotorState *)&motor->state;
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != atomic_load_explicit(&motor->state_seq, memory_order_relaxed));
+}
+
+// Motor getters
 float get_motor_angle(const Motor *motor)
 {
-    return motor->angle;
+    MotorState state;
+    get_motor_state(motor, &state);
+    return state.angle;
 }
 
-// Motor setter
+bool is_motor_active(const Motor *motor)
+{
+    MotorState state;
+    get_motor_state(motor, &state);
+    return state.is_active;
+}
+
+// Motor setters
 void set_motor_angle(Motor *motor, float angle)
 {
-    motor->angle = angle;
+    int64_t now = esp_timer_get_time();
+    motor_state_write_begin(motor);
+    motor->state.angle = angle;
+    motor_state_write_end(motor, now);
+}
+
+void set_motor_target(Motor *motor, float target)
+{
+    int64_t now = esp_timer_get_time();
+    motor_state_write_begin(motor);
+    motor->state.target = target;
+    motor_state_write_end(motor, now);
 }
 
 /********************************* END OF FILE ********************************/
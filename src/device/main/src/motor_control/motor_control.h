@@ -10,8 +10,12 @@
 #define MOTOR_CONTROL_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <math.h>
+#include <stdatomic.h>
 #include "driver/ledc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 #include "../gpio_utils/gpio_utils.h"
 
 #define MOTOR_1_CHANNEL LEDC_CHANNEL_0
@@ -30,17 +34,41 @@
 
 #define SERVO_MAX_ANGLE 180
 
+// LEDC period in microseconds
+#define PWM_PERIOD_US (1000000 / PWM_FREQUENCY)
+
+// One duty table entry per tenth of a degree, 0 to SERVO_MAX_ANGLE
+#define MOTOR_DUTY_TABLE_SIZE (SERVO_MAX_ANGLE * 10 + 1)
+
+// Calibration: offsets added to SERVO_WIDTH_MIN_US and SERVO_WIDTH_MAX_US per motor
+#define MOTOR_1_MIN_OFFSET_US 0
+#define MOTOR_1_MAX_OFFSET_US 0
+#define MOTOR_2_MIN_OFFSET_US 0
+#define MOTOR_2_MAX_OFFSET_US 0
+
 #define MOTOR_CHECK(a, str, ret_val) \
     if (!(a)) { \
         ESP_LOGE(MOTOR_TAG, "%s(%d): %s", __FUNCTION__, __LINE__, str); \
         return (ret_val); \
     }
 
+// Consistent snapshot of a motor, see get_motor_state()
+typedef struct {
+    float angle;             // Last angle written to the servo, degrees
+    float target;            // Angle the planner moves the motor to, degrees
+    bool is_active;
+    int64_t timestamp;       // esp_timer time of the last change, microseconds
+} MotorState;
+
 typedef struct {
     ledc_mode_t speed_mode;
     uint8_t channel;
-    float angle;
-    bool is_active;
+    int16_t min_offset_us;   // Calibration of the 0 degree pulse width
+    int16_t max_offset_us;   // Calibration of the SERVO_MAX_ANGLE pulse width
+    uint16_t *duty_table;    // LEDC duty per tenth of a degree, MOTOR_DUTY_TABLE_SIZE entries
+    MotorState state;        // Only read through get_motor_state() and the getters
+    atomic_uint state_seq;   // Seqlock sequence, odd while state is being written
+    portMUX_TYPE state_lock; // Orders the writers of state, readers never take it
 } Motor;
 
 Motor create_motor(ledc_mode_t speed_mode, uint8_t channel);
@@ -53,13 +81,36 @@ void stop_motor_movement(Motor *motor);
 
 esp_err_t move_motor(const Motor *motor, float angle);
 
+// Same as move_motor() with an integer angle in tenths of a degree
+esp_err_t move_motor_tenths(const Motor *motor, uint16_t tenths);
+
+// LEDC duty of an uncalibrated servo, the formula the duty tables are built from
 uint32_t calculate_duty(float angle);
 
-// Motor getter
+// Set the pulse width offsets of a motor and rebuild its duty table
+esp_err_t calibrate_motor(Motor *motor, int16_t min_offset_us, int16_t max_offset_us);
+
+// LEDC duty of a motor for an angle in tenths of a degree. A table lookup
+// without floating point, so it can be used from a timer or an ISR.
+static inline uint32_t motor_duty(const Motor *motor, uint16_t tenths)
+{
+    if (tenths >= MOTOR_DUTY_TABLE_SIZE) {
+        tenths = MOTOR_DUTY_TABLE_SIZE - 1;
+    }
+    return motor->duty_table[tenths];
+}
+
+// Copy the state of a motor without blocking. Retries while a writer is
+// updating it, writers never wait on readers.
+void get_motor_state(const Motor *motor, MotorState *state);
+
+// Motor getters
 float get_motor_angle(const Motor *motor);
+bool is_motor_active(const Motor *motor);
 
-// Motor setter
+// Motor setters, called by the planner as the motor moves
 void set_motor_angle(Motor *motor, float angle);
+void set_motor_target(Motor *motor, float target);
 
 #endif /* MOTOR_CONTROL_H_ */
 
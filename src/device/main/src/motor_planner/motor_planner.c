@@ -0,0 +1,242 @@
+/*******************************************************************************
+ * @file        motor_planner.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../motor_planner/motor_planner.h"
+
+// Defined in motor_control.c
+extern Motor motor1;
+extern Motor motor2;
+
+/**
+ * @brief Trajectory state of one motor.
+ */
+typedef struct
+{
+    Motor *motor;
+    float position;          /*< Degrees, last angle written to the servo   */
+    float velocity;          /*< Degrees per second, signed                 */
+    float target;            /*< Degrees                                    */
+    float maxVelocity;       /*< Degrees per second                         */
+    float maxAcceleration;   /*< Degrees per second squared                 */
+    bool moving;             /*< The target was not reached yet             */
+} MotorAxis_t;
+
+static MotorAxis_t axes[MOTOR_PLANNER_AXES];
+static portMUX_TYPE axesLock = portMUX_INITIALIZER_UNLOCKED;   // Protects axes
+static esp_timer_handle_t plannerTimer;
+static int64_t lastStep;
+
+static MotorAxis_t *find_axis(const Motor *motor)
+{
+    for (int i = 0; i < MOTOR_PLANNER_AXES; i++)
+    {
+        if (axes[i].motor == motor)
+        {
+            return &axes[i];
+        }
+    }
+    return NULL;
+}
+
+// Advance one axis by dt seconds. Called with axesLock held.
+static void step_axis(MotorAxis_t *axis, float dt)
+{
+    float remaining = axis->target - axis->position;
+    float direction = remaining >= 0.0f ? 1.0f : -1.0f;
+    float maxChange = axis->maxAcceleration * dt;
+
+    // Arrived: close enough that one step of acceleration stops the motor on the target
+    if (fabsf(remaining) <= maxChange * dt && fabsf(axis->velocity) <= maxChange)
+    {
+        axis->position = axis->target;
+        axis->velocity = 0.0f;
+        axis->moving = false;
+        return;
+    }
+
+    // Fastest speed that still allows stopping at the target, for a speed held
+    // over whole steps of dt. A target behind the motor, after an overshoot or a
+    // new target, makes the motor brake and turn around.
+    float brakingVelocity = sqrtf(2.0f * axis->maxAcceleration * fabsf(remaining) + 0.25f * maxChange * maxChange)
+                            - 0.5f * maxChange;
+    float wanted = direction * fminf(axis->maxVelocity, brakingVelocity);
+
+    // Reach the wanted speed within the acceleration limit
+    float change = wanted - axis->velocity;
+    if (change > maxChange)
+    {
+        change = maxChange;
+    }
+    else if (change < -maxChange)
+    {
+        change = -maxChange;
+    }
+    axis->velocity += change;
+    axis->position += axis->velocity * dt;
+
+    // A target set close to an end while moving fast towards it is overshot,
+    // the servo can't go past its range and stops there
+    if (axis->position < 0.0f || axis->position > SERVO_MAX_ANGLE)
+    {
+        axis->position = fminf(fmaxf(axis->position, 0.0f), SERVO_MAX_ANGLE);
+        axis->velocity = 0.0f;
+    }
+}
+
+// Runs in the esp_timer task every MOTOR_PLANNER_PERIOD_US
+static void planner_step(void *arg)
+{
+    (void)arg;
+
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - lastStep;
+    lastStep = now;
+    if (elapsed > MOTOR_PLANNER_MAX_STEP_US)
+    {
+        elapsed = MOTOR_PLANNER_MAX_STEP_US;
+    }
+    float dt = elapsed / 1000000.0f;
+
+    for (int i = 0; i < MOTOR_PLANNER_AXES; i++)
+    {
+        MotorAxis_t *axis = &axes[i];
+        bool moved = false;
+        bool halted = false;
+        float position;
+
+        taskENTER_CRITICAL(&axesLock);
+        if (axis->moving)
+        {
+            if (is_motor_active(axis->motor))
+            {
+                step_axis(axis, dt);
+                moved = true;
+            }
+            else
+            {
+                // Stopped motors halt where they are
+                axis->target = axis->position;
+                axis->velocity = 0.0f;
+                axis->moving = false;
+                halted = true;
+            }
+        }
+        position = axis->position;
+        taskEXIT_CRITICAL(&axesLock);
+
+        // The LEDC driver takes its own lock, call it outside the critical section
+        if (moved)
+        {
+            move_motor(axis->motor, position);
+            set_motor_angle(axis->motor, position);
+        }
+        else if (halted)
+        {
+            set_motor_target(axis->motor, position);
+        }
+    }
+}
+
+esp_err_t init_motor_planner(void)
+{
+    axes[0].motor = &motor1;
+    axes[1].motor = &motor2;
+    for (int i = 0; i < MOTOR_PLANNER_AXES; i++)
+    {
+        axes[i].position = get_motor_angle(axes[i].motor);
+        axes[i].target = axes[i].position;
+        axes[i].velocity = 0.0f;
+        axes[i].moving = false;
+    }
+
+    const esp_timer_create_args_t timerArgs = {
+        .callback = planner_step,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "motor_planner",
+        .skip_unhandled_events = true
+    };
+    esp_err_t err = esp_timer_create(&timerArgs, &plannerTimer);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(MOTOR_TAG, "Failed to create planner timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    lastStep = esp_timer_get_time();
+    err = esp_timer_start_periodic(plannerTimer, MOTOR_PLANNER_PERIOD_US);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(MOTOR_TAG, "Failed to start planner timer: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t motor_planner_set_target(Motor *motor, float angle, float maxVelocity, float maxAcceleration)
+{
+    MotorAxis_t *axis = find_axis(motor);
+    if (axis == NULL || !(maxVelocity > 0.0f) || !(maxAcceleration > 0.0f))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!(angle >= 0.0f))
+    {
+        angle = 0.0f;
+    }
+    else if (angle > SERVO_MAX_ANGLE)
+    {
+        angle = SERVO_MAX_ANGLE;
+    }
+
+    taskENTER_CRITICAL(&axesLock);
+    axis->target = angle;
+    axis->maxVelocity = maxVelocity;
+    axis->maxAcceleration = maxAcceleration;
+    axis->moving = true;
+    taskEXIT_CRITICAL(&axesLock);
+
+    set_motor_target(motor, angle);
+    return ESP_OK;
+}
+
+bool motor_planner_is_idle(const Motor *motor)
+{
+    MotorAxis_t *axis = find_axis(motor);
+    if (axis == NULL)
+    {
+        return true;
+    }
+
+    taskENTER_CRITICAL(&axesLock);
+    bool idle = !axis->moving;
+    taskEXIT_CRITICAL(&axesLock);
+
+    return idle;
+}
+
+float motor_planner_travel_time(float distance, float maxVelocity, float maxAcceleration)
+{
+    if (!(maxVelocity > 0.0f) || !(maxAcceleration > 0.0f))
+    {
+        return 0.0f;
+    }
+
+    distance = fabsf(distance);
+
+    // Triangular profile when the speed limit is never reached
+    if (distance < maxVelocity * maxVelocity / maxAcceleration)
+    {
+        return 2.0f * sqrtf(distance / maxAcceleration);
+    }
+    return distance / maxVelocity + maxVelocity / maxAcceleration;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
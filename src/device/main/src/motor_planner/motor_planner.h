@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * @file        motor_planner.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Velocity and acceleration limited servo trajectories.
+ *              A periodic esp_timer moves every motor towards its target along a
+ *              trapezoidal profile and updates the LEDC duty on each step, so the
+ *              servos never get a full range jump and its current spike.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef MOTOR_PLANNER_H
+#define MOTOR_PLANNER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "../motor_control/motor_control.h"
+#include "../logging/logging_utils.h"
+
+// Profile update period, 100 Hz
+#define MOTOR_PLANNER_PERIOD_US 10000
+
+// Steps longer than this, after a late timer callback, are cut to it
+#define MOTOR_PLANNER_MAX_STEP_US (4 * MOTOR_PLANNER_PERIOD_US)
+
+// Number of motors driven by the planner
+#define MOTOR_PLANNER_AXES 2
+
+/**
+ * @brief Starts the planner timer. The motors start at their current angle.
+ * Must be called after initialize_motors().
+ *
+ * @return ESP_OK, or the esp_timer error.
+ */
+esp_err_t init_motor_planner(void);
+
+/**
+ * @brief Sets the angle a motor moves to, replacing any move in progress.
+ * The motor keeps its current velocity and slows down or turns around within
+ * the given acceleration, overshooting a target too close to stop at. Only an
+ * overshoot past 0 or SERVO_MAX_ANGLE stops it at once, at the end of the range.
+ *
+ * @param motor            motor1 or motor2.
+ * @param angle            Target in degrees, clamped to 0..SERVO_MAX_ANGLE.
+ * @param maxVelocity      Speed limit in degrees per second.
+ * @param maxAcceleration  Acceleration limit in degrees per second squared.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown motor or a limit <= 0.
+ */
+esp_err_t motor_planner_set_target(Motor *motor, float angle, float maxVelocity, float maxAcceleration);
+
+/**
+ * @brief Returns true once a motor reached its target and stopped.
+ */
+bool motor_planner_is_idle(const Motor *motor);
+
+/**
+ * @brief Duration of a move that starts and ends at rest.
+ *
+ * @param distance         Degrees to travel.
+ * @param maxVelocity      Speed limit in degrees per second.
+ * @param maxAcceleration  Acceleration limit in degrees per second squared.
+ * @return Seconds, 0 if a limit is <= 0.
+ */
+float motor_planner_travel_time(float distance, float maxVelocity, float maxAcceleration);
+
+#endif  // MOTOR_PLANNER_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
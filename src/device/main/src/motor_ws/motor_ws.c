@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * @file        motor_ws.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../motor_ws/motor_ws.h"
+
+// Connection of the last command, written by the HTTP server task before queueing it
+static httpd_handle_t wsServer;
+static int wsFd = -1;
+
+// Applied angles waiting to be echoed, angle1 in the upper half
+static atomic_uint_least32_t echoAngles;
+static atomic_bool echoQueued;
+
+static uint16_t read_angle(const uint8_t *bytes)
+{
+    uint16_t tenths = bytes[0] | (bytes[1] << 8);
+    return tenths > MOTOR_WS_MAX_ANGLE ? MOTOR_WS_MAX_ANGLE : tenths;
+}
+
+static void write_angle(uint8_t *bytes, uint16_t tenths)
+{
+    bytes[0] = tenths & 0xFF;
+    bytes[1] = tenths >> 8;
+}
+
+// Runs in the HTTP server task
+static void send_echo(void *arg)
+{
+    (void)arg;
+
+    // Cleared first, an echo posted while sending queues a new send
+    atomic_store(&echoQueued, false);
+    uint32_t packed = atomic_load(&echoAngles);
+
+    if (wsFd < 0 || httpd_ws_get_fd_info(wsServer, wsFd) != HTTPD_WS_CLIENT_WEBSOCKET)
+    {
+        wsFd = -1;
+        return;
+    }
+
+    uint8_t payload[MOTOR_WS_FRAME_SIZE];
+    write_angle(payload, packed >> 16);
+    write_angle(payload + 2, packed & 0xFFFF);
+
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_BINARY,
+        .payload = payload,
+        .len = sizeof(payload)
+    };
+    if (httpd_ws_send_frame_async(wsServer, wsFd, &frame) != ESP_OK)
+    {
+        ESP_LOGW(MOTOR_TAG, "Motor control client gone");
+        wsFd = -1;
+    }
+}
+
+esp_err_t motor_ws_httpd_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET)
+    {
+        // Handshake, the only request that carries the headers
+        if (authenticateUser(req) != ROLE_ADMIN)
+        {
+            httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Insufficient permissions");
+            return ESP_FAIL;
+        }
+        ESP_LOGI(MOTOR_TAG, "Motor control client connected");
+        return ESP_OK;
+    }
+
+    uint8_t payload[MOTOR_WS_FRAME_SIZE];
+    httpd_ws_frame_t frame = {0};
+
+    // Read the length first, the payload is only read when it fits
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if (frame.len > sizeof(payload))
+    {
+        ESP_LOGW(MOTOR_TAG, "Motor frame of %u bytes, closing", (unsigned)frame.len);
+        return ESP_FAIL;
+    }
+    if (frame.len > 0)
+    {
+        frame.payload = payload;
+        err = httpd_ws_recv_frame(req, &frame, sizeof(payload));
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+    if (frame.type != HTTPD_WS_TYPE_BINARY || frame.len != MOTOR_WS_FRAME_SIZE)
+    {
+        return ESP_OK;
+    }
+
+    wsServer = req->handle;
+    wsFd = httpd_req_to_sockfd(req);
+
+    MotorAngles_t angles = {
+        .angle1 = read_angle(payload),
+        .angle2 = read_angle(payload + 2)
+    };
+
+    // One item queue, replaces a command the admin task did not take yet
+    xQueueOverwrite(motorAnglesQueue, &angles);
+    return ESP_OK;
+}
+
+void motor_ws_echo(const MotorAngles_t *applied)
+{
+    atomic_store(&echoAngles, ((uint32_t)applied->angle1 << 16) | applied->angle2);
+
+    // A send already queued will pick up the new angles
+    if (wsServer != NULL && !atomic_exchange(&echoQueued, true))
+    {
+        if (httpd_queue_work(wsServer, send_echo, NULL) != ESP_OK)
+        {
+            atomic_store(&echoQueued, false);
+        }
+    }
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
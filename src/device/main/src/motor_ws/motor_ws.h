@@ -0,0 +1,56 @@
+/*******************************************************************************
+ * @file        motor_ws.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       WebSocket channel for interactive motor control.
+ *              Each binary frame carries both target angles. Commands go to the
+ *              motor admin task through a one item queue, so a newer command
+ *              replaces one that was not applied yet, and the applied angles are
+ *              sent back to the client that sent the last command.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef MOTOR_WS_H
+#define MOTOR_WS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <esp_http_server.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "../user_roles/user_roles.h"
+#include "../logging/logging_utils.h"
+#include "../task_utils/task_utils.h"
+
+// Frame layout, both ways: angle1 then angle2, uint16 little endian in tenths of a degree
+#define MOTOR_WS_FRAME_SIZE 4
+
+// Larger angles received are clamped to this, in tenths of a degree
+#define MOTOR_WS_MAX_ANGLE (SERVO_MAX_ANGLE * 10)
+
+/**
+ * @brief       WebSocket handler of /ws/motor.
+ * @details     The handshake requires the admin role. Every following binary frame
+ *              of MOTOR_WS_FRAME_SIZE bytes replaces the pending motor command,
+ *              other frames are ignored.
+ * @param[in]   req The HTTP request object.
+ * @return      ESP_OK, or an error to close the connection.
+ */
+esp_err_t motor_ws_httpd_handler(httpd_req_t *req);
+
+/**
+ * @brief Sends the applied angles to the last command sender. Called by the motor
+ *        admin task, the frame is sent from the HTTP server task. If several
+ *        echoes are pending only the latest is sent.
+ *
+ * @param applied Angles the motors were moved to, in tenths of a degree.
+ */
+void motor_ws_echo(const MotorAngles_t *applied);
+
+#endif  // MOTOR_WS_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
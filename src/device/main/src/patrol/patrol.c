@@ -0,0 +1,327 @@
+/*******************************************************************************
+ * @file        patrol.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../patrol/patrol.h"
+
+// Defined in motor_control.c
+extern Motor motor1;
+extern Motor motor2;
+
+/**
+ * @brief Step of the visit of a preset.
+ */
+typedef enum
+{
+    PATROL_START,       /*< The move to the preset was not requested yet */
+    PATROL_MOVING,      /*< The planner moves the head to the preset     */
+    PATROL_SETTLING,    /*< Arrived, waiting PATROL_SETTLE_TIME          */
+    PATROL_DWELLING     /*< Waiting the dwell time of the preset         */
+} PatrolState_t;
+
+static PatrolPreset_t presets[PATROL_MAX_PRESETS];
+static size_t presetCount;
+static bool presetsChanged;
+static PatrolCapture_t captures[PATROL_MAX_PRESETS];
+static SemaphoreHandle_t patrolMutex;   // Protects presets, presetCount, presetsChanged and captures
+
+// Only used by the motor default control task
+static PatrolState_t state = PATROL_START;
+static size_t current;
+static TickType_t deadline;
+
+static bool valid_preset(const PatrolPreset_t *preset)
+{
+    return preset->pan <= SERVO_MAX_ANGLE * 10 && preset->tilt <= SERVO_MAX_ANGLE * 10 &&
+           preset->capture <= 1 && preset->reserved == 0;
+}
+
+static bool deadline_passed(void)
+{
+    return (int32_t)(xTaskGetTickCount() - deadline) >= 0;
+}
+
+esp_err_t init_patrol(void)
+{
+    patrolMutex = xSemaphoreCreateMutex();
+    if (patrolMutex == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    nvs_handle_t handle;
+    if (nvs_open(PATROL_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    {
+        // Nothing was ever saved
+        return ESP_OK;
+    }
+
+    size_t length = sizeof(presets);
+    esp_err_t err = nvs_get_blob(handle, PATROL_NVS_KEY, presets, &length);
+    nvs_close(handle);
+
+    if (err == ESP_OK && length % sizeof(PatrolPreset_t) == 0)
+    {
+        presetCount = length / sizeof(PatrolPreset_t);
+        for (size_t i = 0; i < presetCount; i++)
+        {
+            if (!valid_preset(&presets[i]))
+            {
+                ESP_LOGW(PATROL_TAG, "Saved preset %u is invalid, patrol disabled", (unsigned)i);
+                presetCount = 0;
+                break;
+            }
+        }
+    }
+    else if (err != ESP_ERR_NVS_NOT_FOUND)
+    {
+        ESP_LOGW(PATROL_TAG, "Failed to load presets: %s", esp_err_to_name(err));
+    }
+
+    ESP_LOGI(PATROL_TAG, "%u patrol presets loaded", (unsigned)presetCount);
+    return ESP_OK;
+}
+
+static esp_err_t save_presets(const PatrolPreset_t *list, size_t count)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(PATROL_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    if (count > 0)
+    {
+        err = nvs_set_blob(handle, PATROL_NVS_KEY, list, count * sizeof(PatrolPreset_t));
+    }
+    else
+    {
+        err = nvs_erase_key(handle, PATROL_NVS_KEY);
+        if (err == ESP_ERR_NVS_NOT_FOUND)
+        {
+            err = ESP_OK;
+        }
+    }
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+
+    nvs_close(handle);
+    return err;
+}
+
+esp_err_t patrol_set_presets(const PatrolPreset_t *list, size_t count)
+{
+    if (count > PATROL_MAX_PRESETS || (count > 0 && list == NULL))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!valid_preset(&list[i]))
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    esp_err_t err = save_presets(list, count);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(PATROL_TAG, "Failed to save presets: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    xSemaphoreTake(patrolMutex, portMAX_DELAY);
+    if (count > 0)
+    {
+        memcpy(presets, list, count * sizeof(PatrolPreset_t));
+    }
+    presetCount = count;
+    presetsChanged = true;
+
+    // Frames of the old list would be served for the wrong zone
+    for (int i = 0; i < PATROL_MAX_PRESETS; i++)
+    {
+        captures[i].count = 0;
+    }
+    xSemaphoreGive(patrolMutex);
+
+    ESP_LOGI(PATROL_TAG, "%u patrol presets set", (unsigned)count);
+    return ESP_OK;
+}
+
+size_t patrol_get_presets(PatrolPreset_t *out, size_t max)
+{
+    xSemaphoreTake(patrolMutex, portMAX_DELAY);
+    size_t count = presetCount < max ? presetCount : max;
+    memcpy(out, presets, count * sizeof(PatrolPreset_t));
+    xSemaphoreGive(patrolMutex);
+
+    return count;
+}
+
+static void move_to(const PatrolPreset_t *preset)
+{
+    if (is_motor_active(&motor1))
+    {
+        motor_planner_set_target(&motor1, preset->pan / 10.0f, PATROL_VELOCITY, PATROL_ACCELERATION);
+    }
+    if (is_motor_active(&motor2))
+    {
+        motor_planner_set_target(&motor2, preset->tilt / 10.0f, PATROL_VELOCITY, PATROL_ACCELERATION);
+    }
+}
+
+// Keep the first frame whose capture started after the head settled
+static void keep_frame(size_t index)
+{
+    uint32_t seq = 0;
+
+    // Skip the latest frame, it may have been exposed while the head moved
+    camera_fb_t *fb = camera_frame_acquire_next(&seq, 0);
+    if (fb)
+    {
+        camera_frame_release(fb);
+    }
+
+    fb = camera_frame_acquire_next(&seq, PATROL_CAPTURE_TIMEOUT);
+    if (!fb)
+    {
+        ESP_LOGW(PATROL_TAG, "No frame at preset %u", (unsigned)index);
+        return;
+    }
+
+    xSemaphoreTake(patrolMutex, portMAX_DELAY);
+    PatrolCapture_t *capture = &captures[index];
+    if (capture->readers > 0)
+    {
+        ESP_LOGW(PATROL_TAG, "Frame of preset %u is being read, not replaced", (unsigned)index);
+    }
+    else
+    {
+        if (capture->capacity < fb->len)
+        {
+            uint8_t *buf = heap_caps_realloc(capture->buf, fb->len, MALLOC_CAP_SPIRAM);
+            if (buf != NULL)
+            {
+                capture->buf = buf;
+                capture->capacity = fb->len;
+            }
+        }
+
+        if (capture->capacity >= fb->len)
+        {
+            memcpy(capture->buf, fb->buf, fb->len);
+            capture->len = fb->len;
+            capture->timestamp = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+            capture->count++;
+        }
+        else
+        {
+            ESP_LOGE(PATROL_TAG, "No memory for the frame of preset %u", (unsigned)index);
+        }
+    }
+    xSemaphoreGive(patrolMutex);
+
+    camera_frame_release(fb);
+}
+
+bool patrol_update(bool restart)
+{
+    PatrolPreset_t preset;
+
+    xSemaphoreTake(patrolMutex, portMAX_DELAY);
+    if (presetsChanged)
+    {
+        presetsChanged = false;
+        current = 0;
+        restart = true;
+    }
+    size_t count = presetCount;
+    if (current >= count)
+    {
+        current = 0;
+    }
+    preset = presets[current];
+    xSemaphoreGive(patrolMutex);
+
+    if (count == 0)
+    {
+        return false;
+    }
+
+    if (restart)
+    {
+        state = PATROL_START;
+    }
+
+    switch (state)
+    {
+        case PATROL_START:
+            move_to(&preset);
+            state = PATROL_MOVING;
+            break;
+
+        case PATROL_MOVING:
+            if (motor_planner_is_idle(&motor1) && motor_planner_is_idle(&motor2))
+            {
+                deadline = xTaskGetTickCount() + PATROL_SETTLE_TIME;
+                state = PATROL_SETTLING;
+            }
+            break;
+
+        case PATROL_SETTLING:
+            if (deadline_passed())
+            {
+                if (preset.capture)
+                {
+                    keep_frame(current);
+                }
+                deadline = xTaskGetTickCount() + pdMS_TO_TICKS(preset.dwellMs);
+                state = PATROL_DWELLING;
+            }
+            break;
+
+        case PATROL_DWELLING:
+            if (deadline_passed())
+            {
+                current = (current + 1) % count;
+                state = PATROL_START;
+            }
+            break;
+    }
+
+    return true;
+}
+
+PatrolCapture_t *patrol_capture_acquire(uint8_t preset)
+{
+    PatrolCapture_t *capture = NULL;
+
+    xSemaphoreTake(patrolMutex, portMAX_DELAY);
+    if (preset < presetCount && captures[preset].count > 0)
+    {
+        capture = &captures[preset];
+        capture->readers++;
+    }
+    xSemaphoreGive(patrolMutex);
+
+    return capture;
+}
+
+void patrol_capture_release(PatrolCapture_t *capture)
+{
+    xSemaphoreTake(patrolMutex, portMAX_DELAY);
+    capture->readers--;
+    xSemaphoreGive(patrolMutex);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
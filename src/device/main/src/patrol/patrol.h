@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * @file        patrol.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Patrol of the pan-tilt head through a list of presets.
+ *              The presets are kept in NVS. At each one the head waits until it
+ *              settled, optionally keeps a frame, dwells and moves to the next.
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef PATROL_H
+#define PATROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "../camera/camera_utils.h"
+#include "../motor_control/motor_control.h"
+#include "../motor_planner/motor_planner.h"
+#include "../logging/logging_utils.h"
+
+// Presets held at once
+#define PATROL_MAX_PRESETS 16
+
+// NVS location of the preset list
+#define PATROL_NVS_NAMESPACE "patrol"
+#define PATROL_NVS_KEY "presets"
+
+// Limits of the moves between presets
+#define PATROL_VELOCITY 120.0f        // Degrees per second
+#define PATROL_ACCELERATION 360.0f    // Degrees per second squared
+
+// Time for the head to stop shaking once the planner reached the preset
+#define PATROL_SETTLE_TIME pdMS_TO_TICKS(150)
+
+// Time to wait for the first frame started after the head settled
+#define PATROL_CAPTURE_TIMEOUT pdMS_TO_TICKS(500)
+
+/**
+ * @brief One stop of the patrol. Stored in NVS as is.
+ */
+typedef struct
+{
+    uint16_t pan;        /*< Motor 1 angle, tenths of a degree            */
+    uint16_t tilt;       /*< Motor 2 angle, tenths of a degree            */
+    uint16_t dwellMs;    /*< Time spent at the preset once settled        */
+    uint8_t capture;     /*< Keep the first frame taken once settled      */
+    uint8_t reserved;    /*< Always 0                                     */
+} PatrolPreset_t;
+
+/**
+ * @brief Latest frame kept at a preset.
+ */
+typedef struct
+{
+    uint8_t *buf;        /*< JPEG data in PSRAM                            */
+    size_t len;          /*< Bytes used in buf                             */
+    size_t capacity;     /*< Bytes allocated for buf                       */
+    int64_t timestamp;   /*< Capture time of the frame in microseconds     */
+    uint32_t count;      /*< Frames kept since the list was set, 0 for none */
+    uint8_t readers;     /*< Borrowers, the slot is not overwritten meanwhile */
+} PatrolCapture_t;
+
+/**
+ * @brief Loads the presets saved in NVS. An empty list leaves the motors to the
+ *        default sweep.
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the mutex cannot be created.
+ */
+esp_err_t init_patrol(void);
+
+/**
+ * @brief Replaces the preset list, saves it to NVS and restarts the patrol at
+ *        the first preset. Kept frames are dropped.
+ *
+ * @param presets Angles up to SERVO_MAX_ANGLE * 10, reserved set to 0.
+ * @param count   0 to PATROL_MAX_PRESETS, 0 stops the patrol.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a bad preset, or the NVS error.
+ */
+esp_err_t patrol_set_presets(const PatrolPreset_t *presets, size_t count);
+
+/**
+ * @brief Copies the current preset list.
+ *
+ * @return Number of presets copied.
+ */
+size_t patrol_get_presets(PatrolPreset_t *out, size_t max);
+
+/**
+ * @brief Advances the patrol. Called periodically by the motor default control
+ *        task, which runs the default sweep instead when this returns false.
+ *
+ * @param restart Start over at the current preset, after the motors were moved
+ *                by someone else.
+ * @return true if a patrol is running.
+ */
+bool patrol_update(bool restart);
+
+/**
+ * @brief Borrows the frame last kept at a preset. Must be given back with
+ *        patrol_capture_release().
+ *
+ * @return The capture, or NULL if no frame was kept at the preset.
+ */
+PatrolCapture_t *patrol_capture_acquire(uint8_t preset);
+
+/**
+ * @brief Gives back a capture obtained with patrol_capture_acquire().
+ */
+void patrol_capture_release(PatrolCapture_t *capture);
+
+#endif  // PATROL_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
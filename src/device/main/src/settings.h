@@ -16,9 +16,21 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
+// Both can be overridden from the compiler command line (the host build
+// disables them)
+#ifndef ENABLE_BLE
 #define ENABLE_BLE 0 // Change this to 1 to enable BLE functionality
+#endif
 
+#ifndef ENABLE_BT
 #define ENABLE_BT 1 // Change this to 1 to enable BT functionality
+#endif
+
+// Log lines are sent as binary records decoded on the host by log_decode,
+// see log_codec.h. Lines that cannot be encoded are still sent as text.
+#ifndef ENABLE_BINARY_LOG
+#define ENABLE_BINARY_LOG 0 // Change this to 1 to enable the binary log
+#endif
 
 #endif /* SETTINGS_H */
 
@@ -8,28 +8,56 @@
  *
  *******************************************************************************/
 #include "../task_utils/task_utils.h"
+#include "../motor_ws/motor_ws.h"
 
 BaseType_t result;         // Define result globally
 
 TaskHandle_t motorAdminTask;    // Define task globally
 TaskHandle_t motorDefaultTask;  // Define task globally
+TaskHandle_t cameraCaptureTask; // Define task globally
+TaskHandle_t motionCaptureTask; // Define task globally
+TaskHandle_t hazeDetectTask;    // Define task globally
+TaskHandle_t classifierTask;    // Define task globally
+TaskHandle_t gpioEventTask;     // Define task globally
+TaskHandle_t eventStreamTask;   // Define task globally
+TaskHandle_t logSinkTask;       // Define task globally
 
 #if ENABLE_BLE
 TaskHandle_t bleNotificationTask;  // Define task globally
 #endif
 
-SemaphoreHandle_t motor1Mutex;
-SemaphoreHandle_t motor2Mutex;
-
 QueueHandle_t motorAnglesQueue;
 
 TaskParams_t taskParams;   // Define taskParams globally
 
+/**
+ * @brief Debounce state of a pin handled by the GPIO event task.
+ */
+typedef struct
+{
+    gpio_num_t gpio;                 /*< Input pin                                  */
+    void (*setState)(uint8_t state); /*< gpio_state setter of the pin               */
+    HistoryType_t historyType;       /*< Type of the pin records in sensorHistory   */
+    uint8_t level;                   /*< Last accepted level                        */
+    int64_t lastChange;              /*< esp_timer time of the last accepted change */
+    bool pending;                    /*< An edge was discarded as bounce            */
+} GpioInput_t;
+
+static GpioInput_t gpioInputs[] = {
+    {GPIO_PIR_SIGNAL, setPirState, HISTORY_PIR, 0, 0, false},
+    {GPIO_LDR, setLdrState, HISTORY_LDR, 0, 0, false},
+    {GPIO_SMOKE_SENSOR, setSmokeSensorState, HISTORY_SMOKE, 0, 0, false}
+};
+
+static GpioEventStats_t gpioEventStats;
+
+// Tick until which the default pattern leaves the motors to the admin task
+static volatile TickType_t manualHoldUntil;
+static volatile bool manualHold;
+
 void initialize_tasks(void)
 {
 	// Handle creation
-	motor1Mutex = xSemaphoreCreateMutex();
-	motor2Mutex = xSemaphoreCreateMutex();
 	// xQueueCreate(items in queue,  item's size in bytes)
 	motorAnglesQueue = xQueueCreate(MOTOR_ANGLES_QUEUE_ITEM_NUMBER, sizeof(MotorAngles_t));
 
@@ -38,15 +66,29 @@ void initialize_tasks(void)
 #if ENABLE_BLE
 	TaskInitParams_t const TaskInitParameters[] = {
 		// Pointer to the Task function, Task String Name, The task stack depth, Parameter Pointer, Task priority, Task Handle
-		{(TaskFunction_t)MotorAdminControlTask, "motor_admin_control_task", TASK_MOTOR_ADMIN_CONTROL_STACK_DEPTH, NULL, TASK_MOTOR_ADMIN_CONTROL_PRIORITY, &motorAdminTask, TASK_MOTOR_ADMIN_CONTROL_CORE},
+		{(TaskFunction_t)LogSinkTask, "log_sink_task", TASK_LOG_SINK_STACK_DEPTH, NULL, TASK_LOG_SINK_PRIORITY, &logSinkTask, TASK_LOG_SINK_CORE},
+		{(TaskFunction_t)GpioEventTask, "gpio_event_task", TASK_GPIO_EVENT_STACK_DEPTH, NULL, TASK_GPIO_EVENT_PRIORITY, &gpioEventTask, TASK_GPIO_EVENT_CORE},
+		{(TaskFunction_t)EventStreamTask, "event_stream_task", TASK_EVENT_STREAM_STACK_DEPTH, NULL, TASK_EVENT_STREAM_PRIORITY, &eventStreamTask, TASK_EVENT_STREAM_CORE},
+		{(TaskFunction_t)MotorAdminControlTask, "motor_admin_control_task", TASK_MOTOR_ADMIN_CONTROL_STACK_DEPTH, &taskParams, TASK_MOTOR_ADMIN_CONTROL_PRIORITY, &motorAdminTask, TASK_MOTOR_ADMIN_CONTROL_CORE},
 		{(TaskFunction_t)MotorDefaultControlTask, "motor_default_control_task", TASK_MOTOR_DEFAULT_CONTROL_STACK_DEPTH, NULL, TASK_MOTOR_DEFAULT_CONTROL_PRIORITY, &motorDefaultTask, TASK_MOTOR_DEFAULT_CONTROL_CORE},
+		{(TaskFunction_t)CameraCaptureTask, "camera_capture_task", TASK_CAMERA_CAPTURE_STACK_DEPTH, NULL, TASK_CAMERA_CAPTURE_PRIORITY, &cameraCaptureTask, TASK_CAMERA_CAPTURE_CORE},
+		{(TaskFunction_t)MotionCaptureTask, "motion_capture_task", TASK_MOTION_CAPTURE_STACK_DEPTH, NULL, TASK_MOTION_CAPTURE_PRIORITY, &motionCaptureTask, TASK_MOTION_CAPTURE_CORE},
+		{(TaskFunction_t)HazeDetectTask, "haze_detect_task", TASK_HAZE_DETECT_STACK_DEPTH, NULL, TASK_HAZE_DETECT_PRIORITY, &hazeDetectTask, TASK_HAZE_DETECT_CORE},
+		{(TaskFunction_t)ClassifierTask, "classifier_task", TASK_CLASSIFIER_STACK_DEPTH, NULL, TASK_CLASSIFIER_PRIORITY, &classifierTask, TASK_CLASSIFIER_CORE},
         {(TaskFunction_t)BLENotificationTask, "ble_notification_task", TASK_BLE_NOTIFICATION_STACK_DEPTH, NULL, TASK_BLE_NOTIFICATION_PRIORITY, &bleNotificationTask, TASK_BLE_NOTIFICATION_CORE}
     };
 #else
 	TaskInitParams_t const TaskInitParameters[] = {
 		// Pointer to the Task function, Task String Name, The task stack depth, Parameter Pointer, Task priority, Task Handle
-		{(TaskFunction_t)MotorAdminControlTask, "motor_admin_control_task", TASK_MOTOR_ADMIN_CONTROL_STACK_DEPTH, NULL, TASK_MOTOR_ADMIN_CONTROL_PRIORITY, &motorAdminTask, TASK_MOTOR_ADMIN_CONTROL_CORE},
-		{(TaskFunction_t)MotorDefaultControlTask, "motor_default_control_task", TASK_MOTOR_DEFAULT_CONTROL_STACK_DEPTH, NULL, TASK_MOTOR_DEFAULT_CONTROL_PRIORITY, &motorDefaultTask, TASK_MOTOR_DEFAULT_CONTROL_CORE}
+		{(TaskFunction_t)LogSinkTask, "log_sink_task", TASK_LOG_SINK_STACK_DEPTH, NULL, TASK_LOG_SINK_PRIORITY, &logSinkTask, TASK_LOG_SINK_CORE},
+		{(TaskFunction_t)GpioEventTask, "gpio_event_task", TASK_GPIO_EVENT_STACK_DEPTH, NULL, TASK_GPIO_EVENT_PRIORITY, &gpioEventTask, TASK_GPIO_EVENT_CORE},
+		{(TaskFunction_t)EventStreamTask, "event_stream_task", TASK_EVENT_STREAM_STACK_DEPTH, NULL, TASK_EVENT_STREAM_PRIORITY, &eventStreamTask, TASK_EVENT_STREAM_CORE},
+		{(TaskFunction_t)MotorAdminControlTask, "motor_admin_control_task", TASK_MOTOR_ADMIN_CONTROL_STACK_DEPTH, &taskParams, TASK_MOTOR_ADMIN_CONTROL_PRIORITY, &motorAdminTask, TASK_MOTOR_ADMIN_CONTROL_CORE},
+		{(TaskFunction_t)MotorDefaultControlTask, "motor_default_control_task", TASK_MOTOR_DEFAULT_CONTROL_STACK_DEPTH, NULL, TASK_MOTOR_DEFAULT_CONTROL_PRIORITY, &motorDefaultTask, TASK_MOTOR_DEFAULT_CONTROL_CORE},
+		{(TaskFunction_t)CameraCaptureTask, "camera_capture_task", TASK_CAMERA_CAPTURE_STACK_DEPTH, NULL, TASK_CAMERA_CAPTURE_PRIORITY, &cameraCaptureTask, TASK_CAMERA_CAPTURE_CORE},
+		{(TaskFunction_t)MotionCaptureTask, "motion_capture_task", TASK_MOTION_CAPTURE_STACK_DEPTH, NULL, TASK_MOTION_CAPTURE_PRIORITY, &motionCaptureTask, TASK_MOTION_CAPTURE_CORE},
+		{(TaskFunction_t)HazeDetectTask, "haze_detect_task", TASK_HAZE_DETECT_STACK_DEPTH, NULL, TASK_HAZE_DETECT_PRIORITY, &hazeDetectTask, TASK_HAZE_DETECT_CORE},
+		{(TaskFunction_t)ClassifierTask, "classifier_task", TASK_CLASSIFIER_STACK_DEPTH, NULL, TASK_CLASSIFIER_PRIORITY, &classifierTask, TASK_CLASSIFIER_CORE}
     };
 #endif
 
@@ -68,6 +110,21 @@ void initialize_tasks(void)
     //ESP_LOGI(TASK_LOG_TAG, "Motor Tasks Initialized");
 }
 
+// Log the free stack of the calling task each time it reaches a new low under
+// TASK_STACK_MARGIN. lowest keeps the smallest high water mark seen so far.
+static void check_stack_margin(const char *taskName, UBaseType_t *lowest)
+{
+    UBaseType_t unused = uxTaskGetStackHighWaterMark(NULL);
+    if (unused < *lowest)
+    {
+        *lowest = unused;
+        if (unused < TASK_STACK_MARGIN)
+        {
+            ESP_LOGW(TASK_LOG_TAG, "%s has %u bytes of stack left", taskName, (unsigned)unused);
+        }
+    }
+}
+
 void MotorAdminControlTask(void *pvParameters)
 {
     TaskParams_t *params = (TaskParams_t *)pvParameters;
@@ -78,111 +135,352 @@ void MotorAdminControlTask(void *pvParameters)
         vTaskDelete(NULL);
     }
 
+    UBaseType_t lowestStack = UINT32_MAX;
+
     while (1)
     {
         MotorAngles_t angles;
         if (xQueueReceive((QueueHandle_t)params->motorAnglesQueue, &angles, portMAX_DELAY) == pdTRUE)
         {
-            // Acquire motor1Mutex before accessing MOTOR_1
-            xSemaphoreTake(motor1Mutex, portMAX_DELAY);
-            if (motor1.is_active)
+            manualHoldUntil = xTaskGetTickCount() + MOTOR_MANUAL_HOLD;
+            manualHold = true;
+
+            MotorAngles_t applied = angles;
+            MotorState state;
+
+            // Lock-free snapshot, the planner keeps writing the angle meanwhile
+            get_motor_state(&motor1, &state);
+            if (state.is_active)
             {
-                move_motor(&motor1, angles.angle1);
+                motor_planner_set_target(&motor1, angles.angle1 / 10.0f, MOTOR_MANUAL_VELOCITY, MOTOR_MANUAL_ACCELERATION);
+            }
+            else
+            {
+                applied.angle1 = state.angle * 10.0f + 0.5f;
             }
-            xSemaphoreGive(motor1Mutex);
 
-            // Acquire motor2Mutex before accessing MOTOR_2
-            xSemaphoreTake(motor2Mutex, portMAX_DELAY);
-            if (motor2.is_active)
+            get_motor_state(&motor2, &state);
+            if (state.is_active)
             {
-                move_motor(&motor2, angles.angle2);
+                motor_planner_set_target(&motor2, angles.angle2 / 10.0f, MOTOR_MANUAL_VELOCITY, MOTOR_MANUAL_ACCELERATION);
+            }
+            else
+            {
+                applied.angle2 = state.angle * 10.0f + 0.5f;
             }
-            xSemaphoreGive(motor2Mutex);
-        }
 
-        // Delay between iterations to control the task execution rate
-        vTaskDelay(pdMS_TO_TICKS(300));  // Delay for 100 milliseconds
+            // Echo the targets the planner now follows, an inactive motor keeps its angle
+            motor_ws_echo(&applied);
+            check_stack_margin("motor_admin_control_task", &lowestStack);
+        }
     }
     vTaskDelete(NULL);
 }
 
+// Add a motor angle to motorHistory when it moved by at least a tenth of a degree
+static void record_motor_angle(uint8_t motor, float angle, uint16_t *lastRecorded)
+{
+    uint16_t tenths = (uint16_t)(angle * 10.0f + 0.5f);
+    if (tenths != *lastRecorded)
+    {
+        history_push(&motorHistory, HISTORY_MOTOR, motor, tenths);
+        *lastRecorded = tenths;
+        events_notify();
+
+        #if ENABLE_BLE
+        ble_telemetry_changed(BLE_TELEMETRY_MOTORS);
+        #endif /* ENABLE_BLE */
+    }
+}
+
 void MotorDefaultControlTask(void *pvParameters)
 {
-    uint8_t angle = 0;
-    bool increasing = true;
-    double ewma_angle = 0.0;  // Exponentially Weighted Moving Average
+    float sweep_target = 0.0f;
+    uint16_t recorded_angle1 = UINT16_MAX;
+    uint16_t recorded_angle2 = UINT16_MAX;
+    uint32_t iteration = 0;
+    bool resume = false;
+    UBaseType_t lowestStack = UINT32_MAX;
 
     while (1)
     {
-        // Acquire motor1Mutex before accessing MOTOR_1
-        xSemaphoreTake(motor1Mutex, portMAX_DELAY);
-        if (motor1.is_active)
+        // Leave the motors where the admin put them, only record their angle
+        if (manualHold && (int32_t)(manualHoldUntil - xTaskGetTickCount()) <= 0)
+        {
+            manualHold = false;
+            resume = true;
+        }
+
+        if (manualHold)
+        {
+            // Nothing to move
+        }
+        else if (patrol_update(resume))
         {
-            move_motor(&motor1, ewma_angle);
-            set_motor_angle(&motor1, ewma_angle);
+            resume = false;
         }
-        xSemaphoreGive(motor1Mutex);
+        // Turn around once both motors reached the end of the sweep
+        else if (motor_planner_is_idle(&motor1) && motor_planner_is_idle(&motor2))
+        {
+            sweep_target = sweep_target > 0.0f ? 0.0f : SERVO_MAX_ANGLE;
+
+            if (is_motor_active(&motor1))
+            {
+                motor_planner_set_target(&motor1, sweep_target, MOTOR_SWEEP_VELOCITY, MOTOR_SWEEP_ACCELERATION);
+            }
+            if (is_motor_active(&motor2))
+            {
+                motor_planner_set_target(&motor2, sweep_target, MOTOR_SWEEP_VELOCITY, MOTOR_SWEEP_ACCELERATION);
+            }
+        }
+
+        // The planner moves the motors, sample where they are
+        if (iteration++ % MOTOR_RECORD_DIVIDER == 0)
+        {
+            record_motor_angle(1, get_motor_angle(&motor1), &recorded_angle1);
+            record_motor_angle(2, get_motor_angle(&motor2), &recorded_angle2);
+            check_stack_margin("motor_default_control_task", &lowestStack);
+        }
+
+        // Delay between iterations to control the task execution rate
+        vTaskDelay(MOTOR_DEFAULT_PERIOD);
+    }
+
+    vTaskDelete(NULL);
+}
+
+void CameraCaptureTask(void *pvParameters)
+{
+    while (1)
+    {
+        // Blocks until the sensor delivers a frame and a ring slot is free
+        if (camera_capture_frame() != ESP_OK)
+        {
+            ESP_LOGE(CAMERA_TAG, "Camera capture failed");
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+// Apply a debounced level to a pin and fan out the change
+static void apply_gpio_level(GpioInput_t *input, uint8_t level, int64_t timestamp)
+{
+    input->pending = false;
+    if (level == input->level)
+    {
+        return;
+    }
+    input->level = level;
+    input->lastChange = timestamp;
+    input->setState(level);
+    history_push(&sensorHistory, input->historyType, 0, level);
+    gpioEventStats.processed++;
+
+    switch (input->gpio)
+    {
+        case GPIO_LDR:
+            // setLdrState() already drove the LEDs, keep their state in sync
+            setLedState(level);
+            history_push(&sensorHistory, HISTORY_LED, 0, level);
+            break;
+        case GPIO_PIR_SIGNAL:
+            if (level == 1 && motionCaptureTask != NULL)
+            {
+                xTaskNotifyGive(motionCaptureTask);
+            }
+            break;
+        case GPIO_SMOKE_SENSOR:
+            ESP_LOGI(INTERRUPT_LOG_TAG, "Smoke sensor changed to %u", level);
+            break;
+    }
+
+    // Push the new records to the /events clients
+    events_notify();
+
+    #if ENABLE_BLE
+    ble_telemetry_changed(BLE_TELEMETRY_SENSORS);
+    #endif /* ENABLE_BLE */
+}
 
-        // Acquire motor2Mutex before accessing MOTOR_2
-        xSemaphoreTake(motor2Mutex, portMAX_DELAY);
-        if (motor2.is_active)
+static GpioInput_t *find_gpio_input(uint8_t gpio)
+{
+    for (size_t i = 0; i < sizeof(gpioInputs) / sizeof(gpioInputs[0]); i++)
+    {
+        if (gpioInputs[i].gpio == gpio)
         {
-            move_motor(&motor2, ewma_angle);
-            set_motor_angle(&motor2, ewma_angle);
+            return &gpioInputs[i];
         }
-        xSemaphoreGive(motor2Mutex);
+    }
+    return NULL;
+}
 
-        // Update the EWMA with the current angle change
-        ewma_angle = ALPHA * angle + (1 - ALPHA) * ewma_angle;
+void GpioEventTask(void *pvParameters)
+{
+    bool pending = false;
+    int64_t now = esp_timer_get_time();
 
-        if (ewma_angle >= THRESHOLD * angle)
+    // Start from the current pin levels
+    for (size_t i = 0; i < sizeof(gpioInputs) / sizeof(gpioInputs[0]); i++)
+    {
+        gpioInputs[i].level = gpio_get_level(gpioInputs[i].gpio);
+        gpioInputs[i].lastChange = now;
+        gpioInputs[i].setState(gpioInputs[i].level);
+        history_push(&sensorHistory, gpioInputs[i].historyType, 0, gpioInputs[i].level);
+    }
+
+    while (1)
+    {
+        GpioEvent_t event;
+        // While an edge is held back as bounce, wake up to read the settled level
+        TickType_t wait = pending ? pdMS_TO_TICKS(GPIO_DEBOUNCE_US / 1000) : portMAX_DELAY;
+
+        if (xQueueReceive(gpioEventQueue, &event, wait) == pdTRUE)
         {
-            if (increasing)
+            now = esp_timer_get_time();
+            gpioEventStats.lastLatencyUs = (uint32_t)(now - event.timestamp);
+            if (gpioEventStats.lastLatencyUs > gpioEventStats.maxLatencyUs)
+            {
+                gpioEventStats.maxLatencyUs = gpioEventStats.lastLatencyUs;
+            }
+
+            GpioInput_t *input = find_gpio_input(event.gpio);
+            if (input == NULL)
             {
-                if (angle < SERVO_MAX_ANGLE)
-                    angle++;
-                else
-                    increasing = false;
+                continue;
+            }
+
+            // 64-bit times, an edge hours after the last change is never taken for bounce
+            if (event.timestamp - input->lastChange < GPIO_DEBOUNCE_US)
+            {
+                input->pending = true;
+                pending = true;
+                gpioEventStats.bounced++;
             }
             else
             {
-                if (angle > 0)
-                    angle--;
-                else
-                    increasing = true;
+                apply_gpio_level(input, event.level, event.timestamp);
             }
         }
+        else
+        {
+            // The pins settled, take whatever level they ended on
+            now = esp_timer_get_time();
+            pending = false;
+            for (size_t i = 0; i < sizeof(gpioInputs) / sizeof(gpioInputs[0]); i++)
+            {
+                if (gpioInputs[i].pending)
+                {
+                    apply_gpio_level(&gpioInputs[i], gpio_get_level(gpioInputs[i].gpio), now);
+                }
+            }
+        }
+    }
+    vTaskDelete(NULL);
+}
 
-        // Delay between iterations to control the task execution rate
-        vTaskDelay(pdMS_TO_TICKS(1000));  // Delay for 1000 milliseconds
+void get_gpio_event_stats(GpioEventStats_t *stats)
+{
+    *stats = gpioEventStats;
+    stats->dropped = get_gpio_events_dropped();
+}
+
+void EventStreamTask(void *pvParameters)
+{
+    while (1)
+    {
+        // Woken by events_notify(), or times out to keep idle connections checked
+        ulTaskNotifyTake(pdTRUE, EVENTS_KEEPALIVE_INTERVAL);
+        events_dispatch();
     }
+    vTaskDelete(NULL);
+}
 
+void MotionCaptureTask(void *pvParameters)
+{
+    while (1)
+    {
+        // Sleep until the PIR interrupt notifies a rising edge
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        motion_capture_burst();
+
+        // Keep checking while something is still moving in front of the sensor
+        while (getPirState())
+        {
+            vTaskDelay(MOTION_BURST_INTERVAL);
+            motion_capture_burst();
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+void HazeDetectTask(void *pvParameters)
+{
+    while (1)
+    {
+        haze_check_frame();
+        vTaskDelay(HAZE_CHECK_PERIOD);
+    }
+    vTaskDelete(NULL);
+}
+
+void ClassifierTask(void *pvParameters)
+{
+    ClassifierStatus_t status;
+    classifier_get_status(&status);
+
+    // Nothing to run without a model
+    if (!status.ready)
+    {
+        vTaskDelete(NULL);
+    }
+
+    while (1)
+    {
+        classifier_check_frame();
+        vTaskDelay(CLASSIFIER_PERIOD);
+    }
+    vTaskDelete(NULL);
+}
+
+void LogSinkTask(void *pvParameters)
+{
+    while (1)
+    {
+        // Woken early when the ring is half full, otherwise flush periodically
+        ulTaskNotifyTake(pdTRUE, LOG_SINK_FLUSH_PERIOD);
+        log_sink_drain();
+    }
     vTaskDelete(NULL);
 }
 
 #if ENABLE_BLE
-void BLENotificationTask(void *pvParameters) // For sending notifications periodically as freetos task(after setting value of variable"notification")
+void BLENotificationTask(void *pvParameters)
 {
-  int rc;
-  struct os_mbuf *om;
+  TickType_t lastSystem = xTaskGetTickCount();
+
   while (1)
   {
-    if (notify_state) // This value is checked so that we don't send notifications if no one has subscribed to our notification handle.
-    {
-      om = ble_hs_mbuf_from_flat(notification, sizeof(notification));
-      rc = ble_gatts_notify_custom(conn_handle, notification_handle, om);
-      //ESP_LOGI(BLE_TAG,"rc=%d\n", rc);
+    // Sleep until the notification or the telemetry changes, or the system characteristic is due
+    TickType_t elapsed = xTaskGetTickCount() - lastSystem;
+    TickType_t wait = elapsed < BLE_TELEMETRY_SYSTEM_PERIOD ? BLE_TELEMETRY_SYSTEM_PERIOD - elapsed : 0;
 
-      if (rc != 0)
-      {
-        ESP_LOGE(BLE_TAG,"Error notifying; rc\n");
-      }
+    if (ulTaskNotifyTake(pdTRUE, wait) > 0)
+    {
+      // Let the writes close to this one join the same notification
+      vTaskDelay(BLE_NOTIFY_COALESCE);
     }
-    else
+
+    if (xTaskGetTickCount() - lastSystem >= BLE_TELEMETRY_SYSTEM_PERIOD)
     {
-      ESP_LOGI(BLE_TAG,"No one subscribed to notifications\n");
+      lastSystem = xTaskGetTickCount();
+      ble_telemetry_changed(BLE_TELEMETRY_SYSTEM);
     }
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    sendNotification();
+    ble_telemetry_send();
   }
   vTaskDelete(NULL);
 }
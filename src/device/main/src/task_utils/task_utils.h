@@ -12,22 +12,70 @@
 #include "stdio.h"
 #include "esp_task_wdt.h"
 #include "../motor_control/motor_control.h"
+#include "../motor_planner/motor_planner.h"
+#include "../patrol/patrol.h"
+#include "../camera/camera_utils.h"
+#include "../motion/motion_detection.h"
+#include "../haze/haze_detector.h"
+#include "../classifier/classifier.h"
+#include "../gpio_state/gpio_state.h"
+#include "../gpio_interrupts/gpio_interrupts.h"
+#include "../history/history.h"
+#include "../events/events.h"
 #include "../logging/logging_utils.h"
+#include "../log_sink/log_sink.h"
 
 #ifdef ENABLE_BLE
 #include "../ble_utils/ble_utils.h"
 #endif
 
 // Define the stack depth and priority for the Admin Control Task
-#define TASK_MOTOR_ADMIN_CONTROL_STACK_DEPTH configMINIMAL_STACK_SIZE 
+// The WebSocket echo goes through httpd_queue_work() and lwIP from this task
+#define TASK_MOTOR_ADMIN_CONTROL_STACK_DEPTH 1024*3
 #define TASK_MOTOR_ADMIN_CONTROL_PRIORITY tskIDLE_PRIORITY+10
 #define TASK_MOTOR_ADMIN_CONTROL_CORE 1
 
 // Define the stack depth and priority for the Default Control Task
-#define TASK_MOTOR_DEFAULT_CONTROL_STACK_DEPTH configMINIMAL_STACK_SIZE 
+// The patrol keeps frames (camera ring, PSRAM realloc) and logs from this task
+#define TASK_MOTOR_DEFAULT_CONTROL_STACK_DEPTH 1024*3
 #define TASK_MOTOR_DEFAULT_CONTROL_PRIORITY tskIDLE_PRIORITY+10
 #define TASK_MOTOR_DEFAULT_CONTROL_CORE 1
 
+// Define the stack depth and priority for the Camera Capture Task
+#define TASK_CAMERA_CAPTURE_STACK_DEPTH 1024*3
+#define TASK_CAMERA_CAPTURE_PRIORITY tskIDLE_PRIORITY+5
+#define TASK_CAMERA_CAPTURE_CORE 1
+
+// Define the stack depth and priority for the GPIO Event Task
+#define TASK_GPIO_EVENT_STACK_DEPTH 1024*3
+#define TASK_GPIO_EVENT_PRIORITY tskIDLE_PRIORITY+12
+#define TASK_GPIO_EVENT_CORE 0
+
+// Define the stack depth and priority for the Event Stream Task
+#define TASK_EVENT_STREAM_STACK_DEPTH 1024*4
+#define TASK_EVENT_STREAM_PRIORITY tskIDLE_PRIORITY+6
+#define TASK_EVENT_STREAM_CORE 0
+
+// Define the stack depth and priority for the Motion Capture Task
+#define TASK_MOTION_CAPTURE_STACK_DEPTH 1024*4
+#define TASK_MOTION_CAPTURE_PRIORITY tskIDLE_PRIORITY+4
+#define TASK_MOTION_CAPTURE_CORE 1
+
+// Define the stack depth and priority for the Haze Detect Task
+#define TASK_HAZE_DETECT_STACK_DEPTH 1024*3
+#define TASK_HAZE_DETECT_PRIORITY tskIDLE_PRIORITY+3
+#define TASK_HAZE_DETECT_CORE 1
+
+// Define the stack depth and priority for the Classifier Task, below the haze detect task
+#define TASK_CLASSIFIER_STACK_DEPTH 1024*3
+#define TASK_CLASSIFIER_PRIORITY tskIDLE_PRIORITY+2
+#define TASK_CLASSIFIER_CORE 1
+
+// Define the stack depth and priority for the Log Sink Task, below every other task
+#define TASK_LOG_SINK_STACK_DEPTH 1024*3
+#define TASK_LOG_SINK_PRIORITY tskIDLE_PRIORITY+1
+#define TASK_LOG_SINK_CORE 0
+
 #if ENABLE_BLE
 // Define the stack depth and priority for the BLE Notification Task
 #define TASK_BLE_NOTIFICATION_STACK_DEPTH 1024*5 
@@ -35,16 +83,38 @@
 #define TASK_BLE_NOTIFICATION_CORE 0
 #endif /* ENABLE_BLE */
 
-#define MOTOR_ANGLES_QUEUE_ITEM_NUMBER 10  
+// A single slot: a new command overwrites the one not applied yet
+#define MOTOR_ANGLES_QUEUE_ITEM_NUMBER 1
+
+// The default pattern is paused for this long after the last admin command
+#define MOTOR_MANUAL_HOLD pdMS_TO_TICKS(10000)
 
-#define ALPHA 0.1 // Smoothing factor for the EWMA
-#define THRESHOLD 0.9 // Threshold for comparing with angle
+// Free stack, in bytes, under which the motor tasks log each new low
+#define TASK_STACK_MARGIN 512
+
+// Edges closer than this to the last accepted change of a pin are treated as bounce
+#define GPIO_DEBOUNCE_US 50000
+
+// Default pattern: both motors sweep end to end, a full sweep takes
+// motor_planner_travel_time(SERVO_MAX_ANGLE, ...) = 3.5 s
+#define MOTOR_SWEEP_VELOCITY 60.0f        // Degrees per second
+#define MOTOR_SWEEP_ACCELERATION 120.0f   // Degrees per second squared
+
+// Limits of the moves requested by admins
+#define MOTOR_MANUAL_VELOCITY 180.0f       // Degrees per second
+#define MOTOR_MANUAL_ACCELERATION 720.0f   // Degrees per second squared
+
+// Period of the default control task, also the patrol arrival detection latency
+#define MOTOR_DEFAULT_PERIOD pdMS_TO_TICKS(20)
+
+// The motor angles are sampled into motorHistory every this many periods (200 ms)
+#define MOTOR_RECORD_DIVIDER 10
 
 //Struct to pass angles to Queue
 typedef struct
 {
-    uint8_t angle1;
-    uint8_t angle2;
+    uint16_t angle1;    /*< Tenths of a degree */
+    uint16_t angle2;    /*< Tenths of a degree */
 } MotorAngles_t;
 
 //Declare task params structure
@@ -53,6 +123,20 @@ typedef struct
     MotorAngles_t* motorAnglesQueue;
 } TaskParams_t;
 
+extern QueueHandle_t motorAnglesQueue;
+
+/**
+ * @brief Counters kept by the GPIO event task.
+ */
+typedef struct
+{
+    uint32_t processed;       /*< Edges that changed a pin state               */
+    uint32_t bounced;         /*< Edges discarded by the debounce              */
+    uint32_t dropped;         /*< Edges lost because the event queue was full  */
+    uint32_t lastLatencyUs;   /*< ISR to task latency of the last edge         */
+    uint32_t maxLatencyUs;    /*< Worst ISR to task latency seen since boot    */
+} GpioEventStats_t;
+
 /**
  * @brief Task configuration structure used to create a task configuration table.
  * Note: this is for dynamic memory allocation. We create all the tasks up front
@@ -76,8 +160,9 @@ typedef struct
 void initialize_tasks(void);
 
 /**
- * @brief Task  allows admins to control the motors freely through a REST API command.
- *        The motor angle is updated as requested and no longer follows the default pattern.
+ * @brief Task  allows admins to control the motors freely through the /ws/motor WebSocket.
+ *        The motor angle is updated as requested and no longer follows the default pattern
+ *        until MOTOR_MANUAL_HOLD passes without a command.
  * @note Admin user permissions are required to execute this function.
  * 
  * @param pvParameters Pointer to the task parameters.
@@ -86,20 +171,94 @@ void MotorAdminControlTask(void* pvParameters) __attribute__((noreturn));
 
 /**
  * @brief Task moves motor from HOME(MOTOR_1 and MOTOR_2 at 0) at a default pattern.
+ *        Runs the patrol when presets are set, otherwise both motors sweep
+ *        between 0 and SERVO_MAX_ANGLE through the motor planner.
  * 
  * @param pvParameters Pointer to the task parameters.
  */
 void MotorDefaultControlTask(void* pvParameters) __attribute__((noreturn));
 
+/**
+ * @brief Task keeps the shared frame ring filled with the latest camera frames.
+ *        HTTP handlers and other consumers borrow frames from it through
+ *        camera_frame_acquire() instead of reading the sensor themselves.
+ * 
+ * @param pvParameters Pointer to the task parameters.
+ */
+void CameraCaptureTask(void* pvParameters) __attribute__((noreturn));
+
+/**
+ * @brief Task processes the edges queued by the GPIO ISRs. It debounces them,
+ *        updates the sensor states, drives the LEDs from the LDR and wakes the
+ *        motion capture task on a PIR rising edge.
+ * 
+ * @param pvParameters Pointer to the task parameters.
+ */
+void GpioEventTask(void* pvParameters) __attribute__((noreturn));
+
+/**
+ * @brief Copies the GPIO event task counters.
+ * 
+ * @param stats Destination of the counters.
+ */
+void get_gpio_event_stats(GpioEventStats_t *stats);
+
+/**
+ * @brief Task pushes new sensor and motor history records to the /events clients.
+ *        It sleeps until events_notify() is called, or sends a keepalive after
+ *        EVENTS_KEEPALIVE_INTERVAL without any record.
+ * 
+ * @param pvParameters Pointer to the task parameters.
+ */
+void EventStreamTask(void* pvParameters) __attribute__((noreturn));
+
+/**
+ * @brief Task sleeps until the GPIO event task notifies it of a PIR rising edge,
+ *        then checks bursts of frames for motion for as long as the PIR output
+ *        stays high. Only frames that changed are kept, see motion_capture_burst().
+ * 
+ * @param pvParameters Pointer to the task parameters.
+ */
+void MotionCaptureTask(void* pvParameters) __attribute__((noreturn));
+
+/**
+ * @brief Task checks the latest frame for smoke or haze every HAZE_CHECK_PERIOD,
+ *        see haze_check_frame(). Its result gates uploads, see haze_gate_open().
+ * 
+ * @param pvParameters Pointer to the task parameters.
+ */
+void HazeDetectTask(void* pvParameters) __attribute__((noreturn));
+
+/**
+ * @brief Task classifies the latest frame every CLASSIFIER_PERIOD, see
+ *        classifier_check_frame(). It deletes itself when no model is loaded.
+ * 
+ * @param pvParameters Pointer to the task parameters.
+ */
+void ClassifierTask(void* pvParameters) __attribute__((noreturn));
+
+/**
+ * @brief Task sends the lines queued in the log ring to the UART, SPP and BLE.
+ *        It runs every LOG_SINK_FLUSH_PERIOD, or earlier when a logging task
+ *        finds the ring half full, so the loggers never wait for the outputs.
+ * 
+ * @param pvParameters Pointer to the task parameters.
+ */
+void LogSinkTask(void* pvParameters) __attribute__((noreturn));
+
 extern Motor motor1;
 extern Motor motor2;
 
+extern TaskHandle_t motionCaptureTask;
+
 #ifdef ENABLE_BLE
 /**
  * @brief Task responsible for sending notifications through Bluetooth Low Energy (BLE).
  * 
- * This task handles the transmission of notifications using BLE technology. It is designed to run
- * continuously and send notifications to connected BLE devices.
+ * This task sleeps until ble_printf() or ble_write() adds data, waits BLE_NOTIFY_COALESCE
+ * for more and sends everything with sendNotification(). Nothing is sent while the
+ * notification does not change. It also notifies the telemetry characteristics marked by
+ * ble_telemetry_changed(), and the system one every BLE_TELEMETRY_SYSTEM_PERIOD.
  * 
  * @param pvParameters Pointer to the task parameters (if any).
  */
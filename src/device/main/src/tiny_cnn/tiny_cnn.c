@@ -0,0 +1,526 @@
+/*******************************************************************************
+ * @file        tiny_cnn.c
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#include "../tiny_cnn/tiny_cnn.h"
+
+// Shape of the tensor a layer reads
+typedef struct
+{
+    int height;
+    int width;
+    int channels;
+} TinyCnnShape_t;
+
+// Parameters following a layer record
+typedef struct
+{
+    const int8_t *weights;
+    const int32_t *bias;
+    const int32_t *multiplier;
+    const int32_t *shift;
+} TinyCnnPayload_t;
+
+static inline size_t align4(size_t size)
+{
+    return (size + 3) & ~(size_t)3;
+}
+
+static bool has_parameters(uint8_t type)
+{
+    return type != TINY_CNN_AVG_POOL && type != TINY_CNN_MAX_POOL;
+}
+
+static size_t weight_count(const TinyCnnLayer_t *layer, const TinyCnnShape_t *in)
+{
+    switch (layer->type)
+    {
+        case TINY_CNN_CONV2D:
+            return (size_t)layer->outputChannels * layer->kernelHeight * layer->kernelWidth * in->channels;
+        case TINY_CNN_DEPTHWISE_CONV2D:
+            return (size_t)layer->kernelHeight * layer->kernelWidth * in->channels;
+        case TINY_CNN_FULLY_CONNECTED:
+            return (size_t)layer->outputChannels * in->height * in->width * in->channels;
+        default:
+            return 0;
+    }
+}
+
+static TinyCnnPayload_t layer_payload(const TinyCnnLayer_t *layer, size_t weights)
+{
+    const uint8_t *data = (const uint8_t *)(layer + 1);
+    TinyCnnPayload_t payload;
+
+    payload.weights = (const int8_t *)data;
+    payload.bias = (const int32_t *)(data + align4(weights));
+    payload.multiplier = payload.bias + layer->outputChannels;
+    payload.shift = payload.multiplier + layer->outputChannels;
+    return payload;
+}
+
+// Output size of a window sliding over size values, as in TensorFlow
+static int window_output(int size, int kernel, int stride, uint8_t padding)
+{
+    return padding == TINY_CNN_PADDING_SAME ? (size + stride - 1) / stride : (size - kernel) / stride + 1;
+}
+
+// Padding before the first value, as in TensorFlow
+static int window_padding(int size, int output, int kernel, int stride, uint8_t padding)
+{
+    if (padding != TINY_CNN_PADDING_SAME)
+    {
+        return 0;
+    }
+    int total = (output - 1) * stride + kernel - size;
+    return total > 0 ? total / 2 : 0;
+}
+
+static esp_err_t check_layer(const TinyCnnLayer_t *layer, const TinyCnnShape_t *in, uint32_t *macs)
+{
+    int outH = layer->outputHeight;
+    int outW = layer->outputWidth;
+    int outC = layer->outputChannels;
+
+    if (outH == 0 || outW == 0 || outC == 0 ||
+        layer->activationMin < -128 || layer->activationMax > 127 || layer->activationMin > layer->activationMax)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    switch (layer->type)
+    {
+        case TINY_CNN_CONV2D:
+        case TINY_CNN_DEPTHWISE_CONV2D:
+        case TINY_CNN_AVG_POOL:
+        case TINY_CNN_MAX_POOL:
+            if (layer->kernelHeight == 0 || layer->kernelWidth == 0 || layer->stride == 0 ||
+                layer->padding > TINY_CNN_PADDING_SAME ||
+                window_output(in->height, layer->kernelHeight, layer->stride, layer->padding) != outH ||
+                window_output(in->width, layer->kernelWidth, layer->stride, layer->padding) != outW)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            if (layer->type != TINY_CNN_CONV2D && outC != in->channels)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            break;
+        case TINY_CNN_GLOBAL_AVG_POOL:
+            if (outH != 1 || outW != 1 || outC != in->channels)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            break;
+        case TINY_CNN_FULLY_CONNECTED:
+            if (outH != 1 || outW != 1)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            break;
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    size_t weights = weight_count(layer, in);
+    size_t payload = has_parameters(layer->type) ? align4(weights) + 3 * sizeof(int32_t) * outC : 0;
+    if (layer->payloadSize != payload)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Every weight is used once per output position
+    *macs += (uint32_t)(outH * outW) * weights;
+
+    return ESP_OK;
+}
+
+esp_err_t tiny_cnn_load(TinyCnnModel_t *model, const uint8_t *data, size_t size)
+{
+    if (model == NULL || data == NULL || ((uintptr_t)data & 3) != 0 || size < sizeof(TinyCnnHeader_t))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const TinyCnnHeader_t *header = (const TinyCnnHeader_t *)data;
+    if (memcmp(header->magic, TINY_CNN_MAGIC, 4) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (header->version != TINY_CNN_VERSION || header->layerCount > TINY_CNN_MAX_LAYERS)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (header->layerCount == 0 || header->inputHeight == 0 || header->inputWidth == 0 ||
+        header->inputChannels == 0 || header->classes == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(model, 0, sizeof(*model));
+    model->header = header;
+
+    TinyCnnShape_t shape = {header->inputHeight, header->inputWidth, header->inputChannels};
+    size_t largest = (size_t)shape.height * shape.width * shape.channels;
+    size_t offset = sizeof(TinyCnnHeader_t);
+
+    for (int i = 0; i < header->layerCount; i++)
+    {
+        if (offset + sizeof(TinyCnnLayer_t) > size)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        const TinyCnnLayer_t *layer = (const TinyCnnLayer_t *)(data + offset);
+        esp_err_t err = check_layer(layer, &shape, &model->macs);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+
+        offset += sizeof(TinyCnnLayer_t) + layer->payloadSize;
+        if (offset > size)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        model->layers[i] = layer;
+        shape.height = layer->outputHeight;
+        shape.width = layer->outputWidth;
+        shape.channels = layer->outputChannels;
+
+        size_t activation = (size_t)shape.height * shape.width * shape.channels;
+        largest = activation > largest ? activation : largest;
+    }
+
+    if ((size_t)shape.height * shape.width * shape.channels != header->classes)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    model->activationSize = align4(largest);
+    return ESP_OK;
+}
+
+size_t tiny_cnn_arena_size(const TinyCnnModel_t *model)
+{
+    return 2 * model->activationSize;
+}
+
+int8_t *tiny_cnn_input(const TinyCnnModel_t *model, int8_t *arena)
+{
+    (void)model;
+    return arena;
+}
+
+// x * multiplier * 2^shift with the multiplier in Q31, rounded as TensorFlow Lite does
+static inline int32_t requantize(int32_t x, int32_t multiplier, int32_t shift)
+{
+    int left = shift > 0 ? shift : 0;
+    int right = shift > 0 ? 0 : -shift;
+
+    // Saturating rounding doubling high multiply
+    int64_t product = (int64_t)(x * (1 << left)) * multiplier;
+    if (x * (1 << left) == INT32_MIN && multiplier == INT32_MIN)
+    {
+        return INT32_MAX;
+    }
+    int64_t nudged = product + (product >= 0 ? (1 << 30) : (1 - (1 << 30)));
+    int32_t high = (int32_t)(nudged >= 0 ? nudged >> 31 : -((-nudged) >> 31));
+
+    // Rounding divide by a power of two
+    int32_t mask = (int32_t)((1u << right) - 1);
+    int32_t remainder = high & mask;
+    int32_t threshold = (mask >> 1) + (high < 0 ? 1 : 0);
+    return (high >> right) + (remainder > threshold ? 1 : 0);
+}
+
+static inline int8_t finish(int32_t acc, const TinyCnnLayer_t *layer, const TinyCnnPayload_t *payload, int channel)
+{
+    int32_t value = requantize(acc + payload->bias[channel], payload->multiplier[channel], payload->shift[channel]) +
+                    layer->outputZeroPoint;
+    value = value < layer->activationMin ? layer->activationMin : value;
+    value = value > layer->activationMax ? layer->activationMax : value;
+    return (int8_t)value;
+}
+
+/*
+ * Sum of a[i] * b[i], and of b[i] in bsum. Four independent accumulators of
+ * 16 bit products: the ESP32 compiler turns them into MUL16 multiplies that
+ * overlap with the loads, the portable C reads the same on the host.
+ */
+static inline int32_t dot_s8(const int8_t *a, const int8_t *b, int n, int32_t *bsum)
+{
+    int32_t acc0 = 0;
+    int32_t acc1 = 0;
+    int32_t acc2 = 0;
+    int32_t acc3 = 0;
+    int32_t sum = 0;
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        int16_t b0 = b[i];
+        int16_t b1 = b[i + 1];
+        int16_t b2 = b[i + 2];
+        int16_t b3 = b[i + 3];
+        acc0 += (int16_t)a[i] * b0;
+        acc1 += (int16_t)a[i + 1] * b1;
+        acc2 += (int16_t)a[i + 2] * b2;
+        acc3 += (int16_t)a[i + 3] * b3;
+        sum += b0 + b1 + b2 + b3;
+    }
+    for (; i < n; i++)
+    {
+        acc0 += (int16_t)a[i] * (int16_t)b[i];
+        sum += b[i];
+    }
+
+    *bsum += sum;
+    return acc0 + acc1 + acc2 + acc3;
+}
+
+/*
+ * Padded inputs hold the input zero point, so only the taps inside the input
+ * are summed, and the zero point is taken out once with the sum of their weights.
+ */
+static void conv2d(const TinyCnnLayer_t *layer, const TinyCnnShape_t *in, const int8_t *input, int8_t *output)
+{
+    const int kh = layer->kernelHeight;
+    const int kw = layer->kernelWidth;
+    const int stride = layer->stride;
+    const int outH = layer->outputHeight;
+    const int outW = layer->outputWidth;
+    const int outC = layer->outputChannels;
+    const int inC = in->channels;
+    const int padTop = window_padding(in->height, outH, kh, stride, layer->padding);
+    const int padLeft = window_padding(in->width, outW, kw, stride, layer->padding);
+    const TinyCnnPayload_t payload = layer_payload(layer, weight_count(layer, in));
+
+    for (int oy = 0; oy < outH; oy++)
+    {
+        int iy0 = oy * stride - padTop;
+        int kyStart = iy0 < 0 ? -iy0 : 0;
+        int kyEnd = iy0 + kh > in->height ? in->height - iy0 : kh;
+
+        for (int ox = 0; ox < outW; ox++)
+        {
+            int ix0 = ox * stride - padLeft;
+            int kxStart = ix0 < 0 ? -ix0 : 0;
+            int kxEnd = ix0 + kw > in->width ? in->width - ix0 : kw;
+
+            // The taps of a kernel row are contiguous in HWC order
+            int rowLen = (kxEnd - kxStart) * inC;
+
+            for (int oc = 0; oc < outC; oc++)
+            {
+                const int8_t *weights = payload.weights + (size_t)oc * kh * kw * inC;
+                int32_t acc = 0;
+                int32_t weightSum = 0;
+
+                for (int ky = kyStart; ky < kyEnd; ky++)
+                {
+                    const int8_t *x = input + ((size_t)(iy0 + ky) * in->width + ix0 + kxStart) * inC;
+                    const int8_t *w = weights + ((size_t)ky * kw + kxStart) * inC;
+                    acc += dot_s8(x, w, rowLen, &weightSum);
+                }
+
+                acc -= layer->inputZeroPoint * weightSum;
+                *output++ = finish(acc, layer, &payload, oc);
+            }
+        }
+    }
+}
+
+static void depthwise_conv2d(const TinyCnnLayer_t *layer, const TinyCnnShape_t *in, const int8_t *input, int8_t *output)
+{
+    const int kh = layer->kernelHeight;
+    const int kw = layer->kernelWidth;
+    const int stride = layer->stride;
+    const int outH = layer->outputHeight;
+    const int outW = layer->outputWidth;
+    const int channels = in->channels;
+    const int padTop = window_padding(in->height, outH, kh, stride, layer->padding);
+    const int padLeft = window_padding(in->width, outW, kw, stride, layer->padding);
+    const TinyCnnPayload_t payload = layer_payload(layer, weight_count(layer, in));
+
+    for (int oy = 0; oy < outH; oy++)
+    {
+        int iy0 = oy * stride - padTop;
+        int kyStart = iy0 < 0 ? -iy0 : 0;
+        int kyEnd = iy0 + kh > in->height ? in->height - iy0 : kh;
+
+        for (int ox = 0; ox < outW; ox++)
+        {
+            int ix0 = ox * stride - padLeft;
+            int kxStart = ix0 < 0 ? -ix0 : 0;
+            int kxEnd = ix0 + kw > in->width ? in->width - ix0 : kw;
+
+            for (int c = 0; c < channels; c++)
+            {
+                int32_t acc = 0;
+                int32_t weightSum = 0;
+
+                for (int ky = kyStart; ky < kyEnd; ky++)
+                {
+                    const int8_t *x = input + ((size_t)(iy0 + ky) * in->width + ix0) * channels + c;
+                    const int8_t *w = payload.weights + (size_t)ky * kw * channels + c;
+                    for (int kx = kxStart; kx < kxEnd; kx++)
+                    {
+                        int16_t weight = w[kx * channels];
+                        acc += (int16_t)x[kx * channels] * weight;
+                        weightSum += weight;
+                    }
+                }
+
+                acc -= layer->inputZeroPoint * weightSum;
+                *output++ = finish(acc, layer, &payload, c);
+            }
+        }
+    }
+}
+
+// Average and max pools keep the quantization of their input
+static void pool(const TinyCnnLayer_t *layer, const TinyCnnShape_t *in, const int8_t *input, int8_t *output)
+{
+    const int kh = layer->kernelHeight;
+    const int kw = layer->kernelWidth;
+    const int stride = layer->stride;
+    const int outH = layer->outputHeight;
+    const int outW = layer->outputWidth;
+    const int channels = in->channels;
+    const int padTop = window_padding(in->height, outH, kh, stride, layer->padding);
+    const int padLeft = window_padding(in->width, outW, kw, stride, layer->padding);
+    const bool average = layer->type == TINY_CNN_AVG_POOL;
+
+    for (int oy = 0; oy < outH; oy++)
+    {
+        int iy0 = oy * stride - padTop;
+        int kyStart = iy0 < 0 ? -iy0 : 0;
+        int kyEnd = iy0 + kh > in->height ? in->height - iy0 : kh;
+
+        for (int ox = 0; ox < outW; ox++)
+        {
+            int ix0 = ox * stride - padLeft;
+            int kxStart = ix0 < 0 ? -ix0 : 0;
+            int kxEnd = ix0 + kw > in->width ? in->width - ix0 : kw;
+
+            // Padding is not counted in the average, as in TensorFlow
+            int32_t count = (kyEnd - kyStart) * (kxEnd - kxStart);
+
+            for (int c = 0; c < channels; c++)
+            {
+                int32_t acc = average ? 0 : -128;
+                for (int ky = kyStart; ky < kyEnd; ky++)
+                {
+                    const int8_t *x = input + ((size_t)(iy0 + ky) * in->width + ix0) * channels + c;
+                    for (int kx = kxStart; kx < kxEnd; kx++)
+                    {
+                        int32_t value = x[kx * channels];
+                        if (average)
+                        {
+                            acc += value;
+                        }
+                        else if (value > acc)
+                        {
+                            acc = value;
+                        }
+                    }
+                }
+
+                if (average)
+                {
+                    acc = acc >= 0 ? (acc + count / 2) / count : (acc - count / 2) / count;
+                }
+                acc = acc < layer->activationMin ? layer->activationMin : acc;
+                acc = acc > layer->activationMax ? layer->activationMax : acc;
+                *output++ = (int8_t)acc;
+            }
+        }
+    }
+}
+
+static void global_avg_pool(const TinyCnnLayer_t *layer, const TinyCnnShape_t *in, const int8_t *input, int8_t *output)
+{
+    const int channels = in->channels;
+    const int pixels = in->height * in->width;
+    const TinyCnnPayload_t payload = layer_payload(layer, 0);
+
+    for (int c = 0; c < channels; c++)
+    {
+        int32_t acc = 0;
+        for (int i = 0; i < pixels; i++)
+        {
+            acc += input[(size_t)i * channels + c];
+        }
+
+        // The multiplier holds the 1 / pixels of the mean
+        acc -= layer->inputZeroPoint * pixels;
+        output[c] = finish(acc, layer, &payload, c);
+    }
+}
+
+static void fully_connected(const TinyCnnLayer_t *layer, const TinyCnnShape_t *in, const int8_t *input, int8_t *output)
+{
+    const int inputs = in->height * in->width * in->channels;
+    const TinyCnnPayload_t payload = layer_payload(layer, weight_count(layer, in));
+
+    for (int oc = 0; oc < layer->outputChannels; oc++)
+    {
+        int32_t weightSum = 0;
+        int32_t acc = dot_s8(input, payload.weights + (size_t)oc * inputs, inputs, &weightSum);
+        acc -= layer->inputZeroPoint * weightSum;
+        output[oc] = finish(acc, layer, &payload, oc);
+    }
+}
+
+const int8_t *tiny_cnn_run(const TinyCnnModel_t *model, int8_t *arena)
+{
+    const TinyCnnHeader_t *header = model->header;
+    TinyCnnShape_t shape = {header->inputHeight, header->inputWidth, header->inputChannels};
+    int8_t *input = arena;
+    int8_t *output = arena + model->activationSize;
+
+    for (int i = 0; i < header->layerCount; i++)
+    {
+        const TinyCnnLayer_t *layer = model->layers[i];
+
+        switch (layer->type)
+        {
+            case TINY_CNN_CONV2D:
+                conv2d(layer, &shape, input, output);
+                break;
+            case TINY_CNN_DEPTHWISE_CONV2D:
+                depthwise_conv2d(layer, &shape, input, output);
+                break;
+            case TINY_CNN_AVG_POOL:
+            case TINY_CNN_MAX_POOL:
+                pool(layer, &shape, input, output);
+                break;
+            case TINY_CNN_GLOBAL_AVG_POOL:
+                global_avg_pool(layer, &shape, input, output);
+                break;
+            case TINY_CNN_FULLY_CONNECTED:
+                fully_connected(layer, &shape, input, output);
+                break;
+        }
+
+        shape.height = layer->outputHeight;
+        shape.width = layer->outputWidth;
+        shape.channels = layer->outputChannels;
+
+        // The output of this layer is the input of the next one
+        int8_t *swap = input;
+        input = output;
+        output = swap;
+    }
+
+    return input;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * @file        tiny_cnn.h
+ * @author      Leonardo Acha Boiano
+ * @date        17 Oct 2026
+ * @brief       Int8 inference engine for small convolutional networks.
+ *              Models are quantized like TensorFlow Lite int8 models (per channel
+ *              symmetric weights, asymmetric activations, int32 biases) and are
+ *              converted to the TCNN format below by scripts/tflite_to_tcnn.py.
+ *              Activations are kept in HWC order in a caller provided arena split
+ *              in two halves used in turn by consecutive layers, so a run neither
+ *              allocates nor copies the weights out of the model.
+ *
+ *              TCNN format, little endian, every section 4 byte aligned:
+ *                TinyCnnHeader_t, then per layer a TinyCnnLayer_t followed by
+ *                its payload: int8 weights (none for pools), padded to 4 bytes,
+ *                then int32 bias, multiplier and shift per output channel
+ *                (none for AVG_POOL and MAX_POOL). Weight layouts follow
+ *                TensorFlow Lite: conv [out][kh][kw][in], depthwise [kh][kw][c],
+ *                fully connected [out][in].
+ *
+ * @note        This code is written in C and is used on an ESP32-CAM development board.
+ *
+ *******************************************************************************/
+
+#ifndef TINY_CNN_H
+#define TINY_CNN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_err.h"
+
+#define TINY_CNN_MAGIC "TCNN"
+#define TINY_CNN_VERSION 1
+
+// Longest supported layer list
+#define TINY_CNN_MAX_LAYERS 32
+
+/**
+ * @brief Operation of a layer.
+ */
+typedef enum
+{
+    TINY_CNN_CONV2D = 1,
+    TINY_CNN_DEPTHWISE_CONV2D = 2,
+    TINY_CNN_AVG_POOL = 3,
+    TINY_CNN_MAX_POOL = 4,
+    TINY_CNN_GLOBAL_AVG_POOL = 5,   /*< Mean over height and width, scale folded in the multiplier */
+    TINY_CNN_FULLY_CONNECTED = 6
+} TinyCnnLayerType_t;
+
+/**
+ * @brief Padding of the convolutions and pools, as in TensorFlow.
+ */
+typedef enum
+{
+    TINY_CNN_PADDING_VALID = 0,
+    TINY_CNN_PADDING_SAME = 1
+} TinyCnnPadding_t;
+
+/**
+ * @brief Model header, 40 bytes.
+ */
+typedef struct
+{
+    char magic[4];              /*< TINY_CNN_MAGIC                                   */
+    uint16_t version;           /*< TINY_CNN_VERSION                                 */
+    uint16_t layerCount;
+    uint16_t inputHeight;
+    uint16_t inputWidth;
+    uint16_t inputChannels;     /*< 1 for luma, 3 for RGB                            */
+    uint16_t classes;           /*< Length of the output vector                      */
+    int32_t inputZeroPoint;
+    float inputScale;
+    int32_t outputZeroPoint;
+    float outputScale;
+    float pixelScale;           /*< Input value = pixel (0-255) * pixelScale + pixelOffset */
+    float pixelOffset;
+} TinyCnnHeader_t;
+
+/**
+ * @brief Layer record, 32 bytes. The input is the output of the previous layer.
+ */
+typedef struct
+{
+    uint8_t type;               /*< TinyCnnLayerType_t                               */
+    uint8_t kernelHeight;
+    uint8_t kernelWidth;
+    uint8_t stride;
+    uint8_t padding;            /*< TinyCnnPadding_t                                 */
+    uint8_t reserved[3];
+    uint16_t outputHeight;
+    uint16_t outputWidth;
+    uint16_t outputChannels;
+    uint16_t reserved2;
+    int32_t inputZeroPoint;
+    int32_t outputZeroPoint;
+    int16_t activationMin;      /*< Output clamp, the fused activation               */
+    int16_t activationMax;
+    uint32_t payloadSize;       /*< Bytes of payload following the record            */
+} TinyCnnLayer_t;
+
+/**
+ * @brief Loaded model. Points into the model data, which must stay valid.
+ */
+typedef struct
+{
+    const TinyCnnHeader_t *header;
+    const TinyCnnLayer_t *layers[TINY_CNN_MAX_LAYERS];
+    size_t activationSize;      /*< Largest input or output of a layer, in bytes     */
+    uint32_t macs;              /*< Multiply-accumulates of one run                  */
+} TinyCnnModel_t;
+
+/**
+ * @brief Checks a TCNN model and indexes its layers.
+ *
+ * @param model Destination of the loaded model.
+ * @param data  Model data, 4 byte aligned.
+ * @param size  Length of the model data.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for misaligned or invalid data,
+ *         ESP_ERR_NOT_SUPPORTED for another format version or an unknown layer.
+ */
+esp_err_t tiny_cnn_load(TinyCnnModel_t *model, const uint8_t *data, size_t size);
+
+/**
+ * @brief Bytes of arena a run of the model needs.
+ */
+size_t tiny_cnn_arena_size(const TinyCnnModel_t *model);
+
+/**
+ * @brief Where the quantized input must be written before tiny_cnn_run().
+ * Height x width x channels int8 values, in HWC order.
+ *
+ * @param model Loaded model.
+ * @param arena Arena of tiny_cnn_arena_size() bytes.
+ */
+int8_t *tiny_cnn_input(const TinyCnnModel_t *model, int8_t *arena);
+
+/**
+ * @brief Runs the model on the input written to tiny_cnn_input().
+ *
+ * @param model Loaded model.
+ * @param arena Arena of tiny_cnn_arena_size() bytes, 4 byte aligned.
+ * @return The output vector of header->classes quantized values, in the arena.
+ */
+const int8_t *tiny_cnn_run(const TinyCnnModel_t *model, int8_t *arena);
+
+#endif  // TINY_CNN_H
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
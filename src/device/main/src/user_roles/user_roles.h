@@ -11,6 +11,7 @@
 #ifndef USER_ROLES_H
 #define USER_ROLES_H
 
+#include <string.h>
 #include <esp_http_server.h>
 
 // User roles
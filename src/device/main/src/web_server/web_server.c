@@ -18,7 +18,7 @@ void start_webserver(void)
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     //config.core_id = 0;  // Set the core ID to 0 (core 0)
-    config.max_uri_handlers = 20;
+    config.max_uri_handlers = 24;
     config.task_priority    = tskIDLE_PRIORITY+1;
     //config.uri_match_fn     = httpd_uri_match_wildcard;
 
@@ -42,6 +42,79 @@ void start_webserver(void)
         };
         httpd_register_uri_handler(server, &image64_uri);
 
+        httpd_uri_t thumb_uri = {
+            .uri = "/thumb",
+            .method = HTTP_GET,
+            .handler = thumb_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &thumb_uri);
+
+        httpd_uri_t motion_uri = {
+            .uri = "/motion",
+            .method = HTTP_GET,
+            .handler = motion_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &motion_uri);
+
+        httpd_uri_t history_uri = {
+            .uri = "/history",
+            .method = HTTP_GET,
+            .handler = history_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &history_uri);
+
+        httpd_uri_t state_uri = {
+            .uri = "/state",
+            .method = HTTP_GET,
+            .handler = state_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &state_uri);
+
+        httpd_uri_t events_uri = {
+            .uri = "/events",
+            .method = HTTP_GET,
+            .handler = events_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &events_uri);
+
+        httpd_uri_t patrol_get_uri = {
+            .uri = "/patrol",
+            .method = HTTP_GET,
+            .handler = patrol_get_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &patrol_get_uri);
+
+        httpd_uri_t patrol_set_uri = {
+            .uri = "/patrol",
+            .method = HTTP_POST,
+            .handler = patrol_set_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &patrol_set_uri);
+
+        httpd_uri_t patrol_capture_uri = {
+            .uri = "/patrol/capture",
+            .method = HTTP_GET,
+            .handler = patrol_capture_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &patrol_capture_uri);
+
+        httpd_uri_t motor_ws_uri = {
+            .uri = "/ws/motor",
+            .method = HTTP_GET,
+            .handler = motor_ws_httpd_handler,
+            .user_ctx = NULL,
+            .is_websocket = true
+        };
+        httpd_register_uri_handler(server, &motor_ws_uri);
+
         httpd_uri_t status_uri = {
             .uri = "/status",
             .method = HTTP_GET,
@@ -124,6 +197,24 @@ void start_webserver(void)
 
         ESP_LOGI(WEBSERVER_TAG, "HTTP server started");
     }
+
+    // Start the stream server
+    httpd_handle_t stream_server = NULL;
+    config.server_port = STREAM_SERVER_PORT;
+    config.ctrl_port += 1;
+
+    if (httpd_start(&stream_server, &config) == ESP_OK)
+    {
+        httpd_uri_t stream_uri = {
+            .uri = "/stream",
+            .method = HTTP_GET,
+            .handler = stream_httpd_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(stream_server, &stream_uri);
+
+        ESP_LOGI(WEBSERVER_TAG, "Stream server started on port %d", STREAM_SERVER_PORT);
+    }
 }
 
 /********************************* END OF FILE ********************************/
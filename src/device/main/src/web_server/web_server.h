@@ -20,14 +20,20 @@
 
 #include <esp_http_server.h>
 #include "../http_handlers/http_handlers.h"
+#include "../motor_ws/motor_ws.h"
 #include "../motor_control/motor_control.h"
 
+// The MJPEG stream runs on its own server instance so that a long-lived
+// stream connection does not block the REST API handlers
+#define STREAM_SERVER_PORT 81
+
 /**
  * @brief Start the web server.
  *
  * This function initializes and starts the web server.
  * It configures the HTTP server and registers URI handlers for different routes.
  * The URI handlers for image, base64 image, status, and admin requests are registered.
+ * A second server instance is started on STREAM_SERVER_PORT for the /stream endpoint.
  *
  * @return None.
  */
@@ -36,4 +42,4 @@ void start_webserver(void);
 #endif  // WEB_SERVER_H
 
 /********************************* END OF FILE ********************************/
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
\ No newline at end of file